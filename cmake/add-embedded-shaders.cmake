@@ -0,0 +1,74 @@
+option(GIMBAL_LOCK_SPIRV_SHADERS "Compile the shader permutations to SPIR-V and embed the binaries" OFF)
+
+# <shader name>:<comma separated defines>, one entry per program the renderer builds.
+set(
+   GIMBAL_LOCK_SHADER_PERMUTATIONS
+      "BasicPipeline:USE_NORMAL,PRECOMPUTED_NORMAL_MATRIX"
+      "BasicPipeline:USE_NORMAL,PRECOMPUTED_NORMAL_MATRIX,INSTANCED_JOINTS"
+      "BasicPipeline:USE_NORMAL,PRECOMPUTED_NORMAL_MATRIX,INSTANCED_JOINTS,INSTANCED_COLORS"
+      "BasicPipeline:"
+)
+
+file(GLOB SHADER_FILES "${CMAKE_SOURCE_DIR}/shaders/*.vert" "${CMAKE_SOURCE_DIR}/shaders/*.frag" "${CMAKE_SOURCE_DIR}/shaders/*.glsl")
+
+set(SPIRV_FILES "")
+set(SPIRV_OUTPUTS "")
+if(GIMBAL_LOCK_SPIRV_SHADERS)
+   find_program(GLSLANG_VALIDATOR glslangValidator)
+   if(NOT GLSLANG_VALIDATOR)
+      message(FATAL_ERROR "GIMBAL_LOCK_SPIRV_SHADERS needs glslangValidator")
+   endif()
+
+   foreach(permutation ${GIMBAL_LOCK_SHADER_PERMUTATIONS})
+      string(REPLACE ":" ";" permutation "${permutation}")
+      list(GET permutation 0 shader_name)
+      list(LENGTH permutation permutation_length)
+      set(defines "")
+      if(permutation_length GREATER 1)
+         list(GET permutation 1 defines)
+         string(REPLACE "," ";" defines "${defines}")
+         list(SORT defines)
+      endif()
+
+      set(define_flags "")
+      foreach(define ${defines})
+         list(APPEND define_flags "-D${define}")
+      endforeach()
+      string(REPLACE ";" "," define_key "${defines}")
+      string(REPLACE ";" "_" define_suffix "${defines}")
+      set(spirv_name "${shader_name}")
+      if(NOT define_suffix STREQUAL "")
+         set(spirv_name "${shader_name}_${define_suffix}")
+      endif()
+
+      foreach(stage vert frag)
+         set(spirv_output "${PROJECT_BINARY_DIR}/spirv/${spirv_name}.${stage}.spv")
+         add_custom_command(
+            OUTPUT ${spirv_output}
+            COMMAND ${CMAKE_COMMAND} -E make_directory "${PROJECT_BINARY_DIR}/spirv"
+            COMMAND ${GLSLANG_VALIDATOR} -G ${define_flags} -o ${spirv_output} "${CMAKE_SOURCE_DIR}/shaders/${shader_name}.${stage}"
+            DEPENDS ${SHADER_FILES}
+            VERBATIM
+         )
+         if(define_key STREQUAL "")
+            list(APPEND SPIRV_FILES "${shader_name}.${stage}=${spirv_output}")
+         else()
+            list(APPEND SPIRV_FILES "${shader_name}.${stage},${define_key}=${spirv_output}")
+         endif()
+         list(APPEND SPIRV_OUTPUTS ${spirv_output})
+      endforeach()
+   endforeach()
+endif()
+
+set(EMBEDDED_SHADERS_HEADER "${PROJECT_BINARY_DIR}/EmbeddedShaders.h")
+string(REPLACE ";" "|" SPIRV_FILE_ARGUMENT "${SPIRV_FILES}")
+add_custom_command(
+   OUTPUT ${EMBEDDED_SHADERS_HEADER}
+   COMMAND ${CMAKE_COMMAND}
+      "-DSHADER_DIRECTORY=${CMAKE_SOURCE_DIR}/shaders"
+      "-DSPIRV_FILES=${SPIRV_FILE_ARGUMENT}"
+      "-DOUTPUT_FILE=${EMBEDDED_SHADERS_HEADER}"
+      -P "${CMAKE_SOURCE_DIR}/cmake/embed-shaders.cmake"
+   DEPENDS ${SHADER_FILES} ${SPIRV_OUTPUTS} "${CMAKE_SOURCE_DIR}/cmake/embed-shaders.cmake"
+   VERBATIM
+)
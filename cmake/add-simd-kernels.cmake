@@ -0,0 +1,19 @@
+# Kernels for each instruction set are built in their own translation unit with the matching flags;
+# RotationKernels picks one at run time, so the executable still runs on any x86-64 CPU.
+if(CMAKE_SYSTEM_PROCESSOR MATCHES "x86_64|AMD64|amd64")
+   add_definitions(-DGIMBAL_LOCK_X86_KERNELS)
+   list(
+      APPEND SOURCE_FILES
+         source/RotationKernelsSSE.cpp
+         source/RotationKernelsAVX2.cpp
+         source/RotationKernelsAVX512.cpp
+   )
+
+   if(MSVC)
+      set_source_files_properties(source/RotationKernelsAVX2.cpp PROPERTIES COMPILE_FLAGS "/arch:AVX2")
+      set_source_files_properties(source/RotationKernelsAVX512.cpp PROPERTIES COMPILE_FLAGS "/arch:AVX512")
+   else()
+      set_source_files_properties(source/RotationKernelsAVX2.cpp PROPERTIES COMPILE_FLAGS "-mavx2 -mfma")
+      set_source_files_properties(source/RotationKernelsAVX512.cpp PROPERTIES COMPILE_FLAGS "-mavx512f -mavx2 -mfma")
+   endif()
+endif()
\ No newline at end of file
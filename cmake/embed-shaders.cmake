@@ -0,0 +1,59 @@
+# Generates a header with every shader source, and optionally their SPIR-V binaries, as constexpr data.
+# Usage: cmake -DSHADER_DIRECTORY=<dir> -DSPIRV_FILES=<key=file|...> -DOUTPUT_FILE=<header> -P embed-shaders.cmake
+# A SPIR-V key is the shader file name followed by its sorted defines, separated by commas.
+
+function(get_escaped_bytes FILE_PATH OUTPUT_VARIABLE)
+   file(READ "${FILE_PATH}" hex_contents HEX)
+   string(REGEX REPLACE "([0-9a-f][0-9a-f])" "\\\\x\\1" escaped "${hex_contents}")
+   # Eight bytes per line keep every literal piece far below compiler limits.
+   string(REGEX REPLACE "((\\\\x[0-9a-f][0-9a-f])(\\\\x[0-9a-f][0-9a-f])?(\\\\x[0-9a-f][0-9a-f])?(\\\\x[0-9a-f][0-9a-f])?(\\\\x[0-9a-f][0-9a-f])?(\\\\x[0-9a-f][0-9a-f])?(\\\\x[0-9a-f][0-9a-f])?(\\\\x[0-9a-f][0-9a-f])?)" "\n      \"\\1\"" escaped "${escaped}")
+   file(SIZE "${FILE_PATH}" size)
+   set(${OUTPUT_VARIABLE} "${escaped}" PARENT_SCOPE)
+   set(${OUTPUT_VARIABLE}_SIZE "${size}" PARENT_SCOPE)
+endfunction()
+
+file(GLOB shader_files RELATIVE "${SHADER_DIRECTORY}" "${SHADER_DIRECTORY}/*.vert" "${SHADER_DIRECTORY}/*.frag" "${SHADER_DIRECTORY}/*.glsl")
+list(SORT shader_files)
+
+set(source_entries "")
+foreach(shader_file ${shader_files})
+   get_escaped_bytes("${SHADER_DIRECTORY}/${shader_file}" bytes)
+   string(APPEND source_entries "   EmbeddedShaderFile{\n      \"${shader_file}\",${bytes},\n      ${bytes_SIZE}\n   },\n")
+endforeach()
+list(LENGTH shader_files source_count)
+
+set(spirv_entries "")
+set(spirv_count 0)
+string(REPLACE "|" ";" SPIRV_FILES "${SPIRV_FILES}")
+foreach(spirv_file ${SPIRV_FILES})
+   string(REPLACE "=" ";" key_and_path "${spirv_file}")
+   list(GET key_and_path 0 key)
+   list(GET key_and_path 1 path)
+   get_escaped_bytes("${path}" bytes)
+   string(APPEND spirv_entries "   EmbeddedShaderFile{\n      \"${key}\",${bytes},\n      ${bytes_SIZE}\n   },\n")
+   math(EXPR spirv_count "${spirv_count} + 1")
+endforeach()
+
+file(WRITE "${OUTPUT_FILE}.tmp"
+"#pragma once
+
+// Generated by cmake/embed-shaders.cmake; do not edit.
+
+#include <array>
+#include <cstddef>
+
+struct EmbeddedShaderFile
+{
+   const char* Name;
+   const char* Contents;
+   size_t Size;
+};
+
+inline constexpr std::array<EmbeddedShaderFile, ${source_count}> EmbeddedShaderSources = {
+${source_entries}};
+
+inline constexpr std::array<EmbeddedShaderFile, ${spirv_count}> EmbeddedSpirVBinaries = {
+${spirv_entries}};
+")
+configure_file("${OUTPUT_FILE}.tmp" "${OUTPUT_FILE}" COPYONLY)
+file(REMOVE "${OUTPUT_FILE}.tmp")
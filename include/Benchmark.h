@@ -0,0 +1,53 @@
+#pragma once
+
+#include "_Common.h"
+#include "RotationKernels.h"
+#include "JointHierarchy.h"
+#include "RotationPolicies.h"
+#include "TimelineEvaluator.h"
+#include "CompressedTrack.h"
+#include "FrustumCuller.h"
+#include "SceneStore.h"
+
+// Headless measurements selected with --benchmark=NAME; they need neither a window nor an OpenGL context.
+class Benchmark
+{
+public:
+   struct Settings
+   {
+      std::string Name;
+      size_t Count;
+      int RepeatNum;
+
+      Settings() : Count( 1 << 20 ), RepeatNum( 5 ) {}
+   };
+
+   // Returns false if there is no benchmark with the given name.
+   static bool run(const Settings& settings);
+
+private:
+   // Pairs of keys of a random walk with the reference results of slerp and of the product in double precision.
+   struct RotationKeys
+   {
+      std::vector<glm::dquat> From;
+      std::vector<glm::dquat> To;
+      std::vector<float> T;
+      std::vector<glm::dquat> Interpolated;
+      std::vector<glm::dquat> Composed;
+   };
+
+   // Best of repeat_num runs in nanoseconds per item; the minimum is the least disturbed by the rest of the system.
+   template<typename Function>
+   [[nodiscard]] static double getBestTime(const Settings& settings, Function function);
+   static void runRotationConversion(const Settings& settings);
+   static void runSlerp(const Settings& settings);
+   static void runJointPropagation(const Settings& settings);
+   static void runRotationRepresentations(const Settings& settings);
+   static void runTimelineEvaluation(const Settings& settings);
+   static void runTrackCompression(const Settings& settings);
+   static void runFrustumCulling(const Settings& settings);
+   static void runSceneSystems(const Settings& settings);
+   template<typename Rotation>
+   static void runRotationRepresentation(const Settings& settings, const RotationKeys& keys);
+   [[nodiscard]] static double getAngleInDegrees(const glm::dquat& reference, const glm::mat3& rotation);
+};
\ No newline at end of file
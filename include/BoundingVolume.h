@@ -0,0 +1,56 @@
+#pragma once
+
+#include "_Common.h"
+#include "RotationKernels.h"
+
+// Box and sphere sharing a center. The sphere is measured from the box center rather than being the minimal one, which
+// keeps a single center to transform and is at most a little looser for the meshes drawn here.
+struct BoundingVolume
+{
+   glm::vec3 Center;
+   glm::vec3 Extent;
+   float Radius;
+
+   BoundingVolume() : Center( 0.0f ), Extent( 0.0f ), Radius( 0.0f ) {}
+   BoundingVolume(const glm::vec3& center, const glm::vec3& extent) :
+      Center( center ), Extent( extent ), Radius( glm::length( extent ) ) {}
+
+   // Points are stride floats apart with x, y, z first, so an interleaved vertex buffer can be read in place.
+   [[nodiscard]] static BoundingVolume fromPoints(const float* points, size_t stride, size_t count)
+   {
+      PointBounds bounds{};
+      RotationKernels::getPointBounds( points, stride, count, nullptr, bounds );
+      const glm::vec3 lower( bounds.Min[0], bounds.Min[1], bounds.Min[2] );
+      const glm::vec3 upper( bounds.Max[0], bounds.Max[1], bounds.Max[2] );
+      BoundingVolume volume( (lower + upper) * 0.5f, (upper - lower) * 0.5f );
+      RotationKernels::getPointBounds( points, stride, count, glm::value_ptr( volume.Center ), bounds );
+      volume.Radius = std::sqrt( bounds.MaxSquaredDistance );
+      return volume;
+   }
+
+   // Arvo's method: the new half extents are the absolute matrix applied to the old ones, and the sphere grows by the
+   // largest axis scale.
+   [[nodiscard]] BoundingVolume transform(const glm::mat4& to_world) const
+   {
+      const glm::mat3 linear( to_world );
+      BoundingVolume volume;
+      volume.Center = glm::vec3(to_world * glm::vec4(Center, 1.0f));
+      volume.Extent = glm::mat3(glm::abs( linear[0] ), glm::abs( linear[1] ), glm::abs( linear[2] )) * Extent;
+      const float squared_scale = std::max(
+         { glm::dot( linear[0], linear[0] ), glm::dot( linear[1], linear[1] ), glm::dot( linear[2], linear[2] ) }
+      );
+      volume.Radius = Radius * std::sqrt( squared_scale );
+      return volume;
+   }
+
+   // Same as the matrix version for x -> translation + rotation * (scale * x), as the instanced joints are drawn.
+   [[nodiscard]] BoundingVolume transform(const glm::quat& rotation, const glm::vec3& translation, float scale) const
+   {
+      const glm::mat3 linear = glm::mat3_cast( rotation );
+      BoundingVolume volume;
+      volume.Center = translation + linear * (Center * scale);
+      volume.Extent = glm::mat3(glm::abs( linear[0] ), glm::abs( linear[1] ), glm::abs( linear[2] )) * (Extent * scale);
+      volume.Radius = Radius * std::abs( scale );
+      return volume;
+   }
+};
\ No newline at end of file
@@ -17,8 +17,14 @@ public:
 
    [[nodiscard]] bool getMovingState() const { return IsMoving; }
    [[nodiscard]] glm::vec3 getCameraPosition() const { return CamPos; }
+   // Changes with every change of the view or the projection, so that users of the matrices can skip their work.
+   [[nodiscard]] uint64_t getVersion() const { return Version; }
    [[nodiscard]] const glm::mat4& getViewMatrix() const { return ViewMatrix; }
-   [[nodiscard]] const glm::mat4& getProjectionMatrix() const { return ProjectionMatrix; }
+   [[nodiscard]] const glm::mat4& getProjectionMatrix() const;
+   [[nodiscard]] const glm::mat4& getViewProjectionMatrix() const;
+   [[nodiscard]] const glm::mat4& getInverseViewMatrix() const;
+   // World-space planes (a, b, c, d) with unit normals pointing inwards: left, right, bottom, top, near and far.
+   [[nodiscard]] const std::array<glm::vec4, 6>& getFrustumPlanes() const;
    void setMovingState(bool is_moving) { IsMoving = is_moving; }
    void updateCamera();
    void pitch(int angle);
@@ -36,6 +42,12 @@ public:
    void updateWindowSize(int width, int height);
 
 private:
+   // The matrices derived from the view and the projection are computed when they are first asked for.
+   inline static constexpr uint ProjectionCached = 1u << 0;
+   inline static constexpr uint ViewProjectionCached = 1u << 1;
+   inline static constexpr uint InverseViewCached = 1u << 2;
+   inline static constexpr uint FrustumCached = 1u << 3;
+
    bool IsMoving;
    int Width;
    int Height;
@@ -52,5 +64,12 @@ private:
    glm::vec3 InitUpVec;
    glm::vec3 CamPos;
    glm::mat4 ViewMatrix;
-   glm::mat4 ProjectionMatrix;
+   uint64_t Version;
+   mutable uint CachedFlags;
+   mutable glm::mat4 ProjectionMatrix;
+   mutable glm::mat4 ViewProjectionMatrix;
+   mutable glm::mat4 InverseViewMatrix;
+   mutable std::array<glm::vec4, 6> FrustumPlanes;
+
+   void invalidateProjection();
 };
\ No newline at end of file
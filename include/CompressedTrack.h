@@ -0,0 +1,125 @@
+#pragma once
+
+#include "_Common.h"
+#include "KeyframeTrack.h"
+
+// A quaternion track for long recordings. First the keys that the slerp between their neighbours reconstructs within
+// a tolerance are removed; then each remaining key is stored in 10 bytes instead of 24. The time
+// takes 4 bytes as the tick difference to the previous key. The rotation takes 6 bytes in the smallest-three form:
+// 2 bits for the index of the largest component, and 15 bits for each of the other three.
+// The keys are grouped into blocks that start at an absolute time, so a seek decodes a single block.
+class CompressedTrack
+{
+public:
+   struct Statistics
+   {
+      size_t OriginalKeyNum;
+      size_t KeptKeyNum;
+      size_t OriginalBytes; // a double time and a float4 quaternion per key
+      size_t CompressedBytes;
+      float MaxErrorInRadians; // at the times of the original keys, quantization included
+   };
+
+   // The block a cursor decoded last, plus the key after it, so that playback decodes every block once.
+   struct Cursor
+   {
+      size_t Block;
+      std::vector<double> Times;
+      std::vector<glm::quat> Quaternions;
+
+      Cursor() : Block( std::numeric_limits<size_t>::max() ) {}
+   };
+
+   inline static constexpr double TicksPerMillisecond = 1000.0;
+   inline static constexpr size_t DefaultBlockSize = 64;
+   // Kept keys are at most this many keys apart, so that compressing a still track stays linear in the key count.
+   inline static constexpr size_t MaxSegmentKeyNum = 256;
+
+   // --compress-track: compresses the quaternion track of a track file and reports the size, error and decode speed.
+   struct FileSettings
+   {
+      std::string TrackFilePath;
+      std::string OutputFilePath; // empty only reports
+      float ToleranceInDegrees;
+      size_t BlockSize;
+
+      FileSettings() : ToleranceInDegrees( 0.1f ), BlockSize( DefaultBlockSize ) {}
+   };
+
+   CompressedTrack() : Duration( 0.0 ), Looping( true ) {}
+
+   Statistics compress(
+      const KeyframeTrack<glm::quat>& track,
+      float tolerance_in_radians,
+      size_t block_size = DefaultBlockSize
+   );
+   void clear();
+   [[nodiscard]] bool empty() const { return Rotations.empty(); }
+   [[nodiscard]] size_t getKeyNum() const { return Rotations.size(); }
+   [[nodiscard]] size_t getBlockNum() const { return Blocks.size(); }
+   [[nodiscard]] size_t getByteSize() const
+   {
+      return Blocks.size() * sizeof( Block ) + TimeDeltas.size() * sizeof( uint32_t ) +
+         Rotations.size() * sizeof( PackedQuaternion );
+   }
+   [[nodiscard]] double getDuration() const { return Duration; }
+   [[nodiscard]] bool isLooping() const { return Looping; }
+   [[nodiscard]] size_t getBlockKeyNum(size_t block) const
+   {
+      return (block + 1 < Blocks.size() ? Blocks[block + 1].FirstKey : Rotations.size()) - Blocks[block].FirstKey;
+   }
+   // Random access: writes the getBlockKeyNum( block ) keys of one block without touching any other block.
+   void decodeBlock(size_t block, double* times, glm::quat* quaternions) const;
+   // The same looping and holding as KeyframeTrack::evaluate, with the exact slerp that compress() checked.
+   [[nodiscard]] glm::quat evaluate(double time, Cursor& cursor) const;
+   void decompress(KeyframeTrack<glm::quat>& track) const;
+   bool save(const std::string& file_path) const;
+   bool load(const std::string& file_path);
+   // Decodes every block into the arrays and returns how long it took in seconds.
+   double measureDecoding(std::vector<double>& times, std::vector<glm::quat>& quaternions) const;
+   // Returns false if the track file cannot be read or the output cannot be written.
+   static bool compressFile(const FileSettings& settings);
+
+private:
+   using PackedQuaternion = std::array<uint16_t, 3>;
+
+   struct Block
+   {
+      double StartTime;
+      uint64_t FirstKey;
+   };
+
+   struct FileHeader
+   {
+      uint Magic;
+      uint Version;
+      uint64_t KeyNum;
+      uint64_t BlockNum;
+      double Duration;
+      uint Looping;
+      uint Reserved;
+   };
+
+   inline static constexpr uint FileMagic = 0x54434c47u;
+   inline static constexpr uint FileVersion = 1;
+   inline static constexpr float ComponentBound = 0.70710678f; // the other three are at most 1/sqrt(2)
+   inline static constexpr uint ComponentMax = (1u << 15) - 1;
+
+   std::vector<Block> Blocks;
+   std::vector<uint32_t> TimeDeltas; // ticks since the previous key, 0 at the first key of a block
+   std::vector<PackedQuaternion> Rotations;
+   double Duration;
+   bool Looping;
+
+   [[nodiscard]] static PackedQuaternion pack(const glm::quat& quaternion);
+   [[nodiscard]] static glm::quat unpack(const PackedQuaternion& packed);
+   [[nodiscard]] static float getAngle(const glm::quat& a, const glm::quat& b);
+   // Always the exact slerp: the tolerance only holds for the interpolation compress() checked it with, whatever
+   // QuaternionSlerp method is selected when the track is played.
+   [[nodiscard]] static glm::quat interpolate(const glm::quat& from, const glm::quat& to, float t)
+   {
+      return glm::slerp( from, to, t );
+   }
+   [[nodiscard]] double getLocalTime(double time) const;
+   void seek(size_t block, Cursor& cursor) const;
+};
\ No newline at end of file
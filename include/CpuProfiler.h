@@ -0,0 +1,69 @@
+#pragma once
+
+#include "_Common.h"
+
+// Each thread records into its own chunked buffer without locking; chunks are only appended, and the number of
+// events in a chunk is published with release semantics so the exporter can read while threads keep recording.
+// Names must outlive the profiler, i.e. be string literals.
+class CpuProfiler
+{
+public:
+   class Zone
+   {
+   public:
+      explicit Zone(const char* name) : Name( name ), Start( isEnabled() ? getTimestamp() : 0 ) {}
+      ~Zone() { if (Start != 0) recordZone( Name, Start, getTimestamp() ); }
+      Zone(const Zone&) = delete;
+      Zone& operator=(const Zone&) = delete;
+
+   private:
+      const char* Name;
+      uint64_t Start;
+   };
+
+   static void setEnabled(bool enabled) { Enabled.store( enabled, std::memory_order_relaxed ); }
+   [[nodiscard]] static bool isEnabled() { return Enabled.load( std::memory_order_relaxed ); }
+   [[nodiscard]] static uint64_t getTimestamp();
+   static void setThreadName(const char* name);
+   static void recordZone(const char* name, uint64_t start, uint64_t end);
+   static void recordCounter(const char* name, double value);
+   static void markFrame(const char* name = "Frame");
+   [[nodiscard]] static bool writeChromeTrace(const std::string& file_path);
+
+private:
+   enum class EventType : uint8_t { Zone, Counter, Instant };
+
+   struct Event
+   {
+      const char* Name;
+      uint64_t Timestamp;
+      union { uint64_t Duration; double Value; };
+      EventType Type;
+   };
+
+   struct Chunk
+   {
+      inline static constexpr size_t Capacity = 8192;
+      std::atomic<size_t> Count;
+      std::atomic<Chunk*> Next;
+      std::array<Event, Capacity> Events;
+      Chunk() : Count( 0 ), Next( nullptr ), Events() {}
+   };
+
+   struct ThreadBuffer
+   {
+      uint ThreadID;
+      std::string ThreadName;
+      Chunk Head;
+      Chunk* Tail;
+      ThreadBuffer() : ThreadID( 0 ), Tail( &Head ) {}
+      ~ThreadBuffer();
+   };
+
+   inline static std::atomic<bool> Enabled{ false };
+   inline static std::mutex RegistryMutex;
+   inline static std::vector<std::unique_ptr<ThreadBuffer>> Registry;
+
+   [[nodiscard]] static ThreadBuffer* getThreadBuffer();
+   static void record(const Event& event);
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "_Common.h"
+#include "CpuProfiler.h"
+
+// Reports files that were written since the last call to takeChangedFiles(). On Linux this listens to inotify
+// events of the parent directories, which also catches editors that save by renaming a temporary file; elsewhere
+// the modification times are polled.
+class FileWatcher
+{
+public:
+   FileWatcher();
+   ~FileWatcher();
+
+   void watch(const std::string& file_path);
+   void start();
+   void stop();
+   [[nodiscard]] std::vector<std::string> takeChangedFiles();
+
+private:
+   std::atomic<bool> Running;
+   std::thread WatchThread;
+   std::mutex Mutex;
+   std::set<std::string> WatchedFiles;
+   std::set<std::string> ChangedFiles;
+#ifdef __linux__
+   int INotify;
+   std::unordered_map<int, std::filesystem::path> WatchedDirectories;
+#else
+   std::map<std::string, std::filesystem::file_time_type> LastWriteTimes;
+#endif
+
+   [[nodiscard]] static std::string getNormalizedPath(const std::string& file_path);
+   void watchLoop();
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "_Common.h"
+#include "CpuProfiler.h"
+
+// Frames are read into persistently mapped pixel buffer objects. A slot is handed to the encoding workers once its
+// fence has signaled, and becomes reusable when a worker is done with it; when every slot is busy the frame is
+// dropped, so the render loop never waits for the GPU or the encoders.
+class FrameCaptureGL
+{
+public:
+   enum class CaptureFormat { PNG, EXR, Raw };
+
+   struct Settings
+   {
+      CaptureFormat Format;
+      std::string DirectoryPath;
+      std::string PipeCommand;
+      int BufferCount;
+      int WorkerCount;
+
+      Settings() : Format( CaptureFormat::PNG ), DirectoryPath( "captures" ), BufferCount( 4 ), WorkerCount( 2 ) {}
+   };
+
+   FrameCaptureGL();
+   ~FrameCaptureGL();
+
+   [[nodiscard]] bool isCapturing() const { return IsCapturing; }
+   void setSettings(const Settings& settings) { Setting = settings; }
+   // Returns false if the pipe or the directory frames go to cannot be opened.
+   bool start(int width, int height);
+   void stop();
+   void captureFrame();
+   void poll();
+
+private:
+   enum class SlotState { Free, InFlight, Encoding };
+
+   struct Slot
+   {
+      GLuint Buffer;
+      GLsync Fence;
+      void* MappedPixels;
+      uint64_t FrameNumber;
+      std::atomic<SlotState> State;
+      Slot() : Buffer( 0 ), Fence( nullptr ), MappedPixels( nullptr ), FrameNumber( 0 ), State( SlotState::Free ) {}
+   };
+
+   Settings Setting;
+   bool IsCapturing;
+   int Width;
+   int Height;
+   uint64_t FrameNumber;
+   uint64_t DroppedFrames;
+   size_t NextSlot;
+   std::vector<std::unique_ptr<Slot>> Slots;
+   std::deque<Slot*> InFlightSlots;
+   FILE* Pipe;
+   bool StopWorkers;
+   std::vector<std::thread> Workers;
+   std::deque<Slot*> EncodingQueue;
+   std::mutex QueueMutex;
+   std::condition_variable QueueCondition;
+
+   [[nodiscard]] size_t getBytesPerPixel() const { return Setting.Format == CaptureFormat::EXR ? 16 : 4; }
+   void encode(const Slot& slot);
+   void encodeLoop();
+};
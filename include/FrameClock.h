@@ -0,0 +1,35 @@
+#pragma once
+
+#include "_Common.h"
+
+// Time source of the frame loop, in seconds. The real clock follows the wall clock, while the fixed-step clock moves
+// on by the same step every frame and the scripted one through a list of frame times; with either of those a run
+// replays exactly, no matter how long its frames actually take.
+class FrameClock
+{
+public:
+   enum class Mode { Real = 0, FixedStep, Scripted };
+
+   FrameClock();
+
+   [[nodiscard]] Mode getMode() const { return ClockMode; }
+   [[nodiscard]] bool isRealTime() const { return ClockMode == Mode::Real; }
+   void setRealTime();
+   void setFixedStep(double step);
+   // One time per frame, not decreasing; the clock ends after the last one.
+   void setScript(std::vector<double> frame_times);
+   // A text file with one frame time per line.
+   bool loadScript(const std::string& file_path);
+   [[nodiscard]] double now() const;
+   // Moves a simulated clock on to the next frame; the real clock moves by itself.
+   void advanceFrame();
+   [[nodiscard]] bool hasEnded() const { return ClockMode == Mode::Scripted && FrameIndex >= FrameTimes.size(); }
+
+private:
+   Mode ClockMode;
+   double Step;
+   double SimulatedTime;
+   size_t FrameIndex;
+   std::vector<double> FrameTimes;
+   std::chrono::steady_clock::time_point StartTime;
+};
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "_Common.h"
+
+class FrameScheduler
+{
+public:
+   struct Settings
+   {
+      double TargetFrameRate;
+      double SimulationRate;
+      double IdleFrameRate;
+      double IdleDelay;
+      double ReportInterval;
+      bool VSync;
+      // Idle frames are only rendered when something they show has changed, instead of at IdleFrameRate.
+      bool RenderOnDemand;
+
+      Settings() : TargetFrameRate( 60.0 ), SimulationRate( 120.0 ), IdleFrameRate( 4.0 ), IdleDelay( 0.5 ),
+      ReportInterval( 0.0 ), VSync( true ), RenderOnDemand( true ) {}
+   };
+
+   explicit FrameScheduler(const Settings& settings = Settings());
+
+   [[nodiscard]] const Settings& getSettings() const { return Setting; }
+   [[nodiscard]] double getFixedStep() const { return FixedStep; }
+   [[nodiscard]] double getInterpolationFactor() const { return Accumulator / FixedStep; }
+   [[nodiscard]] double getNextFrameTime() const;
+   void setSettings(const Settings& settings);
+   void start(double now);
+   void notifyActivity(double now) { LastActivityTime = now; }
+   void setActive(bool active) { IsActive = active; }
+   [[nodiscard]] bool isIdle(double now) const { return !IsActive && now - LastActivityTime >= Setting.IdleDelay; }
+   [[nodiscard]] int advance(double now);
+   void reportFrameTimes(double now);
+
+private:
+   inline static constexpr int MaxStepsPerFrame = 8;
+
+   Settings Setting;
+   bool IsActive;
+   double FixedStep;
+   double Accumulator;
+   double LastFrameTime;
+   double LastActivityTime;
+   double LastReportTime;
+   std::vector<double> FrameIntervals;
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "_Common.h"
+
+struct FramePacket
+{
+   uint64_t FrameIndex;
+   bool IsRecording;
+   glm::ivec2 FrameSize;
+   glm::mat4 ViewMatrix;
+   glm::mat4 ProjectionMatrix;
+   glm::mat4 ViewProjectionMatrix;
+   uint64_t CameraVersion;
+   glm::vec3 EulerAngle;
+   glm::quat Quaternion;
+   glm::mat4 EulerAngleWorld;
+   glm::mat4 QuaternionWorld;
+   int HighlightedFrameIndex;
+   std::vector<glm::mat4> CapturedFrameTransforms;
+   // Instance data of the joint chains, only of the ones that may be visible; see JointHierarchy::getInstances.
+   bool JointMode;
+   std::vector<glm::vec4> EulerAngleJoints;
+   std::vector<glm::vec4> QuaternionJoints;
+   // Instance data of the scene objects that may be visible, one vector per mesh; see SceneStore::getInstances.
+   bool SceneMode;
+   std::vector<std::vector<glm::vec4>> EulerAngleObjects;
+   std::vector<std::vector<glm::vec4>> QuaternionObjects;
+   // Teapots that may be visible: bit 0 for the Euler angle one, 1 for the quaternion one, 2 + i for captured frame i.
+   uint VisibleTeapots;
+   size_t CulledObjectNum;
+
+   FramePacket() : FrameIndex( 0 ), IsRecording( false ), FrameSize( 0 ), ViewMatrix( 1.0f ), ProjectionMatrix( 1.0f ),
+   ViewProjectionMatrix( 1.0f ), CameraVersion( 0 ), EulerAngle( 0.0f ), Quaternion( 1.0f, 0.0f, 0.0f, 0.0f ),
+   EulerAngleWorld( 1.0f ), QuaternionWorld( 1.0f ), HighlightedFrameIndex( -1 ), JointMode( false ),
+   SceneMode( false ), VisibleTeapots( 0 ), CulledObjectNum( 0 ) {}
+};
+
+// Hands the latest simulated frame to the render thread. The simulation writes into a back slot while the render
+// thread reads its front slot, and publish/acquire only swap indices, so neither side copies or waits on the other.
+class FrameStateBuffer
+{
+public:
+   FrameStateBuffer();
+   ~FrameStateBuffer() = default;
+
+   [[nodiscard]] FramePacket& getWritablePacket() { return Slots[Back]; }
+   void publish();
+   void waitUntilConsumed();
+   [[nodiscard]] const FramePacket* acquireLatest();
+   void stop();
+   void reset();
+
+private:
+   std::array<FramePacket, 3> Slots;
+   int Back;
+   int Ready;
+   int Front;
+   bool HasNewPacket;
+   bool Stopped;
+   std::mutex Mutex;
+   std::condition_variable Condition;
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "_Common.h"
+#include "BoundingVolume.h"
+#include "CpuProfiler.h"
+#include "TaskScheduler.h"
+
+// Tests many bounding volumes against up to 32 frusta in one batch, one visibility bit per frustum. Objects are added
+// in groups of nearby ones, and each group is first tested as a whole: a group outside every frustum or entirely inside
+// the ones it touches settles all its objects at once, so only groups crossing a frustum side cost per-object tests.
+class FrustumCuller
+{
+public:
+   inline static constexpr int MaxFrustumNum = 32;
+   // A group is closed after this many objects even without endGroup().
+   inline static constexpr size_t GroupSize = 64;
+   // Groups below this many are tested on the calling thread.
+   inline static constexpr size_t GroupGrainSize = 64;
+
+   FrustumCuller() : GroupOpen( false ), TestedNum( 0 ) {}
+
+   // Planes as from CameraGL::getFrustumPlanes, pointing inward with unit normals.
+   int addFrustum(const std::array<glm::vec4, 6>& planes);
+   void setFrustum(int frustum, const std::array<glm::vec4, 6>& planes);
+   void clearFrusta() { Planes.clear(); }
+   [[nodiscard]] int getFrustumNum() const { return static_cast<int>(Planes.size() / 24); }
+   void reserve(size_t object_num);
+   // Returns the index of the object, which isVisible takes.
+   size_t addObject(const BoundingVolume& volume);
+   void endGroup();
+   void clearObjects();
+   void cull(TaskScheduler* scheduler = nullptr);
+   [[nodiscard]] size_t getObjectNum() const { return Objects.Radii.size(); }
+   [[nodiscard]] bool isVisible(size_t object, int frustum) const { return (Visibility[object] >> frustum) & 1u; }
+   [[nodiscard]] uint getVisibility(size_t object) const { return Visibility[object]; }
+   [[nodiscard]] size_t getCulledNum(int frustum) const { return CulledNums[frustum]; }
+   // Volumes tested by the last cull, groups included, against getObjectNum() for testing every object.
+   [[nodiscard]] size_t getTestedNum() const { return TestedNum; }
+
+private:
+   struct VolumeArrays
+   {
+      std::array<std::vector<float>, 3> Centers;
+      std::array<std::vector<float>, 3> Extents;
+      std::vector<float> Radii;
+
+      void push(const glm::vec3& center, const glm::vec3& extent, float radius);
+      void clear();
+      [[nodiscard]] BoundingVolumeArrays getArrays(size_t offset) const;
+   };
+
+   bool GroupOpen;
+   size_t TestedNum;
+   std::vector<float> Planes;
+   VolumeArrays Objects;
+   VolumeArrays Groups;
+   std::vector<uint> Visibility;
+   // Objects of group g are [GroupOffsets[g], GroupOffsets[g + 1]).
+   std::vector<size_t> GroupOffsets;
+   std::vector<uint> GroupVisibility;
+   std::vector<uint> GroupContainment;
+   glm::vec3 GroupLower;
+   glm::vec3 GroupUpper;
+   std::array<size_t, MaxFrustumNum> CulledNums{};
+
+   void cullGroups(size_t begin, size_t end);
+};
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "_Common.h"
+
+// Timestamp queries are kept in a ring of FrameLatency frames, so results are read back several frames after they
+// were issued and never stall the pipeline. Scopes with the same name are summed within a frame.
+class GpuProfilerGL
+{
+public:
+   class Scope
+   {
+   public:
+      Scope(GpuProfilerGL* profiler, const char* name) :
+         Profiler( profiler ), Index( profiler != nullptr ? profiler->beginScope( name ) : -1 ) {}
+      ~Scope() { if (Index >= 0) Profiler->endScope( Index ); }
+      Scope(const Scope&) = delete;
+      Scope& operator=(const Scope&) = delete;
+
+   private:
+      GpuProfilerGL* Profiler;
+      int Index;
+   };
+
+   explicit GpuProfilerGL(int frame_latency = 4);
+
+   [[nodiscard]] bool isEnabled() const { return Enabled; }
+   void setEnabled(bool enabled) { Enabled = enabled; }
+   void setReportInterval(double seconds) { ReportInterval = seconds; }
+   void beginFrame();
+   void endFrame();
+   // Needs the context the queries were created in to be current; frames still in flight are not collected.
+   void destroy();
+   [[nodiscard]] int beginScope(const char* name);
+   void endScope(int scope_index);
+   void printStatistics(std::ostream& stream) const;
+   [[nodiscard]] bool writeCSV(const std::string& file_path) const;
+
+private:
+   inline static constexpr size_t SampleWindow = 1024;
+
+   struct ScopeRecord
+   {
+      int NameIndex;
+      uint BeginQuery;
+      uint EndQuery;
+   };
+
+   struct FrameQueries
+   {
+      bool Pending;
+      uint UsedQueries;
+      std::vector<GLuint> Queries;
+      std::vector<ScopeRecord> Scopes;
+      FrameQueries() : Pending( false ), UsedQueries( 0 ) {}
+   };
+
+   struct Statistics
+   {
+      uint64_t FrameCount;
+      double Max;
+      std::vector<double> Samples;
+      Statistics() : FrameCount( 0 ), Max( 0.0 ) {}
+   };
+
+   bool Enabled;
+   int FrameLatency;
+   uint64_t FrameIndex;
+   uint64_t DroppedFrames;
+   double ReportInterval;
+   std::chrono::steady_clock::time_point LastReportTime;
+   std::vector<FrameQueries> Frames;
+   std::vector<std::string> ScopeNames;
+   std::unordered_map<std::string, int> ScopeNameIndices;
+   std::vector<Statistics> ScopeStatistics;
+   std::vector<double> FrameSums;
+
+   [[nodiscard]] GLuint getQuery(FrameQueries& frame);
+   void collect(FrameQueries& frame);
+   static void getSummary(const Statistics& statistics, double& mean, double& p95);
+};
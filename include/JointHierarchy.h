@@ -0,0 +1,63 @@
+#pragma once
+
+#include "_Common.h"
+#include "RotationKernels.h"
+#include "TaskScheduler.h"
+
+// Joints in structure-of-arrays form, sorted by depth so that every level of the hierarchy is one contiguous range
+// whose parents all lie in the levels before it. World transforms are then propagated a level at a time, each level
+// split among the threads of a scheduler and every range run through the SIMD kernels of RotationKernels.
+class JointHierarchy
+{
+public:
+   enum class RotationForm { Quaternion = 0, EulerAngle };
+
+   // Joints below this many per level are not worth waking other threads for.
+   inline static constexpr size_t GrainSize = 4096;
+
+   struct Joint
+   {
+      int Parent; // -1 for roots
+      glm::vec3 Translation; // from the parent joint in its frame, or the world position of a root
+      float Length; // of the bone drawn from the joint, only used for rendering
+   };
+
+   JointHierarchy() : Form( RotationForm::Quaternion ) {}
+
+   // Joints may come in any order as long as there are no cycles; local rotations start as identities.
+   void build(const std::vector<Joint>& joints);
+   [[nodiscard]] size_t getJointNum() const { return Parents.size(); }
+   [[nodiscard]] size_t getLevelNum() const { return LevelOffsets.empty() ? 0 : LevelOffsets.size() - 1; }
+   // Index of joints[joint] after sorting, which all accessors below take.
+   [[nodiscard]] size_t getSortedIndex(size_t joint) const { return SortedIndices[joint]; }
+   [[nodiscard]] int getParent(size_t joint) const { return Parents[joint]; }
+   [[nodiscard]] glm::vec3 getLocalTranslation(size_t joint) const;
+   [[nodiscard]] RotationForm getRotationForm() const { return Form; }
+   // Selects which local rotations propagate() reads, the quaternions or the Euler angles.
+   void setRotationForm(RotationForm form) { Form = form; }
+   void setLocalRotation(size_t joint, const glm::quat& rotation);
+   void setLocalEulerAngle(size_t joint, const glm::vec3& angle);
+   void fillLocalRotations(const glm::quat& rotation);
+   void fillLocalEulerAngles(const glm::vec3& angle);
+   [[nodiscard]] glm::quat getLocalRotation(size_t joint) const;
+   void propagate(TaskScheduler* scheduler = nullptr);
+   [[nodiscard]] glm::quat getWorldRotation(size_t joint) const;
+   [[nodiscard]] glm::vec3 getWorldPosition(size_t joint) const;
+   // Two vec4 per joint for instanced drawing: the world rotation as x, y, z, w, then the world position and length.
+   void getInstances(std::vector<glm::vec4>& instances, TaskScheduler* scheduler = nullptr) const;
+
+private:
+   RotationForm Form;
+   std::vector<int> Parents;
+   std::vector<size_t> SortedIndices;
+   std::vector<size_t> LevelOffsets;
+   std::vector<float> Lengths;
+   std::array<std::vector<float>, 3> LocalEulerAngles;
+   std::array<std::vector<float>, 3> LocalTranslations;
+   std::array<std::vector<float>, 3> WorldPositions;
+   // w, x, y, z
+   std::array<std::vector<float>, 4> LocalRotations;
+   std::array<std::vector<float>, 4> WorldRotations;
+
+   [[nodiscard]] JointArrays getArrays();
+};
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "_Common.h"
+#include "KeyframeTrack.h"
+
+// Captured orientations on disk: a header, fixed-size key records in time order, and optionally an index holding the
+// time of every ChunkSize-th key. Keys are appended in place, which drops the index until the file is closed again,
+// and the tracks read the records straight from a read-only mapping of the file, so nothing is loaded up front.
+class KeyframeFile
+{
+public:
+   struct Record
+   {
+      double Time;
+      glm::vec3 EulerAngle;
+      glm::quat Quaternion;
+      float Reserved;
+   };
+
+   KeyframeFile();
+   ~KeyframeFile();
+   KeyframeFile(const KeyframeFile&) = delete;
+   KeyframeFile& operator=(const KeyframeFile&) = delete;
+
+   bool open(const std::string& file_path);
+   void close();
+   bool append(double time, const glm::vec3& euler_angle, const glm::quat& quaternion, double duration);
+   bool clear();
+   [[nodiscard]] bool isOpen() const { return !FilePath.empty(); }
+   [[nodiscard]] size_t getKeyNum() const { return static_cast<size_t>(Header.KeyNum); }
+   // The views stay valid until the next append, clear or close.
+   void bind(KeyframeTrack<glm::vec3>& euler_angle_track, KeyframeTrack<glm::quat>& quaternion_track) const;
+
+private:
+   struct FileHeader
+   {
+      uint Magic;
+      uint Version;
+      uint64_t KeyNum;
+      uint RecordSize;
+      uint ChunkSize;
+      uint64_t ChunkIndexOffset;
+      double Duration;
+   };
+
+   inline static constexpr uint FileMagic = 0x544b4c47u;
+   inline static constexpr uint FileVersion = 1;
+   inline static constexpr uint ChunkSize = 4096;
+
+   std::string FilePath;
+   FileHeader Header;
+   const uchar* MappedData;
+   size_t MappedSize;
+
+   [[nodiscard]] uint64_t getRecordsEnd() const { return sizeof( FileHeader ) + Header.KeyNum * sizeof( Record ); }
+   [[nodiscard]] const Record* getRecords() const
+   {
+      return reinterpret_cast<const Record*>(MappedData + sizeof( FileHeader ));
+   }
+   bool writeHeader() const;
+   bool map();
+   void unmap();
+};
\ No newline at end of file
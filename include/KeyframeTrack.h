@@ -0,0 +1,213 @@
+#pragma once
+
+#include "_Common.h"
+
+// Remembers the key an evaluation ended in, so that the next evaluation of a playing track starts from there.
+struct KeyframeCursor
+{
+   size_t Key;
+
+   KeyframeCursor() : Key( 0 ) {}
+};
+
+// Keys with strictly increasing times and any spacing. When looping, the track repeats every Duration and the last key
+// blends back into the first one; otherwise it holds the first and last values outside of the keys.
+// A track either owns its keys or is a view of strided times and values stored elsewhere, e.g. in a mapped file.
+template<typename T>
+class KeyframeTrack
+{
+public:
+   KeyframeTrack() :
+      TimeData( nullptr ), ValueData( nullptr ), TimeStride( sizeof( double ) ), ValueStride( sizeof( T ) ), KeyNum( 0 ),
+      ChunkStartTimes( nullptr ), ChunkSize( 0 ), Duration( 0.0 ), Looping( true ) {}
+
+   void reserve(size_t key_num)
+   {
+      Times.reserve( key_num );
+      Values.reserve( key_num );
+   }
+   void addKey(double time, const T& value);
+   void setView(
+      const double* times,
+      size_t time_stride,
+      const T* values,
+      size_t value_stride,
+      size_t key_num,
+      double duration
+   );
+   // First time of every chunk_size keys, so that a seek only searches within one chunk of the view.
+   void setSeekIndex(const double* chunk_start_times, size_t chunk_size)
+   {
+      ChunkStartTimes = chunk_start_times;
+      ChunkSize = chunk_start_times != nullptr ? chunk_size : 0;
+   }
+   void clear();
+   void setDuration(double duration) { Duration = duration; }
+   void setLooping(bool looping) { Looping = looping; }
+   [[nodiscard]] bool empty() const { return KeyNum == 0; }
+   [[nodiscard]] size_t getKeyNum() const { return KeyNum; }
+   [[nodiscard]] double getTime(size_t key) const
+   {
+      return *reinterpret_cast<const double*>(reinterpret_cast<const uchar*>(TimeData) + key * TimeStride);
+   }
+   [[nodiscard]] const T& getValue(size_t key) const
+   {
+      return *reinterpret_cast<const T*>(reinterpret_cast<const uchar*>(ValueData) + key * ValueStride);
+   }
+   [[nodiscard]] double getDuration() const { return Duration; }
+   [[nodiscard]] bool isLooping() const { return Looping; }
+   // Index of the last key at or before time, which is where the cursor is left as well.
+   [[nodiscard]] size_t findKey(double time, KeyframeCursor& cursor) const;
+   // The segment starting at the returned key that contains time, and how far into the segment time is.
+   // The segment of the last key ends at the first key when looping and has zero length otherwise.
+   [[nodiscard]] size_t findSegment(double time, KeyframeCursor& cursor, float& t) const;
+   template<typename Interpolator>
+   [[nodiscard]] T evaluate(double time, KeyframeCursor& cursor, Interpolator interpolate) const;
+
+private:
+   std::vector<double> Times;
+   std::vector<T> Values;
+   const double* TimeData;
+   const T* ValueData;
+   size_t TimeStride;
+   size_t ValueStride;
+   size_t KeyNum;
+   const double* ChunkStartTimes;
+   size_t ChunkSize;
+   double Duration;
+   bool Looping;
+
+   [[nodiscard]] double getLocalTime(double time) const;
+   [[nodiscard]] size_t searchKey(double time, size_t begin, size_t end) const;
+};
+
+template<typename T>
+void KeyframeTrack<T>::addKey(double time, const T& value)
+{
+   assert( KeyNum == Times.size() && (KeyNum == 0 || time > Times.back()) );
+
+   Times.emplace_back( time );
+   Values.emplace_back( value );
+   TimeData = Times.data();
+   ValueData = Values.data();
+   KeyNum = Times.size();
+   Duration = std::max( Duration, time - Times.front() );
+}
+
+template<typename T>
+void KeyframeTrack<T>::setView(
+   const double* times,
+   size_t time_stride,
+   const T* values,
+   size_t value_stride,
+   size_t key_num,
+   double duration
+)
+{
+   Times.clear();
+   Values.clear();
+   TimeData = times;
+   ValueData = values;
+   TimeStride = time_stride;
+   ValueStride = value_stride;
+   KeyNum = key_num;
+   ChunkStartTimes = nullptr;
+   ChunkSize = 0;
+   Duration = duration;
+}
+
+template<typename T>
+void KeyframeTrack<T>::clear()
+{
+   Times.clear();
+   Values.clear();
+   TimeData = nullptr;
+   ValueData = nullptr;
+   TimeStride = sizeof( double );
+   ValueStride = sizeof( T );
+   KeyNum = 0;
+   ChunkStartTimes = nullptr;
+   ChunkSize = 0;
+   Duration = 0.0;
+}
+
+template<typename T>
+double KeyframeTrack<T>::getLocalTime(double time) const
+{
+   const double start = getTime( 0 );
+   if (!Looping || Duration <= 0.0) return std::clamp( time, start, getTime( KeyNum - 1 ) );
+
+   const double local_time = std::fmod( time - start, Duration );
+   return start + (local_time < 0.0 ? local_time + Duration : local_time);
+}
+
+template<typename T>
+size_t KeyframeTrack<T>::searchKey(double time, size_t begin, size_t end) const
+{
+   // The first key in [begin, end) after time, minus one; begin itself if there is none before time.
+   while (begin < end) {
+      const size_t middle = begin + (end - begin) / 2;
+      if (getTime( middle ) <= time) begin = middle + 1;
+      else end = middle;
+   }
+   return begin == 0 ? 0 : begin - 1;
+}
+
+template<typename T>
+size_t KeyframeTrack<T>::findKey(double time, KeyframeCursor& cursor) const
+{
+   size_t key = std::min( cursor.Key, KeyNum - 1 );
+   if (getTime( key ) <= time) {
+      // Playback rarely moves more than a key or two per frame, so those are tried before searching.
+      for (int step = 0; step < 2 && key + 1 < KeyNum && getTime( key + 1 ) <= time; ++step) ++key;
+      if (key + 1 == KeyNum || time < getTime( key + 1 )) {
+         cursor.Key = key;
+         return key;
+      }
+   }
+
+   if (ChunkSize > 0) {
+      const size_t chunk_num = (KeyNum + ChunkSize - 1) / ChunkSize;
+      const size_t chunk = static_cast<size_t>(
+         std::upper_bound( ChunkStartTimes, ChunkStartTimes + chunk_num, time ) - ChunkStartTimes
+      );
+      const size_t begin = chunk == 0 ? 0 : (chunk - 1) * ChunkSize;
+      key = searchKey( time, begin, std::min( begin + ChunkSize, KeyNum ) );
+   }
+   else key = searchKey( time, 0, KeyNum );
+   cursor.Key = key;
+   return key;
+}
+
+template<typename T>
+size_t KeyframeTrack<T>::findSegment(double time, KeyframeCursor& cursor, float& t) const
+{
+   t = 0.0f;
+   if (KeyNum < 2) return 0;
+
+   const double local_time = getLocalTime( time );
+   const size_t key = findKey( local_time, cursor );
+   const bool last = key + 1 == KeyNum;
+   if (last && !Looping) return key;
+
+   const double key_time = getTime( key );
+   const double end_time = last ? getTime( 0 ) + Duration : getTime( key + 1 );
+   const double length = end_time - key_time;
+   t = static_cast<float>(length > 0.0 ? (local_time - key_time) / length : 0.0);
+   return key;
+}
+
+template<typename T>
+template<typename Interpolator>
+T KeyframeTrack<T>::evaluate(double time, KeyframeCursor& cursor, Interpolator interpolate) const
+{
+   if (KeyNum == 0) return T();
+   if (KeyNum == 1) return getValue( 0 );
+
+   float t;
+   const size_t key = findSegment( time, cursor, t );
+   const bool last = key + 1 == KeyNum;
+   if (last && !Looping) return getValue( key );
+
+   return interpolate( getValue( key ), getValue( last ? 0 : key + 1 ), t );
+}
\ No newline at end of file
@@ -1,11 +1,12 @@
 #pragma once
 
 #include "Shader.h"
+#include "BoundingVolume.h"
 
 class ObjectGL
 {
 public:
-   enum LayoutLocation { VertexLoc = 0, NormalLoc, TextureLoc };
+   enum LayoutLocation { VertexLoc = 0, NormalLoc, TextureLoc, InstanceLoc };
 
    ObjectGL();
    ~ObjectGL();
@@ -53,6 +54,9 @@ public:
       const std::vector<glm::vec3>& normals,
       const std::vector<glm::vec2>& textures
    );
+   // Per-instance vec4 attributes at InstanceLoc and the locations after it, vec4_num of them interleaved per instance.
+   void setInstanceBuffer(int vec4_num);
+   void updateInstanceBuffer(const std::vector<glm::vec4>& instances);
    void replaceVertices(const std::vector<glm::vec3>& vertices, bool normals_exist, bool textures_exist);
    void replaceVertices(const std::vector<float>& vertices, bool normals_exist, bool textures_exist);
    bool readObjectFile(
@@ -64,7 +68,10 @@ public:
    [[nodiscard]] GLuint getVAO() const { return VAO; }
    [[nodiscard]] GLenum getDrawMode() const { return DrawMode; }
    [[nodiscard]] GLsizei getVertexNum() const { return VerticesCount; }
+   [[nodiscard]] GLsizei getInstanceNum() const { return InstancesCount; }
    [[nodiscard]] glm::vec4 getColor() const { return DiffuseReflectionColor; }
+   // Object space bounds of the vertices, kept up to date whenever they change.
+   [[nodiscard]] const BoundingVolume& getBounds() const { return Bounds; }
 
 private:
    uint8_t* ImageBuffer;
@@ -75,11 +82,15 @@ private:
    std::vector<GLuint> TextureID;
    std::map<std::string, GLuint> CustomBuffers;
    GLsizei VerticesCount;
+   GLsizei InstancesCount;
+   int Vec4NumPerInstance;
    glm::vec4 DiffuseReflectionColor;
+   BoundingVolume Bounds;
 
    [[nodiscard]] bool prepareTexture2DUsingFreeImage(const std::string& file_path, bool is_grayscale) const;
    void prepareTexture(bool normals_exist) const;
    void prepareVertexBuffer(int n_bytes_per_vertex);
+   void updateBounds(int floats_per_vertex);
    void prepareNormal() const;
    static void getSquareObject(
       std::vector<glm::vec3>& vertices,
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "_Common.h"
+#include "RotationKernels.h"
+
+// Shorter-arc interpolation between two rotations, either with glm::slerp or with Eberly's polynomial slerp, which
+// needs neither acos nor sin and stays within RotationKernels::MaxSlerpErrorInRadians of the exact rotation.
+class QuaternionSlerp
+{
+public:
+   enum class Method { Exact = 0, Polynomial };
+
+   [[nodiscard]] static glm::quat interpolate(const glm::quat& from, const glm::quat& to, float t);
+   [[nodiscard]] static glm::quat approximate(const glm::quat& from, const glm::quat& to, float t);
+   // Batch form of the selected method; the polynomial one runs through RotationKernels in SIMD.
+   static void interpolate(
+      const ConstQuaternionArrays& from,
+      const ConstQuaternionArrays& to,
+      const float* t,
+      size_t count,
+      const QuaternionArrays& quaternions
+   );
+   [[nodiscard]] static Method getMethod() { return Selected; }
+   static void setMethod(Method method) { Selected = method; }
+   [[nodiscard]] static const char* getMethodName(Method method);
+
+private:
+   inline static Method Selected = Method::Exact;
+
+   [[nodiscard]] static float getWeight(float t, float cos_minus_one);
+};
\ No newline at end of file
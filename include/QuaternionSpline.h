@@ -0,0 +1,48 @@
+#pragma once
+
+#include "_Common.h"
+#include "KeyframeTrack.h"
+#include "RotationKernels.h"
+
+// C1-continuous interpolation of a quaternion track. The tangent at each key is squad's, the logarithms towards both
+// neighbours averaged by the key spacing, and every segment becomes a cubic Hermite curve in R4 whose coefficients
+// are precomputed here; evaluation is then three multiply-adds per component and a normalization, cheaper than slerp.
+class QuaternionSpline
+{
+public:
+   QuaternionSpline() = default;
+
+   void build(const KeyframeTrack<glm::quat>& track) { update( track, 0 ); }
+   // Recomputes only what depends on keys from first_changed_key on, e.g. after keys were appended.
+   void update(const KeyframeTrack<glm::quat>& track, size_t first_changed_key);
+   void clear();
+   [[nodiscard]] bool empty() const { return Segments.empty(); }
+   [[nodiscard]] glm::quat evaluate(const KeyframeTrack<glm::quat>& track, double time, KeyframeCursor& cursor) const;
+   // Batch form for many times at once; the segments are looked up first and the cubics then evaluated in SIMD.
+   void evaluate(
+      const KeyframeTrack<glm::quat>& track,
+      const double* times,
+      size_t count,
+      const QuaternionArrays& quaternions
+   ) const;
+
+private:
+   struct Segment
+   {
+      std::array<glm::vec4, 4> Coefficients;
+   };
+
+   std::vector<glm::vec3> AngularVelocities;
+   std::vector<Segment> Segments;
+
+   [[nodiscard]] static glm::vec3 getLogarithm(const glm::quat& from, const glm::quat& to);
+   [[nodiscard]] static double getSegmentLength(const KeyframeTrack<glm::quat>& track, size_t key);
+   [[nodiscard]] size_t getSegment(
+      const KeyframeTrack<glm::quat>& track,
+      double time,
+      KeyframeCursor& cursor,
+      float& t
+   ) const;
+   void updateAngularVelocity(const KeyframeTrack<glm::quat>& track, size_t key);
+   void updateSegment(const KeyframeTrack<glm::quat>& track, size_t key);
+};
\ No newline at end of file
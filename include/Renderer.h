@@ -11,6 +11,20 @@
 
 #include "_Common.h"
 #include "Object.h"
+#include "FrameState.h"
+#include "FrameScheduler.h"
+#include "FrameClock.h"
+#include "GpuProfiler.h"
+#include "FrameCapture.h"
+#include "FileWatcher.h"
+#include "KeyframeFile.h"
+#include "QuaternionSpline.h"
+#include "QuaternionSlerp.h"
+#include "JointHierarchy.h"
+#include "SceneStore.h"
+#include "FrustumCuller.h"
+#include "ThumbnailAtlas.h"
+#include "RotationPolicies.h"
 
 class RendererGL
 {
@@ -20,39 +34,132 @@ public:
    RendererGL& operator=(const RendererGL&) = delete;
    RendererGL& operator=(const RendererGL&&) = delete;
 
-
    RendererGL();
    ~RendererGL() = default;
 
    void play();
+   void setFramePacing(const FrameScheduler::Settings& settings) { Scheduler->setSettings( settings ); }
+   // With a simulated clock, frames follow each other as fast as they render, each at the next time of the clock.
+   void setClock(const FrameClock& clock) { Clock = clock; }
+   void setGpuProfiling(double report_interval, const std::string& csv_path);
+   void setFrameCapture(const FrameCaptureGL::Settings& settings) { FrameCapture->setSettings( settings ); }
+   void setShaderHotReload(bool hot_reload) { ShaderHotReload = hot_reload; }
+   [[nodiscard]] bool setTrackFile(const std::string& file_path);
+   // Replaces the teapot by chain_num chains of depth joints each, which the j key toggles.
+   void setJointChains(int chain_num, int depth);
+   // Replaces the teapot by object_num > 0 teapots and boxes, each rotating on its own, which the o key toggles.
+   void setSceneObjects(int object_num);
 
 private:
    struct Animation
    {
       bool AnimationMode;
+      bool SplineMode;
       double AnimationDuration;
-      double TimePerSection;
-      double StartTiming;
+      double KeyInterval;
       double ElapsedTime;
-      uint CurrentFrameIndex;
-      Animation() : AnimationMode( false ), AnimationDuration( 10000.0 ), TimePerSection( 0.0 ),
-      StartTiming( 0.0 ), ElapsedTime( 0.0 ), CurrentFrameIndex( 0 ) {}
+      double PreviousElapsedTime;
+      KeyframeCursor EulerAngleCursor;
+      KeyframeCursor QuaternionCursor;
+      Animation() : AnimationMode( false ), SplineMode( false ), AnimationDuration( 0.0 ), KeyInterval( 2000.0 ),
+      ElapsedTime( 0.0 ), PreviousElapsedTime( 0.0 ) {}
+   };
+
+   // Representations compared side by side; the tracks, the track file and the joint chains store their values.
+   using EulerAngleView = OrientateRotation;
+   using QuaternionView = QuaternionRotation;
+
+   // What a thumbnail shows; its slot in the atlas is drawn again only when this or the camera changes.
+   struct ThumbnailContent
+   {
+      bool TeapotDrawn;
+      bool Highlighted;
+      glm::mat4 ToWorld;
+
+      ThumbnailContent() : TeapotDrawn( false ), Highlighted( false ), ToWorld( 1.0f ) {}
+      [[nodiscard]] bool operator==(const ThumbnailContent& other) const
+      {
+         return TeapotDrawn == other.TeapotDrawn && Highlighted == other.Highlighted && ToWorld == other.ToWorld;
+      }
    };
 
+   // What has changed since the last rendered frame. Animation and recording damage every frame, the camera and the
+   // Euler angle are compared with what was drawn, and the rest is marked where it happens.
+   enum DamageFlag : uint
+   {
+      CameraDamage = 1u << 0,
+      EulerAngleDamage = 1u << 1,
+      CaptureDamage = 1u << 2,
+      AnimationDamage = 1u << 3,
+      SceneDamage = 1u << 4,
+      WindowDamage = 1u << 5
+   };
+
+   // Frusta of the views, all from the main camera for now, in the order the culler holds them.
+   enum ViewFrustum { EulerAngleFrustum = 0, QuaternionFrustum, ThumbnailFrustum, ViewFrustumNum };
+
+   // Meshes of the scene objects, in the order of their SceneStore handles.
+   enum SceneMesh { SceneTeapot = 0, SceneBox, SceneMeshNum };
+
+   inline static constexpr size_t ThumbnailNum = 5;
+   inline static constexpr int ThumbnailWidth = 384;
+   inline static constexpr int ThumbnailHeight = 216;
+   // Undamaged loops sleep in glfwWaitEventsTimeout for at most this many seconds, so nothing waits on a lost event
+   // for long, while idle wake-ups cost no more than a few comparisons.
+   inline static constexpr double IdleWaitTime = 0.5;
+
    inline static glm::ivec2 ClickedPoint;
    inline static std::unique_ptr<CameraGL> MainCamera;
    inline static glm::vec3 EulerAngle;
-   inline static int CapturedFrameIndex;
-   inline static std::vector<glm::vec3> CapturedEulerAngles;
-   inline static std::vector<glm::quat> CapturedQuaternions;
+   inline static KeyframeTrack<EulerAngleView::Value> EulerAngleTrack;
+   inline static KeyframeTrack<QuaternionView::Value> QuaternionTrack;
+   inline static QuaternionSpline QuaternionCurve;
+   inline static std::unique_ptr<KeyframeFile> TrackFile;
    inline static std::unique_ptr<Animation> Animator;
+   inline static bool RecordingMode;
+   inline static bool JointMode;
+   inline static bool SceneMode;
+   // Milliseconds, like the animation time.
+   inline static double SceneTime;
+   inline static double PreviousSceneTime;
+   inline static uint Damage;
 
    GLFWwindow* Window;
    int FrameWidth;
    int FrameHeight;
+   uint64_t FrameIndex;
+   FrameStateBuffer FrameState;
+   FrameClock Clock;
+   std::unique_ptr<FrameScheduler> Scheduler;
+   std::unique_ptr<GpuProfilerGL> GpuProfiler;
+   std::string GpuProfileFilePath;
+   std::unique_ptr<FrameCaptureGL> FrameCapture;
+   bool ShaderHotReload;
+   std::unique_ptr<FileWatcher> ShaderWatcher;
    std::unique_ptr<ShaderGL> ObjectShader;
+   std::unique_ptr<ShaderGL> AxisShader;
+   std::unique_ptr<ShaderGL> JointShader;
+   std::unique_ptr<ShaderGL> SceneShader;
+   uint64_t SkippedUniformUploadNum;
    std::unique_ptr<ObjectGL> AxisObject;
    std::unique_ptr<ObjectGL> TeapotObject;
+   std::unique_ptr<ObjectGL> JointObject;
+   std::unique_ptr<TaskScheduler> Tasks;
+   JointHierarchy EulerAngleJoints;
+   JointHierarchy QuaternionJoints;
+   int JointDepth;
+   std::vector<std::unique_ptr<ObjectGL>> SceneMeshes;
+   SceneStore Scene;
+   int SceneObjectNum;
+   FrustumCuller Culler;
+   uint64_t CulledCameraVersion;
+   std::unique_ptr<ThumbnailAtlasGL> Thumbnails;
+   std::array<ThumbnailContent, ThumbnailNum> ThumbnailContents;
+   uint64_t ThumbnailCameraVersion;
+   uint64_t DrawnCameraVersion;
+   glm::vec3 DrawnEulerAngle;
+   // Set by the render thread when a recording cannot start, so the simulation turns the recording mode off.
+   std::atomic<bool> CaptureFailed;
  
    void registerCallbacks() const;
    void initialize();
@@ -64,16 +171,61 @@ private:
    static void cursor(GLFWwindow* window, double xpos, double ypos);
    static void mouse(GLFWwindow* window, int button, int action, int mods);
    static void reshape(GLFWwindow* window, int width, int height);
+   static void refresh(GLFWwindow* window);
 
    static void captureFrame();
+   template<typename Rotation>
+   [[nodiscard]] static typename Rotation::Value evaluateTrack(
+      const KeyframeTrack<typename Rotation::Value>& track,
+      double time,
+      KeyframeCursor& cursor
+   );
+   template<typename Rotation>
+   [[nodiscard]] static glm::mat4 getWorldMatrix(const typename Rotation::Value& rotation)
+   {
+      return glm::mat4(Rotation::toMatrix( rotation ));
+   }
 
    void setAxisObject() const;
    void setTeapotObject() const;
-   void drawAxisObject(float scale_factor = 1.0f) const;
-   void drawTeapotObject(const glm::mat4& to_world) const;
-   void displayEulerAngleMode();
-   void displayQuaternionMode();
-   void displayCapturedFrames();
-   static void update();
-   void render();
-};
\ No newline at end of file
+   void setJointObject() const;
+   void buildScene();
+   static void getBoxObject(
+      std::vector<glm::vec3>& vertices,
+      std::vector<glm::vec3>& normals,
+      const glm::vec3& center,
+      const glm::vec3& extent
+   );
+   void drawAxisObject(const FramePacket& frame, float scale_factor = 1.0f) const;
+   void drawTeapotObject(const FramePacket& frame, const glm::mat4& to_world) const;
+   void drawJointObjects(const FramePacket& frame, const std::vector<glm::vec4>& instances) const;
+   void drawSceneObjects(const FramePacket& frame, const std::vector<std::vector<glm::vec4>>& instances) const;
+   void displayEulerAngleMode(const FramePacket& frame);
+   void displayQuaternionMode(const FramePacket& frame);
+   void drawThumbnail(const FramePacket& frame, const ThumbnailContent& content) const;
+   void displayCapturedFrames(const FramePacket& frame);
+   static void update(double step);
+   static void notifyActivity(GLFWwindow* window);
+   [[nodiscard]] bool isSceneShown() const { return SceneMode && Scene.getEntityNum() > 0; }
+   [[nodiscard]] uint getDamage() const;
+   void clearDamage();
+   void cullObjects(FramePacket& frame);
+   void prepareFramePacket(FramePacket& frame, double interpolation_factor);
+   void render(const FramePacket& frame);
+   // Returns true if any program has been replaced.
+   [[nodiscard]] bool reloadChangedShaders() const;
+   void renderLoop();
+};
+
+template<typename Rotation>
+typename Rotation::Value RendererGL::evaluateTrack(
+   const KeyframeTrack<typename Rotation::Value>& track,
+   double time,
+   KeyframeCursor& cursor
+)
+{
+   using Value = typename Rotation::Value;
+   return track.evaluate(
+      time, cursor, [](const Value& a, const Value& b, float t) { return Rotation::interpolate( a, b, t ); }
+   );
+}
\ No newline at end of file
@@ -0,0 +1,179 @@
+#pragma once
+
+// Unlike the other headers this one does not include _Common.h: it is also compiled with AVX2/AVX-512 flags,
+// and inline std/glm code instantiated there could be picked by the linker for the generic build as well.
+#include <cstddef>
+
+// Euler angles follow glm::orientate3, i.e. X is the pitch, Y the roll and Z the yaw, all in radians.
+struct EulerAngleArrays
+{
+   const float* X;
+   const float* Y;
+   const float* Z;
+};
+
+struct QuaternionArrays
+{
+   float* W;
+   float* X;
+   float* Y;
+   float* Z;
+};
+
+struct ConstQuaternionArrays
+{
+   const float* W;
+   const float* X;
+   const float* Y;
+   const float* Z;
+};
+
+// One array per matrix element in glm's column-major order, M[column * rows + row].
+struct Matrix3Arrays
+{
+   float* M[9];
+};
+
+struct Matrix4Arrays
+{
+   float* M[16];
+};
+
+// Per sample measures of how close Euler angles are to gimbal lock: the Frobenius-norm condition number of the
+// Jacobian from Euler angle rates to angular velocity (3 at best, between the 2-norm one and 3 times it, infinite at
+// gimbal lock), the angle in radians between the roll and yaw axes or their opposites (0 at gimbal lock), and the
+// rotation angle in radians between lerping the Euler angles and slerping their quaternions, halfway towards the angles
+// one interpolation step further on every axis.
+struct GimbalMetricArrays
+{
+   float* ConditionNumber;
+   float* SingularityDistance;
+   float* InterpolationDivergence;
+};
+
+// Joints sorted so that [begin, end) of propagateJoints never contains a parent of its own joints, e.g. one depth level
+// of a hierarchy. Their world rotations are parent * local, and their world positions the parent positions plus the
+// local translations rotated by the parent rotations.
+struct JointArrays
+{
+   const int* Parents;
+   ConstQuaternionArrays LocalRotations;
+   const float* LocalTranslations[3];
+   QuaternionArrays WorldRotations;
+   float* WorldPositions[3];
+};
+
+// Box of points stored a stride of floats apart, e.g. the positions in an interleaved vertex buffer, and their largest
+// squared distance from a center.
+struct PointBounds
+{
+   float Min[3];
+   float Max[3];
+   float MaxSquaredDistance;
+};
+
+// Bounding volumes of many objects: boxes as centers and half extents, and spheres of the given radii around the same
+// centers. Whichever of the two reaches less far towards a plane decides, so the test is as tight as the tighter one.
+struct BoundingVolumeArrays
+{
+   const float* Centers[3];
+   const float* Extents[3];
+   const float* Radii;
+};
+
+// Batch conversions of structure-of-arrays Euler angles, dispatched to the widest instruction set the CPU supports.
+// Results match glm's orientate3/orientate4 and toQuat( orientate3 ) within MaxErrorInUlps units of FLT_EPSILON,
+// and quaternions are in the same hemisphere as glm's, i.e. their largest component is positive.
+class RotationKernels
+{
+public:
+   enum class InstructionSet { Scalar = 0, SSE, AVX2, AVX512 };
+
+   inline static constexpr float MaxErrorInUlps = 4.0f;
+   // Bound on the rotation angle between slerpQuaternions and the exact slerp; the truncation error of the polynomial
+   // peaks at about 1.8e-5 radians, 0.001 degrees, for rotations half a turn apart. The results are not renormalized,
+   // so their norms are within 4e-5 of 1.
+   inline static constexpr float MaxSlerpErrorInRadians = 2.0e-5f;
+
+   static void toQuaternions(const EulerAngleArrays& angles, const QuaternionArrays& quaternions, size_t count);
+   static void toMatrices(const EulerAngleArrays& angles, const Matrix3Arrays& matrices, size_t count);
+   static void toMatrices(const EulerAngleArrays& angles, const Matrix4Arrays& matrices, size_t count);
+   // Normalized cubics in R4: coefficients holds 16 floats per segment, the x, y, z, w vectors of the constant, linear,
+   // quadratic and cubic terms, and segments[i] selects the cubic evaluated at t[i]. Segment indices must stay below 2^27.
+   static void evaluateQuaternionCubics(
+      const float* coefficients,
+      const int* segments,
+      const float* t,
+      size_t count,
+      const QuaternionArrays& quaternions
+   );
+   // Polynomial slerp of many quaternion pairs without acos or sin, taking the shorter arc like glm::slerp.
+   static void slerpQuaternions(
+      const ConstQuaternionArrays& from,
+      const ConstQuaternionArrays& to,
+      const float* t,
+      size_t count,
+      const QuaternionArrays& quaternions
+   );
+   static void getGimbalMetrics(
+      const EulerAngleArrays& angles,
+      float interpolation_step,
+      const GimbalMetricArrays& metrics,
+      size_t count
+   );
+   static void propagateJoints(const JointArrays& joints, size_t begin, size_t end);
+   // MaxSquaredDistance is only computed, from center, if center is not null.
+   static void getPointBounds(
+      const float* points,
+      size_t stride,
+      size_t count,
+      const float* center,
+      PointBounds& bounds
+   );
+   // planes holds frustum_num frusta of 6 inward-facing planes (a, b, c, d) with unit normals, at most 32 frusta.
+   // Bit f of visible[i] is set if volume i may be in frustum f, and of contained[i], if not null, if it certainly is
+   // entirely inside.
+   static void cullBoundingVolumes(
+      const BoundingVolumeArrays& volumes,
+      const float* planes,
+      int frustum_num,
+      size_t count,
+      unsigned int* visible,
+      unsigned int* contained
+   );
+   [[nodiscard]] static InstructionSet getSupportedInstructionSet();
+   [[nodiscard]] static InstructionSet getInstructionSet() { return Selected; }
+   // Falls back to the widest supported instruction set if the requested one is not available.
+   static void setInstructionSet(InstructionSet instruction_set);
+   [[nodiscard]] static const char* getInstructionSetName(InstructionSet instruction_set);
+
+private:
+   struct KernelTable
+   {
+      void (*ToQuaternions)(const EulerAngleArrays&, const QuaternionArrays&, size_t);
+      void (*ToMatrices3)(const EulerAngleArrays&, const Matrix3Arrays&, size_t);
+      void (*ToMatrices4)(const EulerAngleArrays&, const Matrix4Arrays&, size_t);
+      void (*EvaluateQuaternionCubics)(const float*, const int*, const float*, size_t, const QuaternionArrays&);
+      void (*SlerpQuaternions)(
+         const ConstQuaternionArrays&,
+         const ConstQuaternionArrays&,
+         const float*,
+         size_t,
+         const QuaternionArrays&
+      );
+      void (*GetGimbalMetrics)(const EulerAngleArrays&, float, const GimbalMetricArrays&, size_t);
+      void (*PropagateJoints)(const JointArrays&, size_t, size_t);
+      void (*GetPointBounds)(const float*, size_t, size_t, const float*, PointBounds&);
+      void (*CullBoundingVolumes)(
+         const BoundingVolumeArrays&, const float*, int, size_t, unsigned int*, unsigned int*
+      );
+   };
+
+   static InstructionSet Selected;
+   static const KernelTable ScalarKernels;
+   static const KernelTable SSEKernels;
+   static const KernelTable AVX2Kernels;
+   static const KernelTable AVX512Kernels;
+
+   [[nodiscard]] static const KernelTable& getKernels();
+};
\ No newline at end of file
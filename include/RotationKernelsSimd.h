@@ -0,0 +1,667 @@
+#pragma once
+
+#include "RotationKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Shared bodies of the batch kernels. Each instruction set provides a lane type V with Float/Int vector types and
+// one-line wrappers around its intrinsics; the lane types live in anonymous namespaces, so instantiations made with
+// different compiler flags never collide at link time.
+namespace RotationKernelsSimd
+{
+   // Cephes-style sincos: Cody-Waite reduction by multiples of pi/4, then a degree 7 (sin) or 8 (cos) polynomial
+   // on [-pi/4, pi/4]. About 1 ulp for |x| < 8192, which covers any angle the analysis produces.
+   template<typename V>
+   inline void sincos(typename V::Float x, typename V::Float& s, typename V::Float& c)
+   {
+      using F = typename V::Float;
+      using I = typename V::Int;
+      const I sign_mask = V::setInt( static_cast<int>(0x80000000u) );
+      const I x_sign = V::andInt( V::castToInt( x ), sign_mask );
+      F a = V::castToFloat( V::andNotInt( sign_mask, V::castToInt( x ) ) );
+
+      I j = V::toInt( V::mul( a, V::set( 1.27323954473516f ) ) );
+      j = V::andInt( V::addInt( j, V::setInt( 1 ) ), V::setInt( ~1 ) );
+      const F y = V::toFloat( j );
+      const I sin_sign = V::xorInt( V::template shiftLeft<29>( V::andInt( j, V::setInt( 4 ) ) ), x_sign );
+      const I cos_sign = V::template shiftLeft<29>( V::andNotInt( V::subInt( j, V::setInt( 2 ) ), V::setInt( 4 ) ) );
+      const I swap_mask = V::template shiftRightArithmetic<31>( V::template shiftLeft<30>( j ) );
+
+      a = V::fma( y, V::set( -0.78515625f ), a );
+      a = V::fma( y, V::set( -2.4187564849853515625e-4f ), a );
+      a = V::fma( y, V::set( -3.77489497744594108e-8f ), a );
+
+      const F z = V::mul( a, a );
+      F cos_poly = V::fma( V::set( 2.443315711809948e-5f ), z, V::set( -1.388731625493765e-3f ) );
+      cos_poly = V::fma( cos_poly, z, V::set( 4.166664568298827e-2f ) );
+      cos_poly = V::fma( V::mul( cos_poly, z ), z, V::fma( z, V::set( -0.5f ), V::set( 1.0f ) ) );
+      F sin_poly = V::fma( V::set( -1.9515295891e-4f ), z, V::set( 8.3321608736e-3f ) );
+      sin_poly = V::fma( sin_poly, z, V::set( -1.6666654611e-1f ) );
+      sin_poly = V::fma( V::mul( sin_poly, z ), a, a );
+
+      const I sin_bits = V::orInt(
+         V::andInt( swap_mask, V::castToInt( cos_poly ) ), V::andNotInt( swap_mask, V::castToInt( sin_poly ) )
+      );
+      const I cos_bits = V::orInt(
+         V::andInt( swap_mask, V::castToInt( sin_poly ) ), V::andNotInt( swap_mask, V::castToInt( cos_poly ) )
+      );
+      s = V::castToFloat( V::xorInt( sin_bits, sin_sign ) );
+      c = V::castToFloat( V::xorInt( cos_bits, cos_sign ) );
+   }
+
+   // Cephes-style asin for x in [0, 1]: a degree 11 odd polynomial up to 0.5, and asin( x ) = pi/2 - 2 asin( sqrt(
+   // (1 - x) / 2 ) ) above, where the polynomial would converge slowly. Inputs above 1 are clamped.
+   template<typename V>
+   inline typename V::Float asin(typename V::Float x)
+   {
+      using F = typename V::Float;
+      const F one = V::set( 1.0f );
+      const F half = V::set( 0.5f );
+      x = V::lessThanSelect( one, x, one, x );
+      const F reduced = V::sqrt( V::mul( half, V::sub( one, x ) ) );
+      const F s = V::lessThanSelect( half, x, reduced, x );
+      const F z = V::mul( s, s );
+      F p = V::fma( V::set( 4.2163199048e-2f ), z, V::set( 2.4181311049e-2f ) );
+      p = V::fma( p, z, V::set( 4.5470025998e-2f ) );
+      p = V::fma( p, z, V::set( 7.4953002686e-2f ) );
+      p = V::fma( p, z, V::set( 1.6666752422e-1f ) );
+      p = V::fma( V::mul( p, z ), s, s );
+      return V::lessThanSelect( half, x, V::fma( p, V::set( -2.0f ), V::set( 1.57079632679f ) ), p );
+   }
+
+   // Angle in [0, pi/2] from its non-negative sine and cosine; asin of the smaller one stays accurate at both ends.
+   template<typename V>
+   inline typename V::Float getAngle(typename V::Float sine, typename V::Float cosine)
+   {
+      const auto angle = asin<V>( V::lessThanSelect( sine, cosine, sine, cosine ) );
+      return V::lessThanSelect( sine, cosine, angle, V::sub( V::set( 1.57079632679f ), angle ) );
+   }
+
+   // Runs kernel over full vectors, then over one zero-padded vector for the tail, so that every element goes
+   // through exactly the same instructions.
+   template<typename V, size_t OutputNum, typename Kernel>
+   inline void runBatch(const EulerAngleArrays& angles, float* const* outputs, size_t count, Kernel kernel)
+   {
+      typename V::Float results[OutputNum];
+      size_t i = 0;
+      for (; i + V::Width <= count; i += V::Width) {
+         kernel( V::load( angles.X + i ), V::load( angles.Y + i ), V::load( angles.Z + i ), results );
+         for (size_t k = 0; k < OutputNum; ++k) V::store( outputs[k] + i, results[k] );
+      }
+      if (i == count) return;
+
+      const size_t rest = count - i;
+      float x[V::Width] = {}, y[V::Width] = {}, z[V::Width] = {}, tail[V::Width];
+      for (size_t j = 0; j < rest; ++j) {
+         x[j] = angles.X[i + j];
+         y[j] = angles.Y[i + j];
+         z[j] = angles.Z[i + j];
+      }
+      kernel( V::load( x ), V::load( y ), V::load( z ), results );
+      for (size_t k = 0; k < OutputNum; ++k) {
+         V::store( tail, results[k] );
+         for (size_t j = 0; j < rest; ++j) outputs[k][i + j] = tail[j];
+      }
+   }
+
+   template<typename V>
+   void evaluateQuaternionCubics(
+      const float* coefficients,
+      const int* segments,
+      const float* t,
+      size_t count,
+      const QuaternionArrays& quaternions
+   )
+   {
+      using F = typename V::Float;
+      using I = typename V::Int;
+      const auto evaluate = [coefficients](I segment, F s, F* q) {
+         const I offset = V::template shiftLeft<4>( segment );
+         F norm = V::set( 0.0f );
+         for (int k = 0; k < 4; ++k) {
+            F p = V::gather( coefficients + 12 + k, offset );
+            p = V::fma( p, s, V::gather( coefficients + 8 + k, offset ) );
+            p = V::fma( p, s, V::gather( coefficients + 4 + k, offset ) );
+            q[k] = V::fma( p, s, V::gather( coefficients + k, offset ) );
+            norm = V::fma( q[k], q[k], norm );
+         }
+         norm = V::sqrt( norm );
+         for (int k = 0; k < 4; ++k) q[k] = V::div( q[k], norm );
+      };
+
+      float* const outputs[4] = { quaternions.X, quaternions.Y, quaternions.Z, quaternions.W };
+      F q[4];
+      size_t i = 0;
+      for (; i + V::Width <= count; i += V::Width) {
+         evaluate( V::loadInt( segments + i ), V::load( t + i ), q );
+         for (int k = 0; k < 4; ++k) V::store( outputs[k] + i, q[k] );
+      }
+      if (i == count) return;
+
+      const size_t rest = count - i;
+      int tail_segments[V::Width] = {};
+      float tail_t[V::Width] = {}, tail[V::Width];
+      for (size_t j = 0; j < rest; ++j) {
+         tail_segments[j] = segments[i + j];
+         tail_t[j] = t[i + j];
+      }
+      evaluate( V::loadInt( tail_segments ), V::load( tail_t ), q );
+      for (int k = 0; k < 4; ++k) {
+         V::store( tail, q[k] );
+         for (size_t j = 0; j < rest; ++j) outputs[k][i + j] = tail[j];
+      }
+   }
+
+   // Eberly, "A Fast and Accurate Algorithm for Computing SLERP": with x = cos( theta ), the slerp weight
+   // sin( t * theta ) / sin( theta ) is t * (1 + b1 * (1 + b2 * (... (1 + b8)))), where
+   // bi = (t^2 / (i * (2i + 1)) - i / (2i + 1)) * (x - 1). The last term is scaled by 1 + mu for the truncated ones.
+   struct SlerpPolynomial
+   {
+      inline static constexpr int TermNum = 8;
+      inline static constexpr float OnePlusMu = 1.90110745351730037f;
+      inline static constexpr float SquareCoefficients[TermNum] = {
+         1.0f / 3.0f, 1.0f / 10.0f, 1.0f / 21.0f, 1.0f / 36.0f, 1.0f / 55.0f, 1.0f / 78.0f, 1.0f / 105.0f,
+         OnePlusMu / 136.0f
+      };
+      inline static constexpr float ConstantCoefficients[TermNum] = {
+         1.0f / 3.0f, 2.0f / 5.0f, 3.0f / 7.0f, 4.0f / 9.0f, 5.0f / 11.0f, 6.0f / 13.0f, 7.0f / 15.0f,
+         OnePlusMu * 8.0f / 17.0f
+      };
+   };
+
+   template<typename V>
+   inline typename V::Float getSlerpWeight(typename V::Float t, typename V::Float cos_minus_one)
+   {
+      using F = typename V::Float;
+      const F one = V::set( 1.0f );
+      const F t_squared = V::mul( t, t );
+      F weight = one;
+      for (int i = SlerpPolynomial::TermNum - 1; i >= 0; --i) {
+         const F b = V::mul(
+            V::fma( V::set( SlerpPolynomial::SquareCoefficients[i] ), t_squared,
+               V::set( -SlerpPolynomial::ConstantCoefficients[i] ) ),
+            cos_minus_one
+         );
+         weight = V::fma( b, weight, one );
+      }
+      return V::mul( weight, t );
+   }
+
+   template<typename V>
+   void slerpQuaternions(
+      const ConstQuaternionArrays& from,
+      const ConstQuaternionArrays& to,
+      const float* t,
+      size_t count,
+      const QuaternionArrays& quaternions
+   )
+   {
+      using F = typename V::Float;
+      using I = typename V::Int;
+      const auto interpolate = [](const F* a, const F* b, F s, F* q) {
+         F cosine = V::mul( a[0], b[0] );
+         for (int k = 1; k < 4; ++k) cosine = V::fma( a[k], b[k], cosine );
+
+         // Like glm::slerp, b is negated when the pair is more than a quarter turn apart in R4.
+         const I sign_mask = V::setInt( static_cast<int>(0x80000000u) );
+         const I sign = V::andInt( V::castToInt( cosine ), sign_mask );
+         cosine = V::castToFloat( V::xorInt( V::castToInt( cosine ), sign ) );
+         const F cos_minus_one = V::sub( cosine, V::set( 1.0f ) );
+         const F weight_a = getSlerpWeight<V>( V::sub( V::set( 1.0f ), s ), cos_minus_one );
+         const F weight_b = V::castToFloat( V::xorInt( V::castToInt( getSlerpWeight<V>( s, cos_minus_one ) ), sign ) );
+         for (int k = 0; k < 4; ++k) q[k] = V::fma( weight_a, a[k], V::mul( weight_b, b[k] ) );
+      };
+
+      const float* const inputs_a[4] = { from.W, from.X, from.Y, from.Z };
+      const float* const inputs_b[4] = { to.W, to.X, to.Y, to.Z };
+      float* const outputs[4] = { quaternions.W, quaternions.X, quaternions.Y, quaternions.Z };
+      F a[4], b[4], q[4];
+      size_t i = 0;
+      for (; i + V::Width <= count; i += V::Width) {
+         for (int k = 0; k < 4; ++k) {
+            a[k] = V::load( inputs_a[k] + i );
+            b[k] = V::load( inputs_b[k] + i );
+         }
+         interpolate( a, b, V::load( t + i ), q );
+         for (int k = 0; k < 4; ++k) V::store( outputs[k] + i, q[k] );
+      }
+      if (i == count) return;
+
+      const size_t rest = count - i;
+      float tail_a[4][V::Width] = {}, tail_b[4][V::Width] = {}, tail_t[V::Width] = {}, tail[V::Width];
+      for (size_t j = 0; j < rest; ++j) {
+         for (int k = 0; k < 4; ++k) {
+            tail_a[k][j] = inputs_a[k][i + j];
+            tail_b[k][j] = inputs_b[k][i + j];
+         }
+         tail_t[j] = t[i + j];
+      }
+      for (int k = 0; k < 4; ++k) {
+         a[k] = V::load( tail_a[k] );
+         b[k] = V::load( tail_b[k] );
+      }
+      interpolate( a, b, V::load( tail_t ), q );
+      for (int k = 0; k < 4; ++k) {
+         V::store( tail, q[k] );
+         for (size_t j = 0; j < rest; ++j) outputs[k][i + j] = tail[j];
+      }
+   }
+
+   // w, x, y, z of R_y(yaw) * R_x(pitch) * R_z(roll), i.e. orientate3, as the product of the half-angle quaternions.
+   template<typename V>
+   inline void getQuaternion(
+      typename V::Float pitch,
+      typename V::Float roll,
+      typename V::Float yaw,
+      typename V::Float* q
+   )
+   {
+      using F = typename V::Float;
+      const F half = V::set( 0.5f );
+      F sp, cp, sb, cb, sh, ch;
+      sincos<V>( V::mul( pitch, half ), sp, cp );
+      sincos<V>( V::mul( roll, half ), sb, cb );
+      sincos<V>( V::mul( yaw, half ), sh, ch );
+      const F chcp = V::mul( ch, cp );
+      const F shsp = V::mul( sh, sp );
+      const F chsp = V::mul( ch, sp );
+      const F shcp = V::mul( sh, cp );
+      q[0] = V::fma( chcp, cb, V::mul( shsp, sb ) );
+      q[1] = V::fma( chsp, cb, V::mul( shcp, sb ) );
+      q[2] = V::sub( V::mul( shcp, cb ), V::mul( chsp, sb ) );
+      q[3] = V::sub( V::mul( chcp, sb ), V::mul( shsp, cb ) );
+   }
+
+   template<typename V>
+   void toQuaternions(const EulerAngleArrays& angles, const QuaternionArrays& quaternions, size_t count)
+   {
+      using F = typename V::Float;
+      using I = typename V::Int;
+      float* const outputs[4] = { quaternions.W, quaternions.X, quaternions.Y, quaternions.Z };
+      runBatch<V, 4>( angles, outputs, count, [](F pitch, F roll, F yaw, F* q) {
+         getQuaternion<V>( pitch, roll, yaw, q );
+
+         // glm::toQuat makes the largest component positive, preferring w, x, y, z in that order on ties.
+         const I sign_mask = V::setInt( static_cast<int>(0x80000000u) );
+         F largest = V::castToFloat( V::andNotInt( sign_mask, V::castToInt( q[0] ) ) );
+         F sign = V::castToFloat( V::andInt( sign_mask, V::castToInt( q[0] ) ) );
+         for (int k = 1; k < 4; ++k) {
+            const F magnitude = V::castToFloat( V::andNotInt( sign_mask, V::castToInt( q[k] ) ) );
+            sign = V::lessThanSelect(
+               largest, magnitude, V::castToFloat( V::andInt( sign_mask, V::castToInt( q[k] ) ) ), sign
+            );
+            largest = V::max( largest, magnitude );
+         }
+         for (int k = 0; k < 4; ++k) q[k] = V::castToFloat( V::xorInt( V::castToInt( q[k] ), V::castToInt( sign ) ) );
+      } );
+   }
+
+   // Same products as glm::yawPitchRoll, so the only differences come from sincos and fused multiply-adds.
+   template<typename V>
+   inline void getRotationMatrix(
+      typename V::Float pitch,
+      typename V::Float roll,
+      typename V::Float yaw,
+      typename V::Float* m
+   )
+   {
+      using F = typename V::Float;
+      F sp, cp, sb, cb, sh, ch;
+      sincos<V>( pitch, sp, cp );
+      sincos<V>( roll, sb, cb );
+      sincos<V>( yaw, sh, ch );
+      const F shsp = V::mul( sh, sp );
+      const F chsp = V::mul( ch, sp );
+      m[0] = V::fma( shsp, sb, V::mul( ch, cb ) );
+      m[1] = V::mul( sb, cp );
+      m[2] = V::sub( V::mul( chsp, sb ), V::mul( sh, cb ) );
+      m[3] = V::sub( V::mul( shsp, cb ), V::mul( ch, sb ) );
+      m[4] = V::mul( cb, cp );
+      m[5] = V::fma( chsp, cb, V::mul( sb, sh ) );
+      m[6] = V::mul( sh, cp );
+      m[7] = V::castToFloat( V::xorInt( V::castToInt( sp ), V::setInt( static_cast<int>(0x80000000u) ) ) );
+      m[8] = V::mul( ch, cp );
+   }
+
+   template<typename V>
+   void toMatrices3(const EulerAngleArrays& angles, const Matrix3Arrays& matrices, size_t count)
+   {
+      using F = typename V::Float;
+      runBatch<V, 9>( angles, matrices.M, count, [](F pitch, F roll, F yaw, F* m) {
+         getRotationMatrix<V>( pitch, roll, yaw, m );
+      } );
+   }
+
+   template<typename V>
+   void toMatrices4(const EulerAngleArrays& angles, const Matrix4Arrays& matrices, size_t count)
+   {
+      using F = typename V::Float;
+      runBatch<V, 16>( angles, matrices.M, count, [](F pitch, F roll, F yaw, F* m) {
+         F r[9];
+         getRotationMatrix<V>( pitch, roll, yaw, r );
+         const F zero = V::set( 0.0f );
+         m[0] = r[0]; m[1] = r[1]; m[2] = r[2]; m[3] = zero;
+         m[4] = r[3]; m[5] = r[4]; m[6] = r[5]; m[7] = zero;
+         m[8] = r[6]; m[9] = r[7]; m[10] = r[8]; m[11] = zero;
+         m[12] = zero; m[13] = zero; m[14] = zero; m[15] = V::set( 1.0f );
+      } );
+   }
+
+   template<typename V>
+   inline typename V::Float abs(typename V::Float a)
+   {
+      return V::castToFloat( V::andNotInt( V::setInt( static_cast<int>(0x80000000u) ), V::castToInt( a ) ) );
+   }
+
+   template<typename V>
+   inline void cross(const typename V::Float* a, const typename V::Float* b, typename V::Float* c)
+   {
+      c[0] = V::sub( V::mul( a[1], b[2] ), V::mul( a[2], b[1] ) );
+      c[1] = V::sub( V::mul( a[2], b[0] ), V::mul( a[0], b[2] ) );
+      c[2] = V::sub( V::mul( a[0], b[1] ), V::mul( a[1], b[0] ) );
+   }
+
+   template<typename V>
+   inline typename V::Float dot3(const typename V::Float* a, const typename V::Float* b)
+   {
+      return V::fma( a[0], b[0], V::fma( a[1], b[1], V::mul( a[2], b[2] ) ) );
+   }
+
+   template<typename V>
+   void getGimbalMetrics(
+      const EulerAngleArrays& angles,
+      float interpolation_step,
+      const GimbalMetricArrays& metrics,
+      size_t count
+   )
+   {
+      using F = typename V::Float;
+      using I = typename V::Int;
+      float* const outputs[3] = {
+         metrics.ConditionNumber, metrics.SingularityDistance, metrics.InterpolationDivergence
+      };
+      runBatch<V, 3>( angles, outputs, count, [interpolation_step](F pitch, F roll, F yaw, F* results) {
+         // The angular velocity is J * (pitch', roll', yaw'), and the columns of J are the world space axes of the
+         // three rotations: R_y x, R_y R_x z and y. J^-1 = adj( J ) / det( J ), and the rows of adj( J ) are the
+         // cross products of the columns, so the Frobenius condition number needs no division but the last one.
+         F sp, cp, sh, ch;
+         sincos<V>( pitch, sp, cp );
+         sincos<V>( yaw, sh, ch );
+         const F zero = V::set( 0.0f );
+         const F one = V::set( 1.0f );
+         const F pitch_axis[3] = { ch, zero, V::sub( zero, sh ) };
+         const F roll_axis[3] = { V::mul( sh, cp ), V::sub( zero, sp ), V::mul( ch, cp ) };
+         const F yaw_axis[3] = { zero, one, zero };
+         F roll_yaw[3], yaw_pitch[3], pitch_roll[3];
+         cross<V>( roll_axis, yaw_axis, roll_yaw );
+         cross<V>( yaw_axis, pitch_axis, yaw_pitch );
+         cross<V>( pitch_axis, roll_axis, pitch_roll );
+         const F norm = V::add(
+            dot3<V>( pitch_axis, pitch_axis ), V::add( dot3<V>( roll_axis, roll_axis ), dot3<V>( yaw_axis, yaw_axis ) )
+         );
+         const F adjugate_norm = V::add(
+            dot3<V>( roll_yaw, roll_yaw ), V::add( dot3<V>( yaw_pitch, yaw_pitch ), dot3<V>( pitch_roll, pitch_roll ) )
+         );
+         results[0] = V::div( V::sqrt( V::mul( norm, adjugate_norm ) ), abs<V>( dot3<V>( pitch_axis, roll_yaw ) ) );
+
+         // Gimbal lock is where the roll axis lines up with the yaw axis, both unit vectors here.
+         results[1] = getAngle<V>( V::sqrt( dot3<V>( roll_yaw, roll_yaw ) ), abs<V>( dot3<V>( roll_axis, yaw_axis ) ) );
+
+         // Rotation angle between the midpoints of lerping the Euler angles and of slerping their quaternions, towards
+         // the angles one step further on every axis. At t = 0.5 slerp is the normalized sum on the shorter arc.
+         const F step = V::set( interpolation_step );
+         const F half_step = V::set( 0.5f * interpolation_step );
+         F from[4], to[4], middle[4];
+         getQuaternion<V>( pitch, roll, yaw, from );
+         getQuaternion<V>( V::add( pitch, step ), V::add( roll, step ), V::add( yaw, step ), to );
+         getQuaternion<V>( V::add( pitch, half_step ), V::add( roll, half_step ), V::add( yaw, half_step ), middle );
+         F from_to = V::mul( from[0], to[0] );
+         for (int k = 1; k < 4; ++k) from_to = V::fma( from[k], to[k], from_to );
+         const I sign = V::andInt( V::castToInt( from_to ), V::setInt( static_cast<int>(0x80000000u) ) );
+         F sum[4];
+         for (int k = 0; k < 4; ++k) {
+            sum[k] = V::add( from[k], V::castToFloat( V::xorInt( V::castToInt( to[k] ), sign ) ) );
+         }
+
+         // conjugate( middle ) * sum, whose vector and real parts over |sum| are the sine and cosine of half the angle.
+         const F middle_vector[3] = { middle[1], middle[2], middle[3] };
+         const F sum_vector[3] = { sum[1], sum[2], sum[3] };
+         F middle_sum[3];
+         cross<V>( middle_vector, sum_vector, middle_sum );
+         F difference[3];
+         for (int k = 0; k < 3; ++k) {
+            difference[k] = V::sub(
+               V::fma( middle[0], sum_vector[k], V::sub( zero, V::mul( sum[0], middle_vector[k] ) ) ), middle_sum[k]
+            );
+         }
+         F sum_norm = V::mul( sum[0], sum[0] );
+         for (int k = 1; k < 4; ++k) sum_norm = V::fma( sum[k], sum[k], sum_norm );
+         sum_norm = V::sqrt( sum_norm );
+         const F real = V::fma( middle[0], sum[0], dot3<V>( middle_vector, sum_vector ) );
+         const F sine = V::div( V::sqrt( dot3<V>( difference, difference ) ), sum_norm );
+         const F cosine = V::div( abs<V>( real ), sum_norm );
+         results[2] = V::mul( V::set( 2.0f ), getAngle<V>( sine, cosine ) );
+      } );
+   }
+
+   template<typename V>
+   void propagateJoints(const JointArrays& joints, size_t begin, size_t end)
+   {
+      using F = typename V::Float;
+      using I = typename V::Int;
+      const auto propagate = [&joints](I parents, const F* local, const F* translation, F* world, F* position) {
+         const F parent[4] = {
+            V::gather( joints.WorldRotations.W, parents ), V::gather( joints.WorldRotations.X, parents ),
+            V::gather( joints.WorldRotations.Y, parents ), V::gather( joints.WorldRotations.Z, parents )
+         };
+         world[0] = V::sub(
+            V::mul( parent[0], local[0] ),
+            V::fma( parent[1], local[1], V::fma( parent[2], local[2], V::mul( parent[3], local[3] ) ) )
+         );
+         world[1] = V::add(
+            V::fma( parent[0], local[1], V::mul( parent[1], local[0] ) ),
+            V::sub( V::mul( parent[2], local[3] ), V::mul( parent[3], local[2] ) )
+         );
+         world[2] = V::add(
+            V::fma( parent[0], local[2], V::mul( parent[2], local[0] ) ),
+            V::sub( V::mul( parent[3], local[1] ), V::mul( parent[1], local[3] ) )
+         );
+         world[3] = V::add(
+            V::fma( parent[0], local[3], V::mul( parent[3], local[0] ) ),
+            V::sub( V::mul( parent[1], local[2] ), V::mul( parent[2], local[1] ) )
+         );
+
+         // v' = v + 2 u x (u x v + w v) for the unit quaternion (w, u).
+         const F axis[3] = { parent[1], parent[2], parent[3] };
+         F u_v[3], u_u_v[3];
+         cross<V>( axis, translation, u_v );
+         for (int k = 0; k < 3; ++k) u_v[k] = V::fma( parent[0], translation[k], u_v[k] );
+         cross<V>( axis, u_v, u_u_v );
+         const F two = V::set( 2.0f );
+         for (int k = 0; k < 3; ++k) {
+            const F parent_position = V::gather( joints.WorldPositions[k], parents );
+            position[k] = V::add( parent_position, V::fma( two, u_u_v[k], translation[k] ) );
+         }
+      };
+
+      const float* const local_rotations[4] = {
+         joints.LocalRotations.W, joints.LocalRotations.X, joints.LocalRotations.Y, joints.LocalRotations.Z
+      };
+      float* const world_rotations[4] = {
+         joints.WorldRotations.W, joints.WorldRotations.X, joints.WorldRotations.Y, joints.WorldRotations.Z
+      };
+      F local[4], translation[3], world[4], position[3];
+      size_t i = begin;
+      for (; i + V::Width <= end; i += V::Width) {
+         for (int k = 0; k < 4; ++k) local[k] = V::load( local_rotations[k] + i );
+         for (int k = 0; k < 3; ++k) translation[k] = V::load( joints.LocalTranslations[k] + i );
+         propagate( V::loadInt( joints.Parents + i ), local, translation, world, position );
+         for (int k = 0; k < 4; ++k) V::store( world_rotations[k] + i, world[k] );
+         for (int k = 0; k < 3; ++k) V::store( joints.WorldPositions[k] + i, position[k] );
+      }
+      if (i == end) return;
+
+      // The padding lanes gather from the parent of the first remaining joint, which is a valid index.
+      const size_t rest = end - i;
+      int tail_parents[V::Width];
+      float tail_local[4][V::Width] = {}, tail_translation[3][V::Width] = {}, tail[V::Width];
+      for (size_t j = 0; j < V::Width; ++j) tail_parents[j] = joints.Parents[i + (j < rest ? j : 0)];
+      for (size_t j = 0; j < rest; ++j) {
+         for (int k = 0; k < 4; ++k) tail_local[k][j] = local_rotations[k][i + j];
+         for (int k = 0; k < 3; ++k) tail_translation[k][j] = joints.LocalTranslations[k][i + j];
+      }
+      for (int k = 0; k < 4; ++k) local[k] = V::load( tail_local[k] );
+      for (int k = 0; k < 3; ++k) translation[k] = V::load( tail_translation[k] );
+      propagate( V::loadInt( tail_parents ), local, translation, world, position );
+      for (int k = 0; k < 4; ++k) {
+         V::store( tail, world[k] );
+         for (size_t j = 0; j < rest; ++j) world_rotations[k][i + j] = tail[j];
+      }
+      for (int k = 0; k < 3; ++k) {
+         V::store( tail, position[k] );
+         for (size_t j = 0; j < rest; ++j) joints.WorldPositions[k][i + j] = tail[j];
+      }
+   }
+
+   template<typename V>
+   void getPointBounds(const float* points, size_t stride, size_t count, const float* center, PointBounds& bounds)
+   {
+      using F = typename V::Float;
+      using I = typename V::Int;
+      if (count == 0) {
+         for (int k = 0; k < 3; ++k) bounds.Min[k] = bounds.Max[k] = 0.0f;
+         bounds.MaxSquaredDistance = 0.0f;
+         return;
+      }
+
+      int lane_offsets[V::Width];
+      for (size_t j = 0; j < V::Width; ++j) lane_offsets[j] = static_cast<int>(j * stride);
+      const I offsets = V::loadInt( lane_offsets );
+      F lower[3], upper[3], p[3], c[3];
+      for (int k = 0; k < 3; ++k) {
+         lower[k] = upper[k] = V::set( points[k] );
+         c[k] = V::set( center != nullptr ? center[k] : 0.0f );
+      }
+      F farthest = V::set( 0.0f );
+      const auto accumulate = [&]() {
+         F squared_distance = V::set( 0.0f );
+         for (int k = 0; k < 3; ++k) {
+            lower[k] = V::min( lower[k], p[k] );
+            upper[k] = V::max( upper[k], p[k] );
+            const F d = V::sub( p[k], c[k] );
+            squared_distance = V::fma( d, d, squared_distance );
+         }
+         farthest = V::max( farthest, squared_distance );
+      };
+
+      size_t i = 0;
+      for (; i + V::Width <= count; i += V::Width) {
+         const float* block = points + i * stride;
+         for (int k = 0; k < 3; ++k) p[k] = V::gather( block + k, offsets );
+         accumulate();
+      }
+      if (i < count) {
+         // The padding lanes repeat the first remaining point, which leaves the reductions unchanged.
+         const size_t rest = count - i;
+         for (size_t j = 0; j < V::Width; ++j) lane_offsets[j] = static_cast<int>((j < rest ? j : 0) * stride);
+         const float* block = points + i * stride;
+         const I tail_offsets = V::loadInt( lane_offsets );
+         for (int k = 0; k < 3; ++k) p[k] = V::gather( block + k, tail_offsets );
+         accumulate();
+      }
+
+      float lanes[V::Width];
+      for (int k = 0; k < 3; ++k) {
+         V::store( lanes, lower[k] );
+         bounds.Min[k] = *std::min_element( lanes, lanes + V::Width );
+         V::store( lanes, upper[k] );
+         bounds.Max[k] = *std::max_element( lanes, lanes + V::Width );
+      }
+      V::store( lanes, farthest );
+      bounds.MaxSquaredDistance = center != nullptr ? *std::max_element( lanes, lanes + V::Width ) : 0.0f;
+   }
+
+   template<typename V>
+   void cullBoundingVolumes(
+      const BoundingVolumeArrays& volumes,
+      const float* planes,
+      int frustum_num,
+      size_t count,
+      unsigned int* visible,
+      unsigned int* contained
+   )
+   {
+      using F = typename V::Float;
+      using I = typename V::Int;
+      const auto test = [planes, frustum_num](const F* center, const F* extent, F radius, I& outside, I& crossing) {
+         outside = crossing = V::setInt( 0 );
+         for (int f = 0; f < frustum_num; ++f) {
+            F nearest = V::set( std::numeric_limits<float>::max() );
+            F farthest = nearest;
+            for (int p = 0; p < 6; ++p) {
+               const float* plane = planes + (f * 6 + p) * 4;
+               const F distance = V::fma(
+                  V::set( plane[0] ), center[0],
+                  V::fma( V::set( plane[1] ), center[1], V::fma( V::set( plane[2] ), center[2], V::set( plane[3] ) ) )
+               );
+               const F box_reach = V::fma(
+                  V::set( std::abs( plane[0] ) ), extent[0],
+                  V::fma(
+                     V::set( std::abs( plane[1] ) ), extent[1],
+                     V::mul( V::set( std::abs( plane[2] ) ), extent[2] )
+                  )
+               );
+               const F reach = V::min( radius, box_reach );
+               nearest = V::min( nearest, V::add( distance, reach ) );
+               farthest = V::min( farthest, V::sub( distance, reach ) );
+            }
+            // A negative minimum sets the sign bit, which is spread into a mask of the lanes failing a plane.
+            const I bit = V::setInt( static_cast<int>(1u << f) );
+            const I nearest_mask = V::template shiftRightArithmetic<31>( V::castToInt( nearest ) );
+            const I farthest_mask = V::template shiftRightArithmetic<31>( V::castToInt( farthest ) );
+            outside = V::orInt( outside, V::andInt( nearest_mask, bit ) );
+            crossing = V::orInt( crossing, V::andInt( farthest_mask, bit ) );
+         }
+      };
+
+      const I all = V::setInt( static_cast<int>(frustum_num == 32 ? ~0u : (1u << frustum_num) - 1u) );
+      F center[3], extent[3];
+      I outside, crossing;
+      size_t i = 0;
+      for (; i + V::Width <= count; i += V::Width) {
+         for (int k = 0; k < 3; ++k) {
+            center[k] = V::load( volumes.Centers[k] + i );
+            extent[k] = V::load( volumes.Extents[k] + i );
+         }
+         test( center, extent, V::load( volumes.Radii + i ), outside, crossing );
+         V::storeInt( reinterpret_cast<int*>(visible + i), V::andNotInt( outside, all ) );
+         if (contained != nullptr) V::storeInt( reinterpret_cast<int*>(contained + i), V::andNotInt( crossing, all ) );
+      }
+      if (i == count) return;
+
+      const size_t rest = count - i;
+      float tail_center[3][V::Width], tail_extent[3][V::Width], tail_radius[V::Width];
+      for (size_t j = 0; j < V::Width; ++j) {
+         const size_t index = i + (j < rest ? j : 0);
+         for (int k = 0; k < 3; ++k) {
+            tail_center[k][j] = volumes.Centers[k][index];
+            tail_extent[k][j] = volumes.Extents[k][index];
+         }
+         tail_radius[j] = volumes.Radii[index];
+      }
+      for (int k = 0; k < 3; ++k) {
+         center[k] = V::load( tail_center[k] );
+         extent[k] = V::load( tail_extent[k] );
+      }
+      test( center, extent, V::load( tail_radius ), outside, crossing );
+      int tail_visible[V::Width], tail_contained[V::Width];
+      V::storeInt( tail_visible, V::andNotInt( outside, all ) );
+      V::storeInt( tail_contained, V::andNotInt( crossing, all ) );
+      for (size_t j = 0; j < rest; ++j) {
+         visible[i + j] = static_cast<unsigned int>(tail_visible[j]);
+         if (contained != nullptr) contained[i + j] = static_cast<unsigned int>(tail_contained[j]);
+      }
+   }
+}
\ No newline at end of file
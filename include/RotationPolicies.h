@@ -0,0 +1,251 @@
+#pragma once
+
+#include "_Common.h"
+#include "QuaternionSlerp.h"
+
+// Rotation representations as compile-time policies, so that code templated on a policy handles any of them.
+// A policy is a stateless struct with
+//   Value                            the stored form of a rotation
+//   getName()                        for reports
+//   identity()
+//   fromMatrix( m ), toMatrix( r )   conversions from and to a rotation matrix
+//   compose( a, b )                  b followed by a, i.e. toMatrix( a ) * toMatrix( b )
+//   interpolate( a, b, t )           the interpolation that comes natural to the representation
+//   normalize( r )                   the canonical form of r, e.g. a unit quaternion or angles in [-pi, pi)
+// Only the quaternion interpolates along the shortest path; how far the others stray from it is the point of
+// comparing them.
+
+enum class EulerOrder { XYZ = 0, XZY, YXZ, YZX, ZXY, ZYX, XYX, XZX, YXY, YZY, ZXZ, ZYZ };
+
+namespace RotationPolicy
+{
+   [[nodiscard]] inline float wrapAngle(float angle)
+   {
+      return angle - glm::two_pi<float>() * std::floor( (angle + glm::pi<float>()) / glm::two_pi<float>() );
+   }
+}
+
+// The angles are in the order of the product, e.g. toMatrix( r ) is R_y( r.x ) R_x( r.y ) R_z( r.z ) for YXZ.
+// Tait-Bryan orders name three different axes, proper Euler orders repeat the first one.
+template<EulerOrder Order>
+struct EulerAngleRotation
+{
+   using Value = glm::vec3;
+
+   [[nodiscard]] static const char* getName()
+   {
+      constexpr const char* names[] = {
+         "Euler XYZ", "Euler XZY", "Euler YXZ", "Euler YZX", "Euler ZXY", "Euler ZYX",
+         "Euler XYX", "Euler XZX", "Euler YXY", "Euler YZY", "Euler ZXZ", "Euler ZYZ"
+      };
+      return names[static_cast<int>(Order)];
+   }
+
+   [[nodiscard]] static Value identity() { return Value(0.0f); }
+
+   [[nodiscard]] static glm::mat3 toMatrix(const Value& r)
+   {
+      switch (Order) {
+         case EulerOrder::XYZ: return glm::mat3(glm::eulerAngleXYZ( r.x, r.y, r.z ));
+         case EulerOrder::XZY: return glm::mat3(glm::eulerAngleXZY( r.x, r.y, r.z ));
+         case EulerOrder::YXZ: return glm::mat3(glm::eulerAngleYXZ( r.x, r.y, r.z ));
+         case EulerOrder::YZX: return glm::mat3(glm::eulerAngleYZX( r.x, r.y, r.z ));
+         case EulerOrder::ZXY: return glm::mat3(glm::eulerAngleZXY( r.x, r.y, r.z ));
+         case EulerOrder::ZYX: return glm::mat3(glm::eulerAngleZYX( r.x, r.y, r.z ));
+         case EulerOrder::XYX: return glm::mat3(glm::eulerAngleXYX( r.x, r.y, r.z ));
+         case EulerOrder::XZX: return glm::mat3(glm::eulerAngleXZX( r.x, r.y, r.z ));
+         case EulerOrder::YXY: return glm::mat3(glm::eulerAngleYXY( r.x, r.y, r.z ));
+         case EulerOrder::YZY: return glm::mat3(glm::eulerAngleYZY( r.x, r.y, r.z ));
+         case EulerOrder::ZXZ: return glm::mat3(glm::eulerAngleZXZ( r.x, r.y, r.z ));
+         case EulerOrder::ZYZ: return glm::mat3(glm::eulerAngleZYZ( r.x, r.y, r.z ));
+      }
+      return glm::mat3(1.0f);
+   }
+
+   [[nodiscard]] static Value fromMatrix(const glm::mat3& m)
+   {
+      const glm::mat4 rotation(m);
+      Value r(0.0f);
+      switch (Order) {
+         case EulerOrder::XYZ: glm::extractEulerAngleXYZ( rotation, r.x, r.y, r.z ); break;
+         case EulerOrder::XZY: glm::extractEulerAngleXZY( rotation, r.x, r.y, r.z ); break;
+         case EulerOrder::YXZ: glm::extractEulerAngleYXZ( rotation, r.x, r.y, r.z ); break;
+         case EulerOrder::YZX: glm::extractEulerAngleYZX( rotation, r.x, r.y, r.z ); break;
+         case EulerOrder::ZXY: glm::extractEulerAngleZXY( rotation, r.x, r.y, r.z ); break;
+         case EulerOrder::ZYX: glm::extractEulerAngleZYX( rotation, r.x, r.y, r.z ); break;
+         case EulerOrder::XYX: glm::extractEulerAngleXYX( rotation, r.x, r.y, r.z ); break;
+         case EulerOrder::XZX: glm::extractEulerAngleXZX( rotation, r.x, r.y, r.z ); break;
+         case EulerOrder::YXY: glm::extractEulerAngleYXY( rotation, r.x, r.y, r.z ); break;
+         case EulerOrder::YZY: glm::extractEulerAngleYZY( rotation, r.x, r.y, r.z ); break;
+         case EulerOrder::ZXZ: glm::extractEulerAngleZXZ( rotation, r.x, r.y, r.z ); break;
+         case EulerOrder::ZYZ: glm::extractEulerAngleZYZ( rotation, r.x, r.y, r.z ); break;
+      }
+      return r;
+   }
+
+   // Angles do not compose, so the product goes through matrices.
+   [[nodiscard]] static Value compose(const Value& a, const Value& b)
+   {
+      return fromMatrix( toMatrix( a ) * toMatrix( b ) );
+   }
+   [[nodiscard]] static Value interpolate(const Value& a, const Value& b, float t) { return a + t * (b - a); }
+
+   [[nodiscard]] static Value normalize(const Value& r)
+   {
+      return { RotationPolicy::wrapAngle( r.x ), RotationPolicy::wrapAngle( r.y ), RotationPolicy::wrapAngle( r.z ) };
+   }
+};
+
+// The Euler angles of the left view: pitch, roll and yaw as glm::orientate3 takes them,
+// R_y( yaw ) R_x( pitch ) R_z( roll ).
+struct OrientateRotation
+{
+   using Value = glm::vec3;
+
+   [[nodiscard]] static const char* getName() { return "orientate3"; }
+   [[nodiscard]] static Value identity() { return Value(0.0f); }
+   [[nodiscard]] static glm::mat3 toMatrix(const Value& r) { return orientate3( r ); }
+
+   [[nodiscard]] static Value fromMatrix(const glm::mat3& m)
+   {
+      const glm::vec3 yaw_pitch_roll = EulerAngleRotation<EulerOrder::YXZ>::fromMatrix( m );
+      return { yaw_pitch_roll.y, yaw_pitch_roll.z, yaw_pitch_roll.x };
+   }
+
+   [[nodiscard]] static Value compose(const Value& a, const Value& b)
+   {
+      return fromMatrix( toMatrix( a ) * toMatrix( b ) );
+   }
+   [[nodiscard]] static Value interpolate(const Value& a, const Value& b, float t) { return a + t * (b - a); }
+   [[nodiscard]] static Value normalize(const Value& r) { return EulerAngleRotation<EulerOrder::YXZ>::normalize( r ); }
+};
+
+struct QuaternionRotation
+{
+   using Value = glm::quat;
+
+   [[nodiscard]] static const char* getName() { return "quaternion"; }
+   [[nodiscard]] static Value identity() { return { 1.0f, 0.0f, 0.0f, 0.0f }; }
+   [[nodiscard]] static glm::mat3 toMatrix(const Value& r) { return mat3_cast( r ); }
+   [[nodiscard]] static Value fromMatrix(const glm::mat3& m) { return quat_cast( m ); }
+   [[nodiscard]] static Value compose(const Value& a, const Value& b) { return a * b; }
+   // Whichever slerp QuaternionSlerp has selected.
+   [[nodiscard]] static Value interpolate(const Value& a, const Value& b, float t)
+   {
+      return QuaternionSlerp::interpolate( a, b, t );
+   }
+   [[nodiscard]] static Value normalize(const Value& r) { return glm::normalize( r ); }
+};
+
+struct AxisAngle
+{
+   glm::vec3 Axis;
+   float Angle;
+};
+
+struct AxisAngleRotation
+{
+   using Value = AxisAngle;
+
+   [[nodiscard]] static const char* getName() { return "axis-angle"; }
+   [[nodiscard]] static Value identity() { return { glm::vec3(1.0f, 0.0f, 0.0f), 0.0f }; }
+   [[nodiscard]] static glm::mat3 toMatrix(const Value& r) { return mat3_cast( toQuaternion( r ) ); }
+   [[nodiscard]] static Value fromMatrix(const glm::mat3& m) { return fromQuaternion( quat_cast( m ) ); }
+
+   [[nodiscard]] static Value compose(const Value& a, const Value& b)
+   {
+      return fromQuaternion( toQuaternion( a ) * toQuaternion( b ) );
+   }
+
+   // Axes and angles separately; opposite axes would pass through zero, so the first axis is kept there.
+   [[nodiscard]] static Value interpolate(const Value& a, const Value& b, float t)
+   {
+      const glm::vec3 axis = a.Axis + t * (b.Axis - a.Axis);
+      const float axis_length = length( axis );
+      return { axis_length > 1e-6f ? axis / axis_length : a.Axis, a.Angle + t * (b.Angle - a.Angle) };
+   }
+
+   // A unit axis and an angle in [0, pi].
+   [[nodiscard]] static Value normalize(const Value& r)
+   {
+      const float axis_length = length( r.Axis );
+      const glm::vec3 axis = axis_length > 1e-6f ? r.Axis / axis_length : glm::vec3(1.0f, 0.0f, 0.0f);
+      const float angle = RotationPolicy::wrapAngle( r.Angle );
+      return angle < 0.0f ? Value{ -axis, -angle } : Value{ axis, angle };
+   }
+
+   [[nodiscard]] static glm::quat toQuaternion(const Value& r) { return angleAxis( r.Angle, r.Axis ); }
+
+   [[nodiscard]] static Value fromQuaternion(const glm::quat& q)
+   {
+      const glm::quat shorter = q.w < 0.0f ? -q : q;
+      const glm::vec3 vector(shorter.x, shorter.y, shorter.z);
+      const float sine = length( vector );
+      if (sine < 1e-7f) return identity();
+      return { vector / sine, 2.0f * std::atan2( sine, shorter.w ) };
+   }
+};
+
+struct RotationMatrixRotation
+{
+   using Value = glm::mat3;
+
+   [[nodiscard]] static const char* getName() { return "matrix"; }
+   [[nodiscard]] static Value identity() { return Value(1.0f); }
+   [[nodiscard]] static glm::mat3 toMatrix(const Value& r) { return r; }
+   [[nodiscard]] static Value fromMatrix(const glm::mat3& m) { return m; }
+   [[nodiscard]] static Value compose(const Value& a, const Value& b) { return a * b; }
+   // Elementwise, then orthonormalized; the plain lerp would shrink and shear the basis.
+   [[nodiscard]] static Value interpolate(const Value& a, const Value& b, float t)
+   {
+      return normalize( a + t * (b - a) );
+   }
+
+   // Gram-Schmidt on the columns, keeping the direction of the first one.
+   [[nodiscard]] static Value normalize(const Value& r)
+   {
+      const glm::vec3 x = glm::normalize( r[0] );
+      const glm::vec3 y = glm::normalize( r[1] - dot( r[1], x ) * x );
+      return { x, y, cross( x, y ) };
+   }
+};
+
+// The rotation vector, axis times angle: the logarithm of the unit quaternion, doubled.
+struct ExponentialMapRotation
+{
+   using Value = glm::vec3;
+
+   [[nodiscard]] static const char* getName() { return "exponential map"; }
+   [[nodiscard]] static Value identity() { return Value(0.0f); }
+   [[nodiscard]] static glm::mat3 toMatrix(const Value& r) { return mat3_cast( toQuaternion( r ) ); }
+   [[nodiscard]] static Value fromMatrix(const glm::mat3& m) { return fromQuaternion( quat_cast( m ) ); }
+
+   [[nodiscard]] static Value compose(const Value& a, const Value& b)
+   {
+      return fromQuaternion( toQuaternion( a ) * toQuaternion( b ) );
+   }
+
+   // Exact for rotations about a common axis, and the closer to slerp the closer both are to the identity.
+   [[nodiscard]] static Value interpolate(const Value& a, const Value& b, float t) { return a + t * (b - a); }
+
+   // An angle of at most pi; longer vectors are the same rotation as a shorter one in the opposite direction.
+   [[nodiscard]] static Value normalize(const Value& r)
+   {
+      const float angle = length( r );
+      if (angle <= glm::pi<float>()) return r;
+      return r * (RotationPolicy::wrapAngle( angle ) / angle);
+   }
+
+   [[nodiscard]] static glm::quat toQuaternion(const Value& r)
+   {
+      const float angle = length( r );
+      if (angle < 1e-7f) return { 1.0f, 0.5f * r.x, 0.5f * r.y, 0.5f * r.z };
+      return angleAxis( angle, r / angle );
+   }
+
+   [[nodiscard]] static Value fromQuaternion(const glm::quat& q)
+   {
+      const AxisAngle axis_angle = AxisAngleRotation::fromQuaternion( q );
+      return axis_angle.Axis * axis_angle.Angle;
+   }
+};
\ No newline at end of file
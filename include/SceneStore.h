@@ -0,0 +1,84 @@
+#pragma once
+
+#include "_Common.h"
+#include "RotationKernels.h"
+#include "RotationPolicies.h"
+#include "FrustumCuller.h"
+#include "TaskScheduler.h"
+
+// Entities are indices into structure-of-arrays components: orientation as Euler angles and as a quaternion, position
+// and scale, mesh and color, and the two keys each entity swings between. The systems below walk the arrays front to
+// back in ranges shared among the threads of a scheduler, and hand whole ranges to the SIMD kernels of RotationKernels.
+class SceneStore
+{
+public:
+   enum class RotationForm { Quaternion = 0, EulerAngle };
+
+   // Entities below this many per range are not worth waking other threads for.
+   inline static constexpr size_t GrainSize = 4096;
+
+   struct Entity
+   {
+      int Mesh; // handle returned by addMesh
+      glm::vec3 Position;
+      float Scale;
+      glm::vec4 Color;
+      // Euler angles follow glm::orientate3. The entity swings from one key to the other and back within Period
+      // seconds, starting Phase of a period in; the Euler angles are lerped and the quaternions slerped.
+      glm::vec3 FromEulerAngle;
+      glm::vec3 ToEulerAngle;
+      float Period;
+      float Phase;
+   };
+
+   SceneStore() : BoundsChanged( false ) {}
+
+   // Returns the handle of a mesh with the given object space bounds.
+   int addMesh(const BoundingVolume& bounds);
+   [[nodiscard]] int getMeshNum() const { return static_cast<int>(MeshBounds.size()); }
+   // Entities added in spatial order, nearby ones one after another, are culled the fastest.
+   size_t addEntity(const Entity& entity);
+   void clear();
+   [[nodiscard]] size_t getEntityNum() const { return Meshes.size(); }
+   [[nodiscard]] glm::vec3 getEulerAngle(size_t entity) const;
+   [[nodiscard]] glm::quat getRotation(size_t entity, RotationForm form) const;
+
+   // Animation system: both orientations at time in seconds.
+   void animate(double time, TaskScheduler* scheduler = nullptr);
+   // Transform system: the quaternions of the Euler angles, so both orientations are drawn the same way.
+   void buildTransforms(TaskScheduler* scheduler = nullptr);
+   // Culling system: the bounds hold the mesh in any orientation, so they are only rebuilt when entities are added.
+   void setFrustum(int frustum, const std::array<glm::vec4, 6>& planes);
+   void cull(TaskScheduler* scheduler = nullptr);
+   [[nodiscard]] size_t getCulledNum(int frustum) const { return Culler.getCulledNum( frustum ); }
+   // Instance data of the entities visible in the frustum, one vector per mesh with three vec4 per entity: the rotation
+   // as x, y, z, w, the position with the scale, and the color.
+   void getInstances(RotationForm form, int frustum, std::vector<std::vector<glm::vec4>>& instances) const;
+
+private:
+   bool BoundsChanged;
+   std::vector<BoundingVolume> MeshBounds;
+   std::vector<int> Meshes;
+   std::array<std::vector<float>, 3> Positions;
+   std::vector<float> Scales;
+   std::vector<glm::vec4> Colors;
+   std::array<std::vector<float>, 3> FromEulerAngles;
+   std::array<std::vector<float>, 3> ToEulerAngles;
+   // w, x, y, z
+   std::array<std::vector<float>, 4> FromRotations;
+   std::array<std::vector<float>, 4> ToRotations;
+   std::vector<float> Frequencies;
+   std::vector<float> Phases;
+   std::vector<float> Weights;
+   std::array<std::vector<float>, 3> EulerAngles;
+   std::array<std::vector<float>, 4> Rotations;
+   std::array<std::vector<float>, 4> EulerAngleRotations;
+   FrustumCuller Culler;
+
+   [[nodiscard]] static QuaternionArrays getArrays(std::array<std::vector<float>, 4>& quaternions, size_t offset);
+   [[nodiscard]] static ConstQuaternionArrays getConstArrays(
+      const std::array<std::vector<float>, 4>& quaternions,
+      size_t offset
+   );
+   void animateRange(double time, size_t begin, size_t end);
+};
\ No newline at end of file
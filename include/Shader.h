@@ -2,31 +2,174 @@
 
 #include "_Common.h"
 #include "Camera.h"
+#include "CpuProfiler.h"
+#include "ShaderPreprocessor.h"
 
 class ShaderGL
 {
 public:
-   struct LocationSet
+   struct UniformInfo
    {
-      GLint World, View, Projection, ModelViewProjection, Color;
+      std::string Name;
+      uint64_t Hash;
+      GLint Location;
+      GLenum Type;
+      GLint ArraySize;
+      GLint BlockIndex;
+      uint ValueOffset;
+      uint ValueSize;
+      bool Uploaded;
+   };
 
-      LocationSet() : World( 0 ), View( 0 ), Projection( 0 ), ModelViewProjection( 0 ), Color( 0 ) {}
+   struct UniformBlockInfo
+   {
+      std::string Name;
+      uint64_t Hash;
+      GLint Binding;
+      GLint DataSize;
+      GLint ActiveUniformNum;
    };
 
    ShaderGL();
    virtual ~ShaderGL();
 
-   void setShader(const char* vertex_shader_path, const char* fragment_shader_path);
+   void setShader(
+      const char* vertex_shader_path,
+      const char* fragment_shader_path,
+      const std::vector<std::string>& defines = {}
+   );
+   void beginShader(
+      const char* vertex_shader_path,
+      const char* fragment_shader_path,
+      const std::vector<std::string>& defines = {}
+   );
+   [[nodiscard]] bool updatePendingProgram() { return finishPendingProgram( false ); }
+   void waitForPendingProgram() { finishPendingProgram( true ); }
+   [[nodiscard]] bool usesShaderFile(const std::string& file_path) const;
+   void reload();
    void setBasicTransformationUniforms();
-   void transferBasicTransformationUniforms(const glm::mat4& to_world, const CameraGL* camera, const glm::vec4& color) const;
+   // The view and projection uniforms are only compared and uploaded when camera_version differs from the last one.
+   void transferBasicTransformationUniforms(
+      const glm::mat4& to_world,
+      const glm::mat4& view,
+      const glm::mat4& projection,
+      const glm::mat4& view_projection,
+      uint64_t camera_version,
+      const glm::vec4& color
+   );
+   [[nodiscard]] int findUniform(const char* name) const;
+   [[nodiscard]] const UniformInfo* getUniformInfo(const char* name) const;
+   [[nodiscard]] const UniformBlockInfo* getUniformBlockInfo(const char* name) const;
+   [[nodiscard]] const std::vector<UniformInfo>& getUniforms() const { return Uniforms; }
+   [[nodiscard]] const std::vector<UniformBlockInfo>& getUniformBlocks() const { return UniformBlocks; }
+   template<typename T>
+   bool setUniform(int uniform, const T& value) { return setUniformArray( uniform, &value, 1 ); }
+   template<typename T>
+   bool setUniform(const char* name, const T& value) { return setUniformArray( findUniform( name ), &value, 1 ); }
+   template<typename T>
+   bool setUniformArray(int uniform, const T* values, int count);
+   [[nodiscard]] uint64_t getUniformUploadNum() const { return UniformUploadNum; }
+   [[nodiscard]] uint64_t getSkippedUniformUploadNum() const { return SkippedUniformUploadNum; }
    [[nodiscard]] GLuint getShaderProgram() const { return ShaderProgram; }
+   [[nodiscard]] const std::vector<std::string>& getShaderFiles() const { return ShaderFiles; }
+   static void setProgramCacheDirectory(const std::string& directory_path) { ProgramCacheDirectory = directory_path; }
+   static void initializeCompilerCapabilities();
 
 protected:
+   struct ProgramBinaryHeader
+   {
+      uint Magic;
+      GLenum Format;
+      uint Length;
+      double BuildTime;
+   };
+
+   inline static constexpr uint ProgramBinaryMagic = 0x42504c47u;
+   // Empty until set or first used, since the default one is looked up in the environment.
+   inline static std::string ProgramCacheDirectory;
+   inline static bool ParallelCompileSupported = false;
+   inline static bool SpirVSupported = false;
+
+   struct BasicUniformSet
+   {
+      int World, View, Projection, ModelViewProjection, Normal, Color;
+
+      BasicUniformSet() :
+         World( -1 ), View( -1 ), Projection( -1 ), ModelViewProjection( -1 ), Normal( -1 ), Color( -1 ) {}
+   };
+
    GLuint ShaderProgram;
-   LocationSet Location;
+   bool IsSpirVProgram;
+   BasicUniformSet Basic;
+   std::vector<UniformInfo> Uniforms;
+   std::vector<UniformBlockInfo> UniformBlocks;
+   // Open-addressing tables of (index + 1) into Uniforms and UniformBlocks; 0 marks an empty slot.
+   std::vector<int> UniformTable;
+   std::vector<int> UniformBlockTable;
+   std::vector<uchar> UniformValues;
+   uint64_t UniformUploadNum;
+   uint64_t SkippedUniformUploadNum;
+   uint64_t CameraVersion;
+   std::string VertexShaderPath;
+   std::string FragmentShaderPath;
+   std::vector<std::string> Defines;
+   std::vector<std::string> ShaderFiles;
+   GLuint PendingProgram;
+   GLuint PendingVertexShader;
+   GLuint PendingFragmentShader;
+   uint64_t PendingKey;
+   std::chrono::steady_clock::time_point PendingStartTime;
 
-   static void readShaderFile(std::string& shader_contents, const char* shader_path);
+   [[nodiscard]] static const std::string& getProgramCacheDirectory();
    [[nodiscard]] static std::string getShaderTypeString(GLenum shader_type);
    [[nodiscard]] static bool checkCompileError(GLenum shader_type, const GLuint& shader);
-   [[nodiscard]] static GLuint getCompiledShader(GLenum shader_type, const char* shader_path);
-};
\ No newline at end of file
+   [[nodiscard]] static bool checkLinkError(const GLuint& program);
+   [[nodiscard]] static GLuint getCompilingShader(GLenum shader_type, const std::string& shader_contents);
+   [[nodiscard]] static GLuint getSpecializedShader(GLenum shader_type, const EmbeddedShaderFile& spirv);
+   [[nodiscard]] static uint64_t getNameHash(const char* name);
+   [[nodiscard]] static uint getUniformTypeSize(GLenum type);
+   template<typename T>
+   [[nodiscard]] static int findInTable(const std::vector<int>& table, const std::vector<T>& entries, const char* name);
+   template<typename T>
+   static void buildTable(std::vector<int>& table, const std::vector<T>& entries);
+   int addUniform(const std::string& name, GLint location, GLenum type, GLint array_size, GLint block_index);
+   void reflectUniforms();
+   void uploadUniform(GLint location, const GLint* values, int count) const;
+   void uploadUniform(GLint location, const GLuint* values, int count) const;
+   void uploadUniform(GLint location, const float* values, int count) const;
+   void uploadUniform(GLint location, const glm::vec2* values, int count) const;
+   void uploadUniform(GLint location, const glm::vec3* values, int count) const;
+   void uploadUniform(GLint location, const glm::vec4* values, int count) const;
+   void uploadUniform(GLint location, const glm::ivec2* values, int count) const;
+   void uploadUniform(GLint location, const glm::ivec3* values, int count) const;
+   void uploadUniform(GLint location, const glm::ivec4* values, int count) const;
+   void uploadUniform(GLint location, const glm::mat3* values, int count) const;
+   void uploadUniform(GLint location, const glm::mat4* values, int count) const;
+   [[nodiscard]] static uint64_t getProgramKey(const std::vector<const std::string*>& sources, const std::string& defines);
+   [[nodiscard]] static std::string getProgramCachePath(uint64_t key);
+   [[nodiscard]] bool loadProgramBinary(uint64_t key);
+   void saveProgramBinary(uint64_t key, double build_time_in_ms) const;
+   void installProgram(GLuint program);
+   bool finishPendingProgram(bool wait);
+};
+
+template<typename T>
+bool ShaderGL::setUniformArray(int uniform, const T* values, int count)
+{
+   if (uniform < 0 || uniform >= static_cast<int>(Uniforms.size())) return false;
+
+   UniformInfo& info = Uniforms[uniform];
+   const auto size = static_cast<uint>(sizeof( T ) * count);
+   if (info.Location < 0 || size > info.ValueSize) return false;
+
+   uchar* cached = UniformValues.data() + info.ValueOffset;
+   if (info.Uploaded && std::memcmp( cached, values, size ) == 0) {
+      ++SkippedUniformUploadNum;
+      return false;
+   }
+   std::memcpy( cached, values, size );
+   info.Uploaded = true;
+   uploadUniform( info.Location, values, count );
+   ++UniformUploadNum;
+   return true;
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "_Common.h"
+#include "CpuProfiler.h"
+#include "EmbeddedShaders.h"
+
+// Expands #include directives and injects #define lines right after #version. The expanded source is cached per
+// permutation, i.e. per file and sorted define set, so every variant is assembled only once. Files below the
+// shader directory are taken from the copies embedded at build time unless reading from disk is requested.
+class ShaderPreprocessor
+{
+public:
+   struct ExpandedSource
+   {
+      std::string Source;
+      std::vector<std::string> Dependencies;
+   };
+
+   [[nodiscard]] static std::string getPermutationKey(const std::string& file_path, const std::vector<std::string>& defines);
+   [[nodiscard]] static std::shared_ptr<const ExpandedSource> getExpandedSource(
+      const std::string& file_path,
+      const std::vector<std::string>& defines
+   );
+   [[nodiscard]] static const EmbeddedShaderFile* findEmbeddedSpirV(
+      const std::string& file_path,
+      const std::vector<std::string>& defines
+   );
+   static void setUseEmbeddedSources(bool use_embedded_sources) { UseEmbeddedSources = use_embedded_sources; }
+   static void invalidate();
+
+private:
+   inline static constexpr int MaxIncludeDepth = 16;
+   inline static bool UseEmbeddedSources = true;
+   inline static std::mutex CacheMutex;
+   inline static std::unordered_map<std::string, std::shared_ptr<const ExpandedSource>> PermutationCache;
+
+   [[nodiscard]] static std::string getEmbeddedName(const std::filesystem::path& file_path);
+   [[nodiscard]] static bool readFile(std::string& contents, const std::filesystem::path& file_path);
+   static bool expand(
+      ExpandedSource& expanded,
+      std::set<std::filesystem::path>& included_files,
+      const std::filesystem::path& file_path,
+      const std::string& define_lines,
+      int depth
+   );
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "_Common.h"
+#include "RotationKernels.h"
+#include "TaskScheduler.h"
+
+// Headless analysis selected with --sweep: samples pitch, roll and yaw of orientate3 on a regular grid over
+// [-pi, pi)^3, evaluates RotationKernels::getGimbalMetrics at every sample in parallel, and writes pitch/yaw heatmaps
+// of each metric together with summary statistics. No sample array is ever stored, so 1e9 samples need little memory.
+class SingularitySweep
+{
+public:
+   struct Settings
+   {
+      std::array<size_t, 3> SampleNum;
+      int HeatmapSize;
+      float InterpolationStep;
+      int ThreadNum;
+      std::string OutputDirectoryPath;
+
+      Settings() :
+         SampleNum{ 256, 256, 256 }, HeatmapSize( 512 ), InterpolationStep( glm::radians( 10.0f ) ), ThreadNum( 0 ),
+         OutputDirectoryPath( "sweep" ) {}
+   };
+
+   // Returns false if the heatmaps could not be written.
+   static bool run(const Settings& settings);
+
+private:
+   enum { ConditionNumber = 0, SingularityDistance, InterpolationDivergence, MetricNum };
+
+   inline static constexpr size_t BatchSize = 4096;
+   inline static constexpr size_t HistogramBinNum = 4096;
+   // Condition numbers are binned by their bits above those of 3, its minimum, which is logarithmic with 2^(23 -
+   // ConditionBinShift) bins per octave; the angles are binned linearly up to pi/2 and pi.
+   inline static constexpr int ConditionBinShift = 16;
+   inline static constexpr std::array<float, MetricNum> HistogramRanges = { 0.0f, 1.57079632679f, 3.14159265359f };
+
+   struct Statistics
+   {
+      uint64_t SampleNum;
+      uint64_t SingularSampleNum;
+      std::array<double, MetricNum> Sums;
+      std::array<float, MetricNum> Minima;
+      std::array<float, MetricNum> Maxima;
+      std::array<std::vector<uint64_t>, MetricNum> Histograms;
+
+      Statistics();
+      void add(const GimbalMetricArrays& metrics, size_t count);
+      void merge(const Statistics& other);
+   };
+
+   // One per thread, so that the rows need no synchronization but the heatmap cells they own.
+   struct Workspace
+   {
+      std::vector<float> Pitches;
+      std::vector<float> Yaws;
+      std::array<std::vector<float>, MetricNum> Metrics;
+      Statistics Summary;
+
+      Workspace() : Pitches( BatchSize ), Yaws( BatchSize ) { for (auto& metric : Metrics) metric.resize( BatchSize ); }
+   };
+
+   // A cell holds the worst case of the samples it covers over all rolls: the largest condition number, the smallest
+   // distance and the largest divergence. Rows are pitches from -pi at the bottom, columns yaws from -pi on the left.
+   struct Heatmaps
+   {
+      int Width;
+      int Height;
+      std::array<std::vector<float>, MetricNum> Cells;
+   };
+
+   [[nodiscard]] static float getAngle(size_t index, size_t sample_num);
+   [[nodiscard]] static size_t getHistogramBin(int metric, float value);
+   [[nodiscard]] static float getHistogramBinValue(int metric, size_t bin);
+   [[nodiscard]] static float getPercentile(const Statistics& statistics, int metric, double fraction);
+   static void sweepRow(
+      const Settings& settings,
+      const std::vector<float>& rolls,
+      int row,
+      Heatmaps& heatmaps,
+      Workspace& workspace
+   );
+   [[nodiscard]] static bool writeHeatmap(const std::string& file_path, const Heatmaps& heatmaps, int metric);
+   static void printStatistics(const Statistics& statistics);
+};
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "_Common.h"
+#include "CpuProfiler.h"
+
+// Fork-join parallel loops over a pool of threads with one deque of ranges each. A thread splits the range it took
+// in halves, keeps working on the lower one and pushes the upper one to the back of its deque; idle threads steal
+// from the front of another deque, where the largest pending ranges are, so the load balances itself even when the
+// iterations take very different times. Threads that find every deque empty sleep until a range is pushed or the loop
+// is done.
+class TaskScheduler
+{
+public:
+   // thread_num counts the calling thread as well; 0 uses every hardware thread.
+   explicit TaskScheduler(int thread_num = 0);
+   ~TaskScheduler();
+
+   TaskScheduler(const TaskScheduler&) = delete;
+   TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+   [[nodiscard]] int getThreadNum() const { return static_cast<int>(Workers.size()); }
+   // Calls function( range_begin, range_end, thread_index ) on disjoint subranges of [begin, end) that are at most
+   // grain_size long, and returns once all of them are done. The calling thread takes part with thread_index 0.
+   template<typename Function>
+   void parallelFor(size_t begin, size_t end, size_t grain_size, Function function);
+
+private:
+   struct Range
+   {
+      size_t Begin;
+      size_t End;
+   };
+
+   struct Worker
+   {
+      std::mutex Mutex;
+      std::deque<Range> Ranges;
+      std::thread Thread;
+   };
+
+   bool StopWorkers;
+   uint64_t JobIndex;
+   size_t GrainSize;
+   std::function<void(size_t, size_t, int)> Job;
+   std::atomic<size_t> RemainingNum;
+   std::atomic<size_t> PendingNum;
+   std::atomic<int> IdleNum;
+   std::vector<std::unique_ptr<Worker>> Workers;
+   std::mutex JobMutex;
+   std::condition_variable JobCondition;
+   std::mutex IdleMutex;
+   std::condition_variable IdleCondition;
+
+   void run(size_t begin, size_t end, size_t grain_size, std::function<void(size_t, size_t, int)> job);
+   [[nodiscard]] bool takeRange(int thread_index, Range& range);
+   void waitForRange();
+   void wakeIdleThreads(bool all);
+   void work(int thread_index);
+   void workLoop(int thread_index);
+};
+
+template<typename Function>
+void TaskScheduler::parallelFor(size_t begin, size_t end, size_t grain_size, Function function)
+{
+   if (begin >= end) return;
+   grain_size = std::max( grain_size, size_t{ 1 } );
+
+   // Waking the workers costs more than small loops take, and a single thread has nobody to share with.
+   if (end - begin <= grain_size || Workers.size() == 1) {
+      for (size_t i = begin; i < end; i += grain_size) function( i, std::min( i + grain_size, end ), 0 );
+      return;
+   }
+   run( begin, end, grain_size, std::function<void(size_t, size_t, int)>( function ) );
+}
\ No newline at end of file
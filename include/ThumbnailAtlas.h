@@ -0,0 +1,40 @@
+#pragma once
+
+#include "_Common.h"
+
+// Slots of equal size side by side in one offscreen color and depth target. A slot is drawn once and stays valid until
+// it is invalidated, and the whole strip reaches the window with a single blit, so unchanged slots cost nothing but
+// their share of that copy.
+class ThumbnailAtlasGL
+{
+public:
+   ThumbnailAtlasGL();
+   ~ThumbnailAtlasGL();
+
+   ThumbnailAtlasGL(const ThumbnailAtlasGL&) = delete;
+   ThumbnailAtlasGL& operator=(const ThumbnailAtlasGL&) = delete;
+
+   // Returns false if the framebuffer is incomplete, in which case nothing is kept.
+   bool create(int slot_width, int slot_height, int slot_num);
+   // Needs the context the atlas was created in to be current.
+   void destroy();
+   [[nodiscard]] bool isCreated() const { return FBO != 0; }
+   [[nodiscard]] int getSlotNum() const { return static_cast<int>(ValidSlots.size()); }
+   [[nodiscard]] bool isValid(int slot) const { return ValidSlots[slot]; }
+   void invalidate(int slot) { ValidSlots[slot] = false; }
+   void invalidateAll() { std::fill( ValidSlots.begin(), ValidSlots.end(), false ); }
+   // Binds the atlas with the viewport on the slot and clears it; the slot is valid from here on.
+   void beginSlot(int slot);
+   // Binds the window framebuffer again.
+   void endSlots() const;
+   // Copies every slot to the window framebuffer with the lower left corner at (x, y).
+   void blit(int x, int y) const;
+
+private:
+   GLuint FBO;
+   GLuint ColorTexture;
+   GLuint DepthBuffer;
+   int SlotWidth;
+   int SlotHeight;
+   std::vector<bool> ValidSlots;
+};
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "_Common.h"
+#include "KeyframeFile.h"
+#include "QuaternionSpline.h"
+#include "RotationPolicies.h"
+#include "TaskScheduler.h"
+
+// The animation the renderer plays, sampled offline at evenly spaced times and without a window: the Euler angle track
+// interpolated as the left view does and the quaternion track slerped or squad-interpolated as the right view does.
+// Chunks of samples are spread over the threads of a scheduler and written straight into caller-owned arrays, and
+// every sample only depends on its time, so the result does not depend on the thread count.
+class TimelineEvaluator
+{
+public:
+   struct Timeline
+   {
+      const KeyframeTrack<OrientateRotation::Value>* EulerAngles;
+      const KeyframeTrack<QuaternionRotation::Value>* Quaternions;
+      const QuaternionSpline* Spline; // nullptr slerps the quaternion keys with the selected QuaternionSlerp method
+   };
+
+   struct SampleArrays
+   {
+      float* EulerAngles[3]; // pitch, roll, yaw
+      QuaternionArrays Quaternions;
+   };
+
+   // --export-timeline: samples a track file into a CSV file of time, pitch, roll, yaw, w, x, y, z per line.
+   struct ExportSettings
+   {
+      std::string TrackFilePath;
+      std::string OutputFilePath;
+      double SampleRate; // per second of animation time
+      double Duration; // in seconds; 0 samples one loop of the track
+      bool UseSpline;
+      int ThreadNum;
+
+      ExportSettings() : SampleRate( 1000.0 ), Duration( 0.0 ), UseSpline( false ), ThreadNum( 0 ) {}
+   };
+
+   inline static constexpr size_t ChunkSize = 4096;
+
+   // thread_num counts the calling thread as well; 0 uses every hardware thread.
+   explicit TimelineEvaluator(int thread_num = 0);
+
+   [[nodiscard]] int getThreadNum() const { return Scheduler.getThreadNum(); }
+   // Sample i is at start_time + i * time_step, in the time unit of the tracks.
+   void evaluate(
+      const Timeline& timeline,
+      double start_time,
+      double time_step,
+      size_t sample_num,
+      const SampleArrays& samples
+   );
+   // Returns false if the track file cannot be read or the output cannot be written.
+   static bool exportTimeline(const ExportSettings& settings);
+
+private:
+   // One per thread: the sample times and the slerp inputs of a chunk.
+   struct Workspace
+   {
+      std::vector<double> Times;
+      std::vector<float> T;
+      std::array<std::vector<float>, 8> Keys;
+   };
+
+   TaskScheduler Scheduler;
+   std::vector<Workspace> Workspaces;
+
+   static void evaluateChunk(
+      const Timeline& timeline,
+      size_t begin,
+      size_t end,
+      const SampleArrays& samples,
+      Workspace& workspace
+   );
+};
\ No newline at end of file
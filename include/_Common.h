@@ -16,12 +16,26 @@
 #include <iostream>
 #include <iomanip>
 #include <vector>
+#include <deque>
+#include <array>
 #include <string>
 #include <map>
+#include <set>
 #include <unordered_map>
 #include <sstream>
 #include <fstream>
+#include <filesystem>
+#include <cstring>
 #include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
 
 #include "ProjectPath.h"
 
@@ -1,8 +1,347 @@
 #include "Renderer.h"
+#include "Benchmark.h"
+#include "SingularitySweep.h"
+#include "TimelineEvaluator.h"
+#include "CompressedTrack.h"
 
-int main()
+namespace
 {
-   RendererGL renderer;
-   renderer.play();
+   bool readOption(const std::string& argument, const std::string& name, std::string& value)
+   {
+      const std::string prefix = "--" + name + "=";
+      if (argument.compare( 0, prefix.size(), prefix ) != 0) return false;
+      value = argument.substr( prefix.size() );
+      return true;
+   }
+
+   // Reads all of value as a number that is not negative, or above 0 if positive is set, and otherwise prints an error.
+   bool readNumber(const std::string& name, const std::string& value, double& number, bool positive = false)
+   {
+      char* end = nullptr;
+      const double parsed = std::strtod( value.c_str(), &end );
+      if (value.empty() || end != value.c_str() + value.size() || !std::isfinite( parsed ) ||
+          parsed < 0.0 || (positive && parsed == 0.0)) {
+         std::cerr << "--" << name << " needs a " << (positive ? "positive" : "non-negative") << " number, not \""
+            << value << "\"\n";
+         return false;
+      }
+      number = parsed;
+      return true;
+   }
+
+   // Reads all of value as a whole number of at least minimum, and otherwise prints an error.
+   template<typename T>
+   bool readInteger(const std::string& name, const std::string& value, T& number, long long minimum)
+   {
+      char* end = nullptr;
+      errno = 0;
+      const long long parsed = std::strtoll( value.c_str(), &end, 10 );
+      if (value.empty() || end != value.c_str() + value.size() || errno == ERANGE || parsed < minimum ||
+          (parsed > 0 && static_cast<unsigned long long>(parsed) > std::numeric_limits<T>::max())) {
+         std::cerr << "--" << name << " needs a whole number of at least " << minimum << ", not \"" << value << "\"\n";
+         return false;
+      }
+      number = static_cast<T>(parsed);
+      return true;
+   }
+
+   bool getFramePacing(FrameScheduler::Settings& settings, int argc, char** argv)
+   {
+      bool valid = true;
+      for (int i = 1; i < argc; ++i) {
+         std::string value;
+         const std::string argument(argv[i]);
+         if (readOption( argument, "fps", value )) valid &= readNumber( "fps", value, settings.TargetFrameRate );
+         else if (readOption( argument, "idle-fps", value )) {
+            valid &= readNumber( "idle-fps", value, settings.IdleFrameRate );
+         }
+         else if (readOption( argument, "simulation-rate", value )) {
+            valid &= readNumber( "simulation-rate", value, settings.SimulationRate, true );
+         }
+         else if (readOption( argument, "vsync", value )) settings.VSync = value != "0" && value != "off";
+         else if (readOption( argument, "frame-report", value )) {
+            valid &= readNumber( "frame-report", value, settings.ReportInterval );
+         }
+         else if (readOption( argument, "on-demand", value )) settings.RenderOnDemand = value != "0" && value != "off";
+      }
+      return valid;
+   }
+
+   bool getGpuProfiling(double& report_interval, std::string& csv_path, int argc, char** argv)
+   {
+      bool valid = true;
+      for (int i = 1; i < argc; ++i) {
+         std::string value;
+         const std::string argument(argv[i]);
+         if (readOption( argument, "gpu-report", value )) {
+            valid &= readNumber( "gpu-report", value, report_interval, true );
+         }
+         else if (readOption( argument, "gpu-csv", value )) csv_path = value;
+      }
+      return valid;
+   }
+
+   bool getFrameCapture(FrameCaptureGL::Settings& settings, int argc, char** argv)
+   {
+      bool valid = true;
+      for (int i = 1; i < argc; ++i) {
+         std::string value;
+         const std::string argument(argv[i]);
+         if (readOption( argument, "capture-format", value )) {
+            if (value == "png") settings.Format = FrameCaptureGL::CaptureFormat::PNG;
+            else if (value == "exr") settings.Format = FrameCaptureGL::CaptureFormat::EXR;
+            else if (value == "raw") settings.Format = FrameCaptureGL::CaptureFormat::Raw;
+            else {
+               std::cerr << "--capture-format needs png, exr or raw, not \"" << value << "\"\n";
+               valid = false;
+            }
+         }
+         else if (readOption( argument, "capture-dir", value )) settings.DirectoryPath = value;
+         else if (readOption( argument, "capture-pipe", value )) settings.PipeCommand = value;
+         else if (readOption( argument, "capture-buffers", value )) {
+            valid &= readInteger( "capture-buffers", value, settings.BufferCount, 1 );
+         }
+         else if (readOption( argument, "capture-workers", value )) {
+            valid &= readInteger( "capture-workers", value, settings.WorkerCount, 1 );
+         }
+      }
+      return valid;
+   }
+
+   // Returns whether a benchmark is requested; valid is cleared if any of its options cannot be read.
+   bool getBenchmark(Benchmark::Settings& settings, bool& valid, int argc, char** argv)
+   {
+      valid = true;
+      for (int i = 1; i < argc; ++i) {
+         std::string value;
+         const std::string argument(argv[i]);
+         if (readOption( argument, "benchmark", value )) settings.Name = value;
+         else if (readOption( argument, "benchmark-count", value )) {
+            valid &= readInteger( "benchmark-count", value, settings.Count, 1 );
+         }
+         else if (readOption( argument, "benchmark-repeat", value )) {
+            valid &= readInteger( "benchmark-repeat", value, settings.RepeatNum, 1 );
+         }
+      }
+      return !settings.Name.empty();
+   }
+
+   // --sweep=N samples every angle N times, --sweep=PxRxY pitch, roll and yaw separately. Returns whether a sweep
+   // is requested; valid is cleared if any of its options cannot be read.
+   bool getSingularitySweep(SingularitySweep::Settings& settings, bool& valid, int argc, char** argv)
+   {
+      bool requested = false;
+      valid = true;
+      for (int i = 1; i < argc; ++i) {
+         std::string value;
+         const std::string argument(argv[i]);
+         if (readOption( argument, "sweep", value )) {
+            requested = true;
+            std::vector<std::string> counts;
+            std::istringstream stream( value );
+            for (std::string count; std::getline( stream, count, 'x' );) counts.emplace_back( count );
+            if (counts.size() != 1 && counts.size() != 3) {
+               std::cerr << "--sweep needs N or PxRxY, not \"" << value << "\"\n";
+               valid = false;
+               continue;
+            }
+            for (size_t k = 0; k < counts.size(); ++k) {
+               valid &= readInteger( "sweep", counts[k], settings.SampleNum[k], 1 );
+            }
+            if (counts.size() == 1) settings.SampleNum.fill( settings.SampleNum[0] );
+         }
+         else if (readOption( argument, "sweep-heatmap", value )) {
+            valid &= readInteger( "sweep-heatmap", value, settings.HeatmapSize, 1 );
+         }
+         else if (readOption( argument, "sweep-step", value )) {
+            double step = 0.0;
+            if (readNumber( "sweep-step", value, step, true )) {
+               settings.InterpolationStep = glm::radians( static_cast<float>(step) );
+            }
+            else valid = false;
+         }
+         else if (readOption( argument, "sweep-threads", value )) {
+            valid &= readInteger( "sweep-threads", value, settings.ThreadNum, 0 );
+         }
+         else if (readOption( argument, "sweep-output", value )) settings.OutputDirectoryPath = value;
+      }
+      return requested;
+   }
+
+   // --joints=CHAINSxDEPTH, or --joints=CHAINS for chains of 16 joints.
+   bool getJointChains(const std::string& value, int& chain_num, int& depth)
+   {
+      const size_t separator = value.find( 'x' );
+      depth = 16;
+      return readInteger( "joints", value.substr( 0, separator ), chain_num, 1 ) &&
+         (separator == std::string::npos || readInteger( "joints", value.substr( separator + 1 ), depth, 1 ));
+   }
+
+   // Returns whether an export is requested; valid is cleared if any of its options cannot be read.
+   bool getTimelineExport(
+      TimelineEvaluator::ExportSettings& settings,
+      bool& valid,
+      const std::string& track_path,
+      int argc,
+      char** argv
+   )
+   {
+      valid = true;
+      settings.TrackFilePath = track_path;
+      for (int i = 1; i < argc; ++i) {
+         std::string value;
+         const std::string argument(argv[i]);
+         if (readOption( argument, "export-timeline", value )) settings.OutputFilePath = value;
+         else if (readOption( argument, "export-rate", value )) {
+            valid &= readNumber( "export-rate", value, settings.SampleRate, true );
+         }
+         else if (readOption( argument, "export-duration", value )) {
+            valid &= readNumber( "export-duration", value, settings.Duration );
+         }
+         else if (readOption( argument, "export-threads", value )) {
+            valid &= readInteger( "export-threads", value, settings.ThreadNum, 0 );
+         }
+         else if (argument == "--export-spline") settings.UseSpline = true;
+      }
+      return !settings.OutputFilePath.empty();
+   }
+
+   // Returns whether a compression is requested; valid is cleared if any of its options cannot be read.
+   bool getTrackCompression(
+      CompressedTrack::FileSettings& settings,
+      bool& valid,
+      const std::string& track_path,
+      int argc,
+      char** argv
+   )
+   {
+      bool requested = false;
+      valid = true;
+      settings.TrackFilePath = track_path;
+      for (int i = 1; i < argc; ++i) {
+         std::string value;
+         const std::string argument(argv[i]);
+         if (readOption( argument, "compress-track", value )) {
+            requested = true;
+            double tolerance = 0.0;
+            if (readNumber( "compress-track", value, tolerance )) {
+               settings.ToleranceInDegrees = static_cast<float>(tolerance);
+            }
+            else valid = false;
+         }
+         else if (readOption( argument, "compress-output", value )) settings.OutputFilePath = value;
+         else if (readOption( argument, "compress-block", value )) {
+            valid &= readInteger( "compress-block", value, settings.BlockSize, 1 );
+         }
+      }
+      return requested;
+   }
+
+   // --clock=fixed steps by --clock-step seconds every frame, --clock=scripted reads the frame times of --clock-script.
+   bool getFrameClock(FrameClock& clock, int argc, char** argv)
+   {
+      std::string mode, script_path;
+      double step = 1.0 / 60.0;
+      for (int i = 1; i < argc; ++i) {
+         std::string value;
+         const std::string argument(argv[i]);
+         if (readOption( argument, "clock", value )) mode = value;
+         else if (readOption( argument, "clock-step", value )) {
+            if (!readNumber( "clock-step", value, step, true )) return false;
+         }
+         else if (readOption( argument, "clock-script", value )) script_path = value;
+      }
+      if (mode == "fixed") clock.setFixedStep( step );
+      else if (mode == "scripted") return clock.loadScript( script_path );
+      else if (!mode.empty() && mode != "real") {
+         std::cerr << "--clock needs real, fixed or scripted, not \"" << mode << "\"\n";
+         return false;
+      }
+      return true;
+   }
+}
+
+int main(int argc, char** argv)
+{
+   std::string trace_path, program_cache_path, track_path, slerp_method, joint_chains, scene_objects;
+   for (int i = 1; i < argc; ++i) {
+      readOption( argv[i], "trace", trace_path );
+      readOption( argv[i], "program-cache", program_cache_path );
+      readOption( argv[i], "track", track_path );
+      readOption( argv[i], "slerp", slerp_method );
+      readOption( argv[i], "joints", joint_chains );
+      readOption( argv[i], "objects", scene_objects );
+   }
+   if (slerp_method == "polynomial") QuaternionSlerp::setMethod( QuaternionSlerp::Method::Polynomial );
+   else if (!slerp_method.empty() && slerp_method != "exact") {
+      std::cerr << "--slerp needs exact or polynomial, not \"" << slerp_method << "\"\n";
+      return 1;
+   }
+   Benchmark::Settings benchmark;
+   bool benchmark_valid = true;
+   if (getBenchmark( benchmark, benchmark_valid, argc, argv )) {
+      return benchmark_valid && Benchmark::run( benchmark ) ? 0 : 1;
+   }
+   SingularitySweep::Settings sweep;
+   bool sweep_valid = true;
+   if (getSingularitySweep( sweep, sweep_valid, argc, argv )) {
+      return sweep_valid && SingularitySweep::run( sweep ) ? 0 : 1;
+   }
+   TimelineEvaluator::ExportSettings timeline;
+   bool timeline_valid = true;
+   if (getTimelineExport( timeline, timeline_valid, track_path, argc, argv )) {
+      if (!timeline_valid) return 1;
+      if (track_path.empty()) {
+         std::cerr << "--export-timeline needs a --track file\n";
+         return 1;
+      }
+      return TimelineEvaluator::exportTimeline( timeline ) ? 0 : 1;
+   }
+   CompressedTrack::FileSettings compression;
+   bool compression_valid = true;
+   if (getTrackCompression( compression, compression_valid, track_path, argc, argv )) {
+      if (!compression_valid) return 1;
+      if (track_path.empty()) {
+         std::cerr << "--compress-track needs a --track file\n";
+         return 1;
+      }
+      return CompressedTrack::compressFile( compression ) ? 0 : 1;
+   }
+   FrameClock clock;
+   if (!getFrameClock( clock, argc, argv )) return 1;
+   FrameScheduler::Settings pacing;
+   if (!getFramePacing( pacing, argc, argv )) return 1;
+   double gpu_report_interval = 0.0;
+   std::string gpu_csv_path;
+   if (!getGpuProfiling( gpu_report_interval, gpu_csv_path, argc, argv )) return 1;
+   FrameCaptureGL::Settings capture;
+   if (!getFrameCapture( capture, argc, argv )) return 1;
+   int joint_chain_num = 0, joint_depth = 0;
+   if (!joint_chains.empty() && !getJointChains( joint_chains, joint_chain_num, joint_depth )) return 1;
+   int scene_object_num = 0;
+   if (!scene_objects.empty() && !readInteger( "objects", scene_objects, scene_object_num, 1 )) return 1;
+
+   if (!program_cache_path.empty()) ShaderGL::setProgramCacheDirectory( program_cache_path );
+   if (!trace_path.empty()) {
+      CpuProfiler::setEnabled( true );
+      CpuProfiler::setThreadName( "Main" );
+   }
+
+   {
+      RendererGL renderer;
+      renderer.setFramePacing( pacing );
+      renderer.setGpuProfiling( gpu_report_interval, gpu_csv_path );
+      renderer.setFrameCapture( capture );
+      renderer.setShaderHotReload( std::find( argv + 1, argv + argc, std::string("--hot-reload") ) != argv + argc );
+      renderer.setClock( clock );
+      if (!track_path.empty() && !renderer.setTrackFile( track_path )) return 1;
+      if (joint_chain_num > 0) renderer.setJointChains( joint_chain_num, joint_depth );
+      if (scene_object_num > 0) renderer.setSceneObjects( scene_object_num );
+      renderer.play();
+   }
+
+   if (!trace_path.empty() && CpuProfiler::writeChromeTrace( trace_path )) {
+      std::cout << "CPU trace written to " << trace_path << "\n";
+   }
    return 0;
 }
\ No newline at end of file
@@ -1,12 +1,22 @@
 #version 460
+#extension GL_GOOGLE_include_directive : enable
 
-uniform vec4 Color;
-uniform mat4 WorldMatrix;
-uniform mat4 ViewMatrix;
-uniform mat4 ProjectionMatrix;
+#include "BasicTransforms.glsl"
 
-in vec3 position_in_ec;
-in vec3 normal_in_ec;
+#ifdef USE_TEXTURE
+layout (binding = 0) uniform sampler2D BaseTexture;
+#endif
+
+layout (location = 0) in vec3 position_in_ec;
+#ifdef USE_NORMAL
+layout (location = 1) in vec3 normal_in_ec;
+#endif
+#ifdef USE_TEXTURE
+layout (location = 2) in vec2 tex_coord;
+#endif
+#ifdef INSTANCED_COLORS
+layout (location = 3) in vec4 instance_color;
+#endif
 
 layout (location = 0) out vec4 final_color;
 
@@ -15,8 +25,20 @@ const float one = 1.0f;
 
 void main()
 {
+#ifdef INSTANCED_COLORS
+   vec4 color = instance_color;
+#else
+   vec4 color = Color;
+#endif
+#ifdef USE_TEXTURE
+   color *= texture( BaseTexture, tex_coord );
+#endif
+#ifdef USE_NORMAL
    vec4 light_position_in_ec = ViewMatrix * vec4(10.0f, 150.0f, 10.0f, 1.0f);
    vec3 light_vector = normalize( light_position_in_ec.xyz );
    float diffuse_intensity = max( dot( normal_in_ec, light_vector ), zero ) + 0.8f;
-   final_color = diffuse_intensity * Color;
+   final_color = diffuse_intensity * color;
+#else
+   final_color = color;
+#endif
 }
\ No newline at end of file
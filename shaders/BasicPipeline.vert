@@ -1,23 +1,70 @@
 #version 460
+#extension GL_GOOGLE_include_directive : enable
 
-uniform mat4 WorldMatrix;
-uniform mat4 ViewMatrix;
-uniform mat4 ProjectionMatrix;
-uniform mat4 ModelViewProjectionMatrix;
+#include "BasicTransforms.glsl"
 
 layout (location = 0) in vec3 v_position;
+#ifdef USE_NORMAL
 layout (location = 1) in vec3 v_normal;
+#endif
+#ifdef USE_TEXTURE
 layout (location = 2) in vec2 v_tex_coord;
+#endif
+#ifdef INSTANCED_JOINTS
+// World rotation of the joint as x, y, z, w, and its world position with the bone length, which scales the mesh.
+layout (location = 3) in vec4 i_rotation;
+layout (location = 4) in vec4 i_position_and_length;
+#endif
+#ifdef INSTANCED_COLORS
+layout (location = 5) in vec4 i_color;
+#endif
 
-out vec3 position_in_ec;
-out vec3 normal_in_ec;
+layout (location = 0) out vec3 position_in_ec;
+#ifdef USE_NORMAL
+layout (location = 1) out vec3 normal_in_ec;
+#endif
+#ifdef USE_TEXTURE
+layout (location = 2) out vec2 tex_coord;
+#endif
+#ifdef INSTANCED_COLORS
+layout (location = 3) out vec4 instance_color;
+#endif
+
+#ifdef INSTANCED_JOINTS
+vec3 rotate(vec4 q, vec3 v)
+{
+   return v + 2.0f * cross( q.xyz, cross( q.xyz, v ) + q.w * v );
+}
+#endif
 
 void main()
 {
-   vec4 e_position = ViewMatrix * WorldMatrix * vec4(v_position, 1.0f);
-   vec4 e_normal = transpose( inverse( ViewMatrix * WorldMatrix ) ) * vec4(v_normal, 1.0f);
+#ifdef INSTANCED_JOINTS
+   vec3 position = i_position_and_length.xyz + rotate( i_rotation, v_position * i_position_and_length.w );
+#else
+   vec3 position = v_position;
+#endif
+   vec4 e_position = ViewMatrix * WorldMatrix * vec4(position, 1.0f);
    position_in_ec = e_position.xyz;
+#ifdef USE_NORMAL
+#ifdef INSTANCED_JOINTS
+   vec3 normal = rotate( i_rotation, v_normal );
+#else
+   vec3 normal = v_normal;
+#endif
+#ifdef PRECOMPUTED_NORMAL_MATRIX
+   normal_in_ec = normalize( NormalMatrix * normal );
+#else
+   vec4 e_normal = transpose( inverse( ViewMatrix * WorldMatrix ) ) * vec4(normal, 1.0f);
    normal_in_ec = normalize( e_normal.xyz );
+#endif
+#endif
+#ifdef USE_TEXTURE
+   tex_coord = v_tex_coord;
+#endif
+#ifdef INSTANCED_COLORS
+   instance_color = i_color;
+#endif
 
-   gl_Position = ModelViewProjectionMatrix * vec4(v_position, 1.0f);
+   gl_Position = ModelViewProjectionMatrix * vec4(position, 1.0f);
 }
\ No newline at end of file
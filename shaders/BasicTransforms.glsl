@@ -0,0 +1,9 @@
+// Explicit locations keep the uniforms addressable when the program is loaded from SPIR-V without names.
+layout (location = 0) uniform vec4 Color;
+layout (location = 1) uniform mat4 WorldMatrix;
+layout (location = 2) uniform mat4 ViewMatrix;
+layout (location = 3) uniform mat4 ProjectionMatrix;
+layout (location = 4) uniform mat4 ModelViewProjectionMatrix;
+#ifdef PRECOMPUTED_NORMAL_MATRIX
+layout (location = 5) uniform mat3 NormalMatrix;
+#endif
\ No newline at end of file
@@ -0,0 +1,835 @@
+#include "Benchmark.h"
+#include "QuaternionSlerp.h"
+
+bool Benchmark::run(const Settings& settings)
+{
+   if (settings.Name == "rotation") runRotationConversion( settings );
+   else if (settings.Name == "slerp") runSlerp( settings );
+   else if (settings.Name == "joints") runJointPropagation( settings );
+   else if (settings.Name == "representations") runRotationRepresentations( settings );
+   else if (settings.Name == "timeline") runTimelineEvaluation( settings );
+   else if (settings.Name == "compression") runTrackCompression( settings );
+   else if (settings.Name == "culling") runFrustumCulling( settings );
+   else if (settings.Name == "scene") runSceneSystems( settings );
+   else {
+      std::cerr << "Unknown benchmark: " << settings.Name
+         << " (available: rotation, slerp, joints, representations, timeline, compression, culling, scene)\n";
+      return false;
+   }
+   return true;
+}
+
+template<typename Function>
+double Benchmark::getBestTime(const Settings& settings, Function function)
+{
+   double best_time = std::numeric_limits<double>::max();
+   for (int i = 0; i < std::max( settings.RepeatNum, 1 ); ++i) {
+      const auto start = std::chrono::steady_clock::now();
+      function();
+      const auto end = std::chrono::steady_clock::now();
+      best_time = std::min( best_time, std::chrono::duration<double, std::nano>(end - start).count() );
+   }
+   return best_time / static_cast<double>(std::max( settings.Count, size_t{ 1 } ));
+}
+
+void Benchmark::runRotationConversion(const Settings& settings)
+{
+   const size_t n = settings.Count;
+   std::mt19937 generator( 20190730 );
+   std::uniform_real_distribution<float> distribution( -glm::pi<float>(), glm::pi<float>() );
+   std::vector<float> pitch(n), roll(n), yaw(n);
+   for (size_t i = 0; i < n; ++i) {
+      pitch[i] = distribution( generator );
+      roll[i] = distribution( generator );
+      yaw[i] = distribution( generator );
+   }
+   const EulerAngleArrays angles{ pitch.data(), roll.data(), yaw.data() };
+
+   std::vector<glm::quat> glm_quaternions(n);
+   std::vector<glm::mat3> glm_matrices3(n);
+   std::vector<glm::mat4> glm_matrices4(n);
+   const double glm_quaternion_time = getBestTime( settings, [&]() {
+      for (size_t i = 0; i < n; ++i) glm_quaternions[i] = toQuat( orientate3( glm::vec3(pitch[i], roll[i], yaw[i]) ) );
+   } );
+   const double glm_matrix3_time = getBestTime( settings, [&]() {
+      for (size_t i = 0; i < n; ++i) glm_matrices3[i] = orientate3( glm::vec3(pitch[i], roll[i], yaw[i]) );
+   } );
+   const double glm_matrix4_time = getBestTime( settings, [&]() {
+      for (size_t i = 0; i < n; ++i) glm_matrices4[i] = orientate4( glm::vec3(pitch[i], roll[i], yaw[i]) );
+   } );
+
+   std::cout << std::fixed << std::setprecision( 2 ) << "[Benchmark] " << n << " random Euler angles, best of "
+      << settings.RepeatNum << " runs, ns per rotation (speed-up over glm, max error in ulps of 1.0)\n"
+      << "[Benchmark] " << std::left << std::setw( 8 ) << "glm" << std::right
+      << " quaternion " << std::setw( 6 ) << glm_quaternion_time
+      << std::setw( 25 ) << "mat3 " << std::setw( 6 ) << glm_matrix3_time
+      << std::setw( 25 ) << "mat4 " << std::setw( 6 ) << glm_matrix4_time << "\n";
+
+   std::vector<float> quaternions(4 * n), matrices3(9 * n), matrices4(16 * n);
+   const QuaternionArrays quaternion_arrays{
+      quaternions.data(), quaternions.data() + n, quaternions.data() + 2 * n, quaternions.data() + 3 * n
+   };
+   Matrix3Arrays matrix3_arrays{};
+   Matrix4Arrays matrix4_arrays{};
+   for (size_t k = 0; k < 9; ++k) matrix3_arrays.M[k] = matrices3.data() + k * n;
+   for (size_t k = 0; k < 16; ++k) matrix4_arrays.M[k] = matrices4.data() + k * n;
+
+   bool within_tolerance = true;
+   const auto print_result = [&within_tolerance](const char* name, double time, double glm_time, float error) {
+      within_tolerance &= error <= RotationKernels::MaxErrorInUlps;
+      std::cout << " " << name << " " << std::setw( 6 ) << time << " (x" << std::setw( 5 ) << glm_time / time << ", "
+         << std::setw( 4 ) << error << " ulp)";
+   };
+   const float epsilon = std::numeric_limits<float>::epsilon();
+   const RotationKernels::InstructionSet selected = RotationKernels::getInstructionSet();
+   const int supported = static_cast<int>(RotationKernels::getSupportedInstructionSet());
+   for (int i = 0; i <= supported; ++i) {
+      const auto instruction_set = static_cast<RotationKernels::InstructionSet>(i);
+      RotationKernels::setInstructionSet( instruction_set );
+      const double quaternion_time = getBestTime( settings, [&]() {
+         RotationKernels::toQuaternions( angles, quaternion_arrays, n );
+      } );
+      const double matrix3_time = getBestTime( settings, [&]() {
+         RotationKernels::toMatrices( angles, matrix3_arrays, n );
+      } );
+      const double matrix4_time = getBestTime( settings, [&]() {
+         RotationKernels::toMatrices( angles, matrix4_arrays, n );
+      } );
+
+      // q and -q are the same rotation, so a quaternion is compared with whichever sign of glm's is closer.
+      float quaternion_error = 0.0f, matrix3_error = 0.0f, matrix4_error = 0.0f;
+      for (size_t j = 0; j < n; ++j) {
+         const glm::quat& q = glm_quaternions[j];
+         const std::array<float, 4> reference = { q.w, q.x, q.y, q.z };
+         float same_sign = 0.0f, opposite_sign = 0.0f;
+         for (size_t k = 0; k < 4; ++k) {
+            same_sign = std::max( same_sign, std::abs( quaternions[k * n + j] - reference[k] ) );
+            opposite_sign = std::max( opposite_sign, std::abs( quaternions[k * n + j] + reference[k] ) );
+         }
+         quaternion_error = std::max( quaternion_error, std::min( same_sign, opposite_sign ) );
+         for (size_t k = 0; k < 9; ++k) {
+            matrix3_error = std::max( matrix3_error, std::abs( matrices3[k * n + j] - glm_matrices3[j][k / 3][k % 3] ) );
+         }
+         for (size_t k = 0; k < 16; ++k) {
+            matrix4_error = std::max( matrix4_error, std::abs( matrices4[k * n + j] - glm_matrices4[j][k / 4][k % 4] ) );
+         }
+      }
+
+      std::cout << "[Benchmark] " << std::left << std::setw( 8 ) << RotationKernels::getInstructionSetName( instruction_set )
+         << std::right;
+      print_result( "quaternion", quaternion_time, glm_quaternion_time, quaternion_error / epsilon );
+      print_result( "mat3", matrix3_time, glm_matrix3_time, matrix3_error / epsilon );
+      print_result( "mat4", matrix4_time, glm_matrix4_time, matrix4_error / epsilon );
+      std::cout << "\n";
+   }
+   RotationKernels::setInstructionSet( selected );
+
+   if (within_tolerance) {
+      std::cout << "[Benchmark] all kernels are within " << RotationKernels::MaxErrorInUlps << " ulps of glm\n";
+   }
+   else std::cerr << "[Benchmark] some kernels exceed the tolerance of " << RotationKernels::MaxErrorInUlps << " ulps\n";
+}
+
+void Benchmark::runSlerp(const Settings& settings)
+{
+   // The angle between the pairs in R4 is swept from 0 to pi, so that the rotations are 0 to 360 degrees apart and the
+   // second half also exercises the negation that keeps slerp on the shorter arc.
+   const size_t n = std::max( settings.Count, size_t{ 2 } );
+   std::mt19937 generator( 20190730 );
+   std::normal_distribution<double> normal;
+   std::uniform_real_distribution<float> uniform( 0.0f, 1.0f );
+   std::vector<glm::quat> from(n), to(n);
+   std::vector<float> t(n);
+   for (size_t i = 0; i < n; ++i) {
+      glm::dvec4 a(normal( generator ), normal( generator ), normal( generator ), normal( generator ));
+      glm::dvec4 p(normal( generator ), normal( generator ), normal( generator ), normal( generator ));
+      a = normalize( a );
+      p = normalize( p - dot( p, a ) * a );
+      const double angle = glm::pi<double>() * static_cast<double>(i) / static_cast<double>(n - 1);
+      const glm::dvec4 b = std::cos( angle ) * a + std::sin( angle ) * p;
+      from[i] = glm::quat(glm::dquat(a.w, a.x, a.y, a.z));
+      to[i] = glm::quat(glm::dquat(b.w, b.x, b.y, b.z));
+      t[i] = uniform( generator );
+   }
+
+   // The reference is slerp in double precision on the float inputs; the error is the rotation angle between the
+   // reference and a result, which does not depend on the result's norm, reported separately. Pairs almost half a turn
+   // apart in R4 may go either way round, as rounding decides which arc is the shorter one.
+   const auto get_reference = [](const glm::dquat& a, const glm::dquat& b, double s) {
+      const double angle = std::acos( std::clamp( dot( a, b ), -1.0, 1.0 ) );
+      if (angle < 1e-12) return a * (1.0 - s) + b * s;
+      return (a * std::sin( (1.0 - s) * angle ) + b * std::sin( s * angle )) / std::sin( angle );
+   };
+   std::vector<glm::dquat> references(n), other_arcs(n);
+   for (size_t i = 0; i < n; ++i) {
+      const glm::dquat a(from[i]);
+      const glm::dquat b(to[i]);
+      const double cosine = dot( a, b );
+      const double s = static_cast<double>(t[i]);
+      references[i] = get_reference( a, cosine < 0.0 ? -b : b, s );
+      other_arcs[i] = std::abs( cosine ) < 1e-6 ? get_reference( a, cosine < 0.0 ? b : -b, s ) : references[i];
+   }
+   const auto get_angle = [](const glm::dquat& reference, const glm::quat& q) {
+      const glm::dquat difference = conjugate( reference ) * glm::dquat(q);
+      const double sine = length( glm::dvec3(difference.x, difference.y, difference.z) );
+      return 2.0 * std::atan2( sine, std::abs( difference.w ) );
+   };
+   const auto get_error = [&](size_t i, const glm::quat& q, double& angle_error, double& norm_error) {
+      angle_error = std::max( angle_error, std::min( get_angle( references[i], q ), get_angle( other_arcs[i], q ) ) );
+      norm_error = std::max( norm_error, std::abs( length( glm::dquat(q) ) - 1.0 ) );
+   };
+
+   std::vector<glm::quat> results(n);
+   const double glm_time = getBestTime( settings, [&]() {
+      for (size_t i = 0; i < n; ++i) results[i] = slerp( from[i], to[i], t[i] );
+   } );
+   double glm_angle_error = 0.0, glm_norm_error = 0.0;
+   for (size_t i = 0; i < n; ++i) get_error( i, results[i], glm_angle_error, glm_norm_error );
+
+   const double polynomial_time = getBestTime( settings, [&]() {
+      for (size_t i = 0; i < n; ++i) results[i] = QuaternionSlerp::approximate( from[i], to[i], t[i] );
+   } );
+   double polynomial_angle_error = 0.0, polynomial_norm_error = 0.0;
+   for (size_t i = 0; i < n; ++i) get_error( i, results[i], polynomial_angle_error, polynomial_norm_error );
+
+   bool within_tolerance = polynomial_angle_error <= RotationKernels::MaxSlerpErrorInRadians;
+   const auto print_result = [&](const char* name, double time, double angle_error, double norm_error) {
+      std::cout << "[Benchmark] " << std::left << std::setw( 18 ) << name << std::right << std::fixed
+         << std::setprecision( 2 ) << std::setw( 7 ) << time << " ns (x" << std::setw( 5 ) << glm_time / time << ")"
+         << std::scientific << std::setprecision( 2 ) << "  rotation error " << angle_error << " rad"
+         << "  |norm - 1| " << norm_error << "\n";
+   };
+   std::cout << "[Benchmark] " << n << " quaternion pairs 0 to 360 degrees apart, best of " << settings.RepeatNum
+      << " runs, ns per slerp (speed-up over glm), max errors against slerp in double precision\n";
+   print_result( "glm", glm_time, glm_angle_error, glm_norm_error );
+   print_result( "polynomial", polynomial_time, polynomial_angle_error, polynomial_norm_error );
+
+   std::vector<float> inputs(9 * n), outputs(4 * n);
+   for (size_t i = 0; i < n; ++i) {
+      const std::array<float, 8> values = {
+         from[i].w, from[i].x, from[i].y, from[i].z, to[i].w, to[i].x, to[i].y, to[i].z
+      };
+      for (size_t k = 0; k < 8; ++k) inputs[k * n + i] = values[k];
+      inputs[8 * n + i] = t[i];
+   }
+   const ConstQuaternionArrays from_arrays{
+      inputs.data(), inputs.data() + n, inputs.data() + 2 * n, inputs.data() + 3 * n
+   };
+   const ConstQuaternionArrays to_arrays{
+      inputs.data() + 4 * n, inputs.data() + 5 * n, inputs.data() + 6 * n, inputs.data() + 7 * n
+   };
+   const QuaternionArrays output_arrays{
+      outputs.data(), outputs.data() + n, outputs.data() + 2 * n, outputs.data() + 3 * n
+   };
+   const RotationKernels::InstructionSet selected = RotationKernels::getInstructionSet();
+   const int supported = static_cast<int>(RotationKernels::getSupportedInstructionSet());
+   for (int i = 0; i <= supported; ++i) {
+      const auto instruction_set = static_cast<RotationKernels::InstructionSet>(i);
+      RotationKernels::setInstructionSet( instruction_set );
+      const double time = getBestTime( settings, [&]() {
+         RotationKernels::slerpQuaternions( from_arrays, to_arrays, inputs.data() + 8 * n, n, output_arrays );
+      } );
+      double angle_error = 0.0, norm_error = 0.0;
+      for (size_t j = 0; j < n; ++j) {
+         const glm::quat q(outputs[j], outputs[n + j], outputs[2 * n + j], outputs[3 * n + j]);
+         get_error( j, q, angle_error, norm_error );
+      }
+      within_tolerance &= angle_error <= RotationKernels::MaxSlerpErrorInRadians;
+      print_result( RotationKernels::getInstructionSetName( instruction_set ), time, angle_error, norm_error );
+   }
+   RotationKernels::setInstructionSet( selected );
+
+   if (within_tolerance) {
+      std::cout << "[Benchmark] the polynomial slerp is within " << RotationKernels::MaxSlerpErrorInRadians << " rad\n";
+   }
+   else std::cerr << "[Benchmark] the polynomial slerp exceeds " << RotationKernels::MaxSlerpErrorInRadians << " rad\n";
+}
+
+void Benchmark::runJointPropagation(const Settings& settings)
+{
+   // Skeletons of 64 joints whose parents are random earlier joints of the same skeleton, which gives trees about ten
+   // levels deep with most joints in the middle levels, like characters of a crowd.
+   constexpr size_t skeleton_size = 64;
+   const size_t n = std::max( settings.Count, size_t{ 1 } );
+   std::mt19937 generator( 20190730 );
+   std::uniform_real_distribution<float> distribution( -glm::pi<float>(), glm::pi<float>() );
+   std::vector<JointHierarchy::Joint> joints(n);
+   for (size_t i = 0; i < n; ++i) {
+      const size_t skeleton_begin = i / skeleton_size * skeleton_size;
+      joints[i].Parent = i == skeleton_begin ? -1 : static_cast<int>(skeleton_begin + generator() % (i - skeleton_begin));
+      joints[i].Translation = glm::vec3(0.0f, 1.0f, 0.0f) + 0.1f * glm::vec3(
+         distribution( generator ), distribution( generator ), distribution( generator )
+      );
+      joints[i].Length = 1.0f;
+   }
+   JointHierarchy hierarchy;
+   hierarchy.build( joints );
+   std::vector<glm::vec3> angles(n);
+   for (size_t i = 0; i < n; ++i) {
+      angles[i] = glm::vec3(distribution( generator ), distribution( generator ), distribution( generator ));
+      hierarchy.setLocalEulerAngle( i, angles[i] );
+      hierarchy.setLocalRotation( i, toQuat( orientate3( angles[i] ) ) );
+   }
+
+   // The reference walks the sorted joints one at a time with glm, in arrays of structures.
+   std::vector<int> parents(n);
+   std::vector<glm::quat> local_rotations(n), world_rotations(n);
+   std::vector<glm::vec3> translations(n), world_positions(n);
+   for (size_t i = 0; i < n; ++i) {
+      parents[i] = hierarchy.getParent( i );
+      local_rotations[i] = hierarchy.getLocalRotation( i );
+      translations[i] = hierarchy.getLocalTranslation( i );
+   }
+   const double glm_time = getBestTime( settings, [&]() {
+      for (size_t i = 0; i < n; ++i) {
+         if (parents[i] < 0) {
+            world_rotations[i] = local_rotations[i];
+            world_positions[i] = translations[i];
+         }
+         else {
+            const auto parent = static_cast<size_t>(parents[i]);
+            world_rotations[i] = world_rotations[parent] * local_rotations[i];
+            world_positions[i] = world_positions[parent] + world_rotations[parent] * translations[i];
+         }
+      }
+   } );
+
+   bool within_tolerance = true;
+   const auto print_result = [&](const std::string& name, double time) {
+      float rotation_error = 0.0f, position_error = 0.0f;
+      for (size_t i = 0; i < n; ++i) {
+         const glm::quat q = hierarchy.getWorldRotation( i );
+         const glm::quat& reference = world_rotations[i];
+         rotation_error = std::max(
+            rotation_error, std::min( length( q - reference ), length( q + reference ) )
+         );
+         position_error = std::max( position_error, length( hierarchy.getWorldPosition( i ) - world_positions[i] ) );
+      }
+      within_tolerance &= rotation_error < 1e-4f && position_error < 1e-3f;
+      std::cout << "[Benchmark] " << std::left << std::setw( 22 ) << name << std::right << std::fixed
+         << std::setprecision( 2 ) << std::setw( 7 ) << time << " ns (x" << std::setw( 6 ) << glm_time / time << ")"
+         << std::scientific << std::setprecision( 2 ) << "  rotation error " << rotation_error
+         << "  position error " << position_error << "\n";
+   };
+   TaskScheduler scheduler;
+   std::cout << "[Benchmark] " << n << " joints in " << hierarchy.getLevelNum() << " levels, best of "
+      << settings.RepeatNum << " runs, ns per joint (speed-up over glm), max errors against glm\n";
+   std::cout << "[Benchmark] " << std::left << std::setw( 22 ) << "glm" << std::right << std::fixed
+      << std::setprecision( 2 ) << std::setw( 7 ) << glm_time << " ns\n";
+
+   const RotationKernels::InstructionSet selected = RotationKernels::getInstructionSet();
+   const int supported = static_cast<int>(RotationKernels::getSupportedInstructionSet());
+   for (int i = 0; i <= supported; ++i) {
+      const auto instruction_set = static_cast<RotationKernels::InstructionSet>(i);
+      RotationKernels::setInstructionSet( instruction_set );
+      const std::string name = RotationKernels::getInstructionSetName( instruction_set );
+      hierarchy.setRotationForm( JointHierarchy::RotationForm::Quaternion );
+      print_result( name, getBestTime( settings, [&]() { hierarchy.propagate(); } ) );
+      print_result(
+         name + " x" + std::to_string( scheduler.getThreadNum() ) + " threads",
+         getBestTime( settings, [&]() { hierarchy.propagate( &scheduler ); } )
+      );
+      hierarchy.setRotationForm( JointHierarchy::RotationForm::EulerAngle );
+      print_result(
+         name + " x" + std::to_string( scheduler.getThreadNum() ) + " Euler",
+         getBestTime( settings, [&]() { hierarchy.propagate( &scheduler ); } )
+      );
+   }
+   RotationKernels::setInstructionSet( selected );
+
+   if (within_tolerance) std::cout << "[Benchmark] every propagation matches glm\n";
+   else std::cerr << "[Benchmark] some propagations differ from glm\n";
+}
+
+double Benchmark::getAngleInDegrees(const glm::dquat& reference, const glm::mat3& rotation)
+{
+   const glm::dquat difference = conjugate( reference ) * normalize( quat_cast( glm::dmat3(rotation) ) );
+   const double sine = length( glm::dvec3(difference.x, difference.y, difference.z) );
+   return glm::degrees( 2.0 * std::atan2( sine, std::abs( difference.w ) ) );
+}
+
+template<typename Rotation>
+void Benchmark::runRotationRepresentation(const Settings& settings, const RotationKeys& keys)
+{
+   using Value = typename Rotation::Value;
+   const size_t n = keys.From.size();
+   std::vector<Value> from(n), to(n), results(n);
+   std::vector<glm::mat3> matrices(n);
+   for (size_t i = 0; i < n; ++i) {
+      from[i] = Rotation::fromMatrix( mat3_cast( glm::quat(keys.From[i]) ) );
+      to[i] = Rotation::fromMatrix( mat3_cast( glm::quat(keys.To[i]) ) );
+   }
+
+   const double compose_time = getBestTime( settings, [&]() {
+      for (size_t i = 0; i < n; ++i) results[i] = Rotation::compose( from[i], to[i] );
+   } );
+   double compose_error = 0.0;
+   for (size_t i = 0; i < n; ++i) {
+      compose_error = std::max( compose_error, getAngleInDegrees( keys.Composed[i], Rotation::toMatrix( results[i] ) ) );
+   }
+
+   const double interpolate_time = getBestTime( settings, [&]() {
+      for (size_t i = 0; i < n; ++i) results[i] = Rotation::interpolate( from[i], to[i], keys.T[i] );
+   } );
+   double mean_error = 0.0, max_error = 0.0;
+   for (size_t i = 0; i < n; ++i) {
+      const double error = getAngleInDegrees( keys.Interpolated[i], Rotation::toMatrix( results[i] ) );
+      mean_error += error;
+      max_error = std::max( max_error, error );
+   }
+   mean_error /= static_cast<double>(std::max( n, size_t{ 1 } ));
+
+   const double matrix_time = getBestTime( settings, [&]() {
+      for (size_t i = 0; i < n; ++i) matrices[i] = Rotation::toMatrix( from[i] );
+   } );
+   const double normalize_time = getBestTime( settings, [&]() {
+      for (size_t i = 0; i < n; ++i) results[i] = Rotation::normalize( to[i] );
+   } );
+
+   std::cout << "[Benchmark] " << std::left << std::setw( 16 ) << Rotation::getName() << std::right << std::fixed
+      << std::setprecision( 2 ) << std::setw( 8 ) << compose_time << std::setw( 8 ) << interpolate_time
+      << std::setw( 8 ) << matrix_time << std::setw( 8 ) << normalize_time << std::setprecision( 4 )
+      << std::setw( 12 ) << mean_error << std::setw( 10 ) << max_error
+      << std::scientific << std::setprecision( 2 ) << std::setw( 12 ) << compose_error << "\n";
+}
+
+void Benchmark::runRotationRepresentations(const Settings& settings)
+{
+   // Every representation starts from the same keys: consecutive keys of a random walk whose steps turn up to a
+   // quarter turn about random axes, interpolated at random t.
+   const size_t n = std::max( settings.Count, size_t{ 1 } );
+   constexpr double max_step = glm::half_pi<double>();
+   std::mt19937 generator( 20190730 );
+   std::normal_distribution<double> normal;
+   std::uniform_real_distribution<double> uniform( 0.0, 1.0 );
+   const auto get_random_axis = [&]() {
+      return normalize( glm::dvec3(normal( generator ), normal( generator ), normal( generator )) );
+   };
+   RotationKeys keys;
+   keys.From.resize( n );
+   keys.To.resize( n );
+   keys.T.resize( n );
+   keys.Interpolated.resize( n );
+   keys.Composed.resize( n );
+   glm::dquat key = angleAxis( glm::pi<double>() * uniform( generator ), get_random_axis() );
+   for (size_t i = 0; i < n; ++i) {
+      const glm::dquat next = normalize( key * angleAxis( max_step * uniform( generator ), get_random_axis() ) );
+
+      // The float keys are what the representations get, so the references start from them as well.
+      keys.From[i] = glm::dquat(glm::quat(key));
+      keys.To[i] = glm::dquat(glm::quat(next));
+      keys.T[i] = static_cast<float>(uniform( generator ));
+      keys.Interpolated[i] = slerp( keys.From[i], keys.To[i], static_cast<double>(keys.T[i]) );
+      keys.Composed[i] = keys.From[i] * keys.To[i];
+      key = next;
+   }
+
+   std::cout << "[Benchmark] " << n << " pairs of keys up to 90 degrees apart, best of " << settings.RepeatNum
+      << " runs, ns per operation, errors in degrees against slerp and the product in double precision\n"
+      << "[Benchmark] " << std::left << std::setw( 16 ) << "representation" << std::right << std::setw( 8 ) << "compose"
+      << std::setw( 8 ) << "interp" << std::setw( 8 ) << "matrix" << std::setw( 8 ) << "normal"
+      << std::setw( 12 ) << "interp mean" << std::setw( 10 ) << "max" << std::setw( 12 ) << "compose max" << "\n";
+   runRotationRepresentation<QuaternionRotation>( settings, keys );
+   runRotationRepresentation<RotationMatrixRotation>( settings, keys );
+   runRotationRepresentation<AxisAngleRotation>( settings, keys );
+   runRotationRepresentation<ExponentialMapRotation>( settings, keys );
+   runRotationRepresentation<OrientateRotation>( settings, keys );
+   runRotationRepresentation<EulerAngleRotation<EulerOrder::XYZ>>( settings, keys );
+   runRotationRepresentation<EulerAngleRotation<EulerOrder::XZY>>( settings, keys );
+   runRotationRepresentation<EulerAngleRotation<EulerOrder::YXZ>>( settings, keys );
+   runRotationRepresentation<EulerAngleRotation<EulerOrder::YZX>>( settings, keys );
+   runRotationRepresentation<EulerAngleRotation<EulerOrder::ZXY>>( settings, keys );
+   runRotationRepresentation<EulerAngleRotation<EulerOrder::ZYX>>( settings, keys );
+   runRotationRepresentation<EulerAngleRotation<EulerOrder::XYX>>( settings, keys );
+   runRotationRepresentation<EulerAngleRotation<EulerOrder::XZX>>( settings, keys );
+   runRotationRepresentation<EulerAngleRotation<EulerOrder::YXY>>( settings, keys );
+   runRotationRepresentation<EulerAngleRotation<EulerOrder::YZY>>( settings, keys );
+   runRotationRepresentation<EulerAngleRotation<EulerOrder::ZXZ>>( settings, keys );
+   runRotationRepresentation<EulerAngleRotation<EulerOrder::ZYZ>>( settings, keys );
+}
+
+void Benchmark::runTimelineEvaluation(const Settings& settings)
+{
+   // A track of random keys as the renderer records them, 2 seconds apart, sampled at 1 kHz over all of its loop.
+   constexpr size_t key_num = 1024;
+   constexpr double key_interval = 2000.0;
+   std::mt19937 generator( 20190730 );
+   std::uniform_real_distribution<float> distribution( -glm::pi<float>(), glm::pi<float>() );
+   KeyframeTrack<glm::vec3> euler_angle_track;
+   KeyframeTrack<glm::quat> quaternion_track;
+   for (size_t i = 0; i < key_num; ++i) {
+      const glm::vec3 angle(distribution( generator ), distribution( generator ), distribution( generator ));
+      euler_angle_track.addKey( static_cast<double>(i) * key_interval, angle );
+      quaternion_track.addKey( static_cast<double>(i) * key_interval, toQuat( orientate3( angle ) ) );
+   }
+   euler_angle_track.setDuration( key_num * key_interval );
+   quaternion_track.setDuration( key_num * key_interval );
+   QuaternionSpline spline;
+   spline.build( quaternion_track );
+
+   const size_t n = std::max( settings.Count, size_t{ 1 } );
+   const double time_step = quaternion_track.getDuration() / static_cast<double>(n);
+   std::vector<float> reference(7 * n), buffer(7 * n);
+   const auto get_arrays = [n](std::vector<float>& data) {
+      return TimelineEvaluator::SampleArrays{
+         { data.data(), data.data() + n, data.data() + 2 * n },
+         { data.data() + 3 * n, data.data() + 4 * n, data.data() + 5 * n, data.data() + 6 * n }
+      };
+   };
+
+   // Every sample only depends on its time, so the threads must give the very same bits as one thread does.
+   bool deterministic = true;
+   TimelineEvaluator single( 1 ), multiple;
+   std::cout << "[Benchmark] " << n << " samples of " << key_num << " keys, best of " << settings.RepeatNum
+      << " runs, ns per sample\n";
+   const QuaternionSlerp::Method selected = QuaternionSlerp::getMethod();
+   for (int i = 0; i < 3; ++i) {
+      const bool use_spline = i == 2;
+      if (!use_spline) QuaternionSlerp::setMethod( static_cast<QuaternionSlerp::Method>(i) );
+      const std::string name = use_spline ? "spline" : QuaternionSlerp::getMethodName( QuaternionSlerp::getMethod() );
+      const TimelineEvaluator::Timeline timeline{
+         &euler_angle_track, &quaternion_track, use_spline ? &spline : nullptr
+      };
+      const double single_time = getBestTime( settings, [&]() {
+         single.evaluate( timeline, 0.0, time_step, n, get_arrays( reference ) );
+      } );
+      const double multiple_time = getBestTime( settings, [&]() {
+         multiple.evaluate( timeline, 0.0, time_step, n, get_arrays( buffer ) );
+      } );
+      const bool identical = std::memcmp( reference.data(), buffer.data(), reference.size() * sizeof( float ) ) == 0;
+      deterministic &= identical;
+      std::cout << "[Benchmark] " << std::left << std::setw( 18 ) << name << std::right << std::fixed
+         << std::setprecision( 2 ) << std::setw( 8 ) << single_time << " ns x1, " << std::setw( 8 ) << multiple_time
+         << " ns x" << multiple.getThreadNum() << std::setprecision( 1 ) << "  ("
+         << 1e3 / multiple_time << "M samples/s)" << (identical ? "" : "  differs from one thread") << "\n";
+   }
+   QuaternionSlerp::setMethod( selected );
+
+   if (deterministic) std::cout << "[Benchmark] every thread count gives identical samples\n";
+   else std::cerr << "[Benchmark] the samples depend on the thread count\n";
+}
+
+void Benchmark::runTrackCompression(const Settings& settings)
+{
+   // A recording at 60 Hz of an object turning smoothly, with an angular velocity that wanders and now and then holds
+   // still, like the orientations a user captures.
+   const size_t n = std::max( settings.Count, size_t{ 2 } );
+   constexpr double key_interval = 1000.0 / 60.0;
+   std::mt19937 generator( 20190730 );
+   std::normal_distribution<float> normal;
+   std::uniform_real_distribution<float> uniform( 0.0f, 1.0f );
+   KeyframeTrack<glm::quat> track;
+   track.reserve( n );
+   glm::quat rotation(1.0f, 0.0f, 0.0f, 0.0f);
+   glm::vec3 angular_velocity(0.0f); // radians per key
+   for (size_t i = 0; i < n; ++i) {
+      track.addKey( static_cast<double>(i) * key_interval, rotation );
+      angular_velocity += 0.002f * glm::vec3(normal( generator ), normal( generator ), normal( generator ));
+      if (uniform( generator ) < 0.002f) angular_velocity = glm::vec3(0.0f);
+      const float angle = length( angular_velocity );
+      if (angle > 0.0f) rotation = normalize( rotation * angleAxis( angle, angular_velocity / angle ) );
+   }
+   track.setDuration( static_cast<double>(n) * key_interval );
+
+   std::cout << "[Benchmark] " << n << " keys at 60 Hz, compression ratio against a double time and a float4 "
+      << "quaternion per key, max error in degrees at the key times, ns per key or sample\n"
+      << "[Benchmark] " << std::right << std::setw( 10 ) << "tolerance" << std::setw( 10 ) << "kept" << std::setw( 8 )
+      << "ratio" << std::setw( 12 ) << "max error" << std::setw( 10 ) << "compress" << std::setw( 8 ) << "decode"
+      << std::setw( 10 ) << "playback" << std::setw( 8 ) << "seek" << "\n";
+   std::vector<double> times;
+   std::vector<glm::quat> quaternions;
+   std::vector<double> seek_times(n);
+   for (auto& time : seek_times) time = uniform( generator ) * track.getDuration();
+   bool within_tolerance = true;
+   for (const float tolerance : { 0.05f, 0.1f, 1.0f }) {
+      CompressedTrack compressed;
+      CompressedTrack::Statistics statistics{};
+      const double compress_time = getBestTime( settings, [&]() {
+         statistics = compressed.compress( track, glm::radians( tolerance ) );
+      } ) * static_cast<double>(settings.Count) / static_cast<double>(n);
+      const double decode_time = getBestTime( settings, [&]() { compressed.measureDecoding( times, quaternions ); } )
+         * static_cast<double>(settings.Count) / static_cast<double>(compressed.getKeyNum());
+
+      // Playback samples every original key time in order; seeks jump to random times with a cold cursor each.
+      glm::quat sum(0.0f, 0.0f, 0.0f, 0.0f);
+      const double playback_time = getBestTime( settings, [&]() {
+         CompressedTrack::Cursor cursor;
+         for (size_t i = 0; i < n; ++i) sum += compressed.evaluate( track.getTime( i ), cursor );
+      } ) * static_cast<double>(settings.Count) / static_cast<double>(n);
+      const double seek_time = getBestTime( settings, [&]() {
+         for (size_t i = 0; i < n; ++i) {
+            CompressedTrack::Cursor cursor;
+            sum += compressed.evaluate( seek_times[i], cursor );
+         }
+      } ) * static_cast<double>(settings.Count) / static_cast<double>(n);
+
+      within_tolerance &= statistics.MaxErrorInRadians <= glm::radians( tolerance ) && std::isfinite( sum.w );
+      std::cout << "[Benchmark] " << std::fixed << std::setprecision( 2 ) << std::setw( 10 ) << tolerance
+         << std::setw( 10 ) << statistics.KeptKeyNum << std::setprecision( 1 ) << std::setw( 7 )
+         << static_cast<double>(statistics.OriginalBytes) / static_cast<double>(statistics.CompressedBytes) << "x"
+         << std::setprecision( 4 ) << std::setw( 12 ) << glm::degrees( statistics.MaxErrorInRadians )
+         << std::setprecision( 2 ) << std::setw( 10 )
+         << compress_time << std::setw( 8 ) << decode_time << std::setw( 10 ) << playback_time << std::setw( 8 )
+         << seek_time << "\n";
+   }
+
+   if (within_tolerance) std::cout << "[Benchmark] every compressed track is within its tolerance\n";
+   else std::cerr << "[Benchmark] some compressed tracks exceed their tolerance\n";
+}
+
+void Benchmark::runFrustumCulling(const Settings& settings)
+{
+   // Clusters of 64 boxes, one per cell of a square grid in the xz-plane that grows with the scene, seen by four
+   // cameras at its center looking along the axes with a far plane of 100. The cameras see about the same clusters
+   // whatever the size, so grouped culling should cost little more as the scene grows while flat culling grows with it.
+   constexpr float cell_size = 16.0f;
+   constexpr float far_plane = 100.0f;
+   std::array<glm::vec4, 6> frusta[4];
+   const glm::mat4 projection = glm::perspective( glm::radians( 60.0f ), 16.0f / 9.0f, 0.1f, far_plane );
+   const glm::vec3 eye(0.0f, 2.0f, 0.0f);
+   const glm::vec3 directions[4] = {
+      glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f),
+      glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f)
+   };
+   FrustumCuller culler;
+   std::vector<float> planes;
+   for (int f = 0; f < 4; ++f) {
+      const glm::mat4 rows = transpose( projection * lookAt( eye, eye + directions[f], glm::vec3(0.0f, 1.0f, 0.0f) ) );
+      for (int i = 0; i < 3; ++i) {
+         frusta[f][2 * i] = rows[3] + rows[i];
+         frusta[f][2 * i + 1] = rows[3] - rows[i];
+      }
+      for (auto& plane : frusta[f]) {
+         plane /= length( glm::vec3(plane) );
+         for (int k = 0; k < 4; ++k) planes.push_back( plane[k] );
+      }
+      culler.addFrustum( frusta[f] );
+   }
+
+   const size_t n = std::max( settings.Count, FrustumCuller::GroupSize );
+   std::cout << "[Benchmark] scenes of 64-box clusters, 4 frusta, best of " << settings.RepeatNum
+      << " runs, microseconds per cull of every object against every frustum, and the share of objects tested one by "
+      << "one when grouped\n"
+      << "[Benchmark] " << std::right << std::setw( 10 ) << "objects" << std::setw( 10 ) << "visible" << "  "
+      << std::left << std::setw( 10 ) << "kernels" << std::right << std::setw( 12 ) << "flat" << std::setw( 12 )
+      << "grouped" << std::setw( 10 ) << "tested" << "\n";
+   std::mt19937 generator( 20190730 );
+   std::uniform_real_distribution<float> uniform( 0.0f, 1.0f );
+   bool identical = true;
+   for (size_t size = std::max( n / 64, FrustumCuller::GroupSize ); size <= n; size *= 4) {
+      const size_t cluster_num = (size + FrustumCuller::GroupSize - 1) / FrustumCuller::GroupSize;
+      const auto side = static_cast<size_t>(std::ceil( std::sqrt( static_cast<double>(cluster_num) ) ));
+      std::vector<BoundingVolume> volumes(size);
+      culler.clearObjects();
+      culler.reserve( size );
+      for (size_t i = 0; i < size; ++i) {
+         const size_t cluster = i / FrustumCuller::GroupSize;
+         const glm::vec3 cell(
+            (static_cast<float>(cluster % side) - 0.5f * static_cast<float>(side)) * cell_size,
+            0.0f,
+            (static_cast<float>(cluster / side) - 0.5f * static_cast<float>(side)) * cell_size
+         );
+         const glm::vec3 offset(uniform( generator ), 0.25f * uniform( generator ), uniform( generator ));
+         const glm::vec3 extent =
+            0.1f + 0.4f * glm::vec3(uniform( generator ), uniform( generator ), uniform( generator ));
+         volumes[i] = BoundingVolume( cell + offset * (cell_size - 1.0f), extent );
+         culler.addObject( volumes[i] );
+      }
+
+      // The reference tests every object against every plane with glm, in arrays of structures.
+      std::vector<uint> reference(size, 0);
+      size_t visible_num = 0;
+      for (size_t i = 0; i < size; ++i) {
+         for (int f = 0; f < 4; ++f) {
+            bool visible = true;
+            for (const auto& plane : frusta[f]) {
+               const glm::vec3 normal(plane);
+               const float reach = std::min( volumes[i].Radius, dot( abs( normal ), volumes[i].Extent ) );
+               visible &= dot( normal, volumes[i].Center ) + plane.w + reach >= 0.0f;
+            }
+            if (visible) reference[i] |= 1u << f;
+         }
+         if (reference[i] != 0) ++visible_num;
+      }
+
+      std::array<std::vector<float>, 3> centers, extents;
+      std::vector<float> radii(size);
+      for (int k = 0; k < 3; ++k) {
+         centers[k].resize( size );
+         extents[k].resize( size );
+         for (size_t i = 0; i < size; ++i) {
+            centers[k][i] = volumes[i].Center[k];
+            extents[k][i] = volumes[i].Extent[k];
+         }
+      }
+      for (size_t i = 0; i < size; ++i) radii[i] = volumes[i].Radius;
+      const BoundingVolumeArrays arrays{
+         { centers[0].data(), centers[1].data(), centers[2].data() },
+         { extents[0].data(), extents[1].data(), extents[2].data() },
+         radii.data()
+      };
+      std::vector<uint> flat(size);
+
+      const auto to_microseconds = static_cast<double>(settings.Count) * 1e-3;
+      const RotationKernels::InstructionSet selected = RotationKernels::getInstructionSet();
+      const int supported = static_cast<int>(RotationKernels::getSupportedInstructionSet());
+      for (int i = 0; i <= supported; ++i) {
+         const auto instruction_set = static_cast<RotationKernels::InstructionSet>(i);
+         RotationKernels::setInstructionSet( instruction_set );
+         const double flat_time = getBestTime( settings, [&]() {
+            RotationKernels::cullBoundingVolumes( arrays, planes.data(), 4, size, flat.data(), nullptr );
+         } ) * to_microseconds;
+         const double grouped_time = getBestTime( settings, [&]() { culler.cull(); } ) * to_microseconds;
+         for (size_t j = 0; j < size; ++j) identical &= flat[j] == reference[j] && culler.getVisibility( j ) == flat[j];
+
+         std::cout << "[Benchmark] " << std::right << std::setw( 10 ) << size << std::setw( 10 ) << visible_num << "  "
+            << std::left << std::setw( 10 ) << RotationKernels::getInstructionSetName( instruction_set ) << std::right
+            << std::fixed << std::setprecision( 1 ) << std::setw( 12 ) << flat_time << std::setw( 12 ) << grouped_time
+            << std::setw( 9 ) << 100.0 * static_cast<double>(culler.getTestedNum()) / static_cast<double>(size)
+            << "%\n";
+      }
+      RotationKernels::setInstructionSet( selected );
+   }
+
+   if (identical) std::cout << "[Benchmark] grouped, flat and glm culling agree on every object\n";
+   else std::cerr << "[Benchmark] grouped, flat and glm culling disagree on some objects\n";
+}
+
+void Benchmark::runSceneSystems(const Settings& settings)
+{
+   // Objects on a square grid like the ones of --objects, each swinging between two random orientations. The reference
+   // keeps every object in one structure and animates it with glm, the way an object-per-entity scene would.
+   struct Object
+   {
+      glm::vec3 Position;
+      float Scale;
+      glm::vec3 FromEulerAngle;
+      glm::vec3 ToEulerAngle;
+      glm::quat FromRotation;
+      glm::quat ToRotation;
+      float Frequency;
+      float Phase;
+      glm::vec3 EulerAngle;
+      glm::quat Rotation;
+      glm::quat EulerAngleRotation;
+   };
+
+   const size_t n = std::max( settings.Count, size_t{ 1 } );
+   const auto side = static_cast<size_t>(std::ceil( std::sqrt( static_cast<double>(n) ) ));
+   std::mt19937 generator( 20190730 );
+   std::uniform_real_distribution<float> angle( -glm::pi<float>(), glm::pi<float>() );
+   std::uniform_real_distribution<float> unit( 0.0f, 1.0f );
+   SceneStore scene;
+   scene.addMesh( BoundingVolume( glm::vec3(0.0f), glm::vec3(0.5f) ) );
+   std::vector<Object> objects(n);
+   for (size_t i = 0; i < n; ++i) {
+      SceneStore::Entity entity{};
+      entity.Mesh = 0;
+      entity.Position = { static_cast<float>(i % side), 0.0f, static_cast<float>(i / side) };
+      entity.Scale = 0.8f;
+      entity.Color = glm::vec4(1.0f);
+      entity.FromEulerAngle = { angle( generator ), angle( generator ), angle( generator ) };
+      entity.ToEulerAngle = { angle( generator ), angle( generator ), angle( generator ) };
+      entity.Period = 2.0f + 6.0f * unit( generator );
+      entity.Phase = unit( generator );
+      scene.addEntity( entity );
+
+      Object& object = objects[i];
+      object.Position = entity.Position;
+      object.Scale = entity.Scale;
+      object.FromEulerAngle = entity.FromEulerAngle;
+      object.ToEulerAngle = entity.ToEulerAngle;
+      object.FromRotation = toQuat( orientate3( entity.FromEulerAngle ) );
+      object.ToRotation = toQuat( orientate3( entity.ToEulerAngle ) );
+      object.Frequency = 1.0f / entity.Period;
+      object.Phase = entity.Phase;
+   }
+
+   constexpr double time = 12.345;
+   const double glm_time = getBestTime( settings, [&]() {
+      for (auto& object : objects) {
+         const double cycle = static_cast<double>(object.Phase) + time * object.Frequency;
+         const auto s = static_cast<float>(cycle - std::floor( cycle ));
+         float w = 1.0f - std::abs( 2.0f * s - 1.0f );
+         w = w * w * (3.0f - 2.0f * w);
+         object.EulerAngle = mix( object.FromEulerAngle, object.ToEulerAngle, w );
+         object.Rotation = slerp( object.FromRotation, object.ToRotation, w );
+         object.EulerAngleRotation = toQuat( orientate3( object.EulerAngle ) );
+      }
+   } );
+
+   // One camera above the first corner of the grid looking across it, so that culling has work on both sides.
+   const auto extent = static_cast<float>(side);
+   const glm::mat4 projection = glm::perspective( glm::radians( 60.0f ), 16.0f / 9.0f, 0.1f, 0.5f * extent );
+   const glm::mat4 rows = transpose(
+      projection * lookAt( glm::vec3(0.0f, 4.0f, 0.0f), glm::vec3(extent, 0.0f, extent), glm::vec3(0.0f, 1.0f, 0.0f) )
+   );
+   std::array<glm::vec4, 6> frustum;
+   for (int i = 0; i < 3; ++i) {
+      frustum[2 * i] = rows[3] + rows[i];
+      frustum[2 * i + 1] = rows[3] - rows[i];
+   }
+   for (auto& plane : frustum) plane /= length( glm::vec3(plane) );
+   scene.setFrustum( 0, frustum );
+   scene.cull();
+
+   bool within_tolerance = true;
+   const auto get_error = [](const glm::quat& q, const glm::quat& reference) {
+      return std::min( length( q - reference ), length( q + reference ) );
+   };
+   const auto print_result = [&](
+      const std::string& name,
+      double animate_time,
+      double transform_time,
+      double cull_time
+   ) {
+      float rotation_error = 0.0f, euler_angle_error = 0.0f;
+      for (size_t i = 0; i < n; ++i) {
+         // Keys a quarter turn apart in R4 have two shortest arcs, and rounding may pick either one.
+         if (std::abs( dot( objects[i].FromRotation, objects[i].ToRotation ) ) > 1e-6f) {
+            rotation_error = std::max(
+               rotation_error,
+               get_error( scene.getRotation( i, SceneStore::RotationForm::Quaternion ), objects[i].Rotation )
+            );
+         }
+         euler_angle_error = std::max(
+            euler_angle_error,
+            get_error( scene.getRotation( i, SceneStore::RotationForm::EulerAngle ), objects[i].EulerAngleRotation )
+         );
+      }
+      within_tolerance &= rotation_error < 1e-4f && euler_angle_error < 1e-4f;
+      const double time = animate_time + transform_time;
+      std::cout << "[Benchmark] " << std::left << std::setw( 22 ) << name << std::right << std::fixed
+         << std::setprecision( 2 ) << std::setw( 7 ) << animate_time << std::setw( 11 ) << transform_time
+         << std::setw( 9 ) << cull_time << std::setw( 7 ) << time << " ns (x" << std::setw( 6 ) << glm_time / time
+         << ")" << std::scientific << std::setprecision( 2 ) << "  quaternion error " << rotation_error
+         << "  Euler angle error " << euler_angle_error << "\n";
+   };
+   TaskScheduler scheduler;
+   std::cout << "[Benchmark] " << n << " objects, " << scene.getCulledNum( 0 ) << " of them culled, best of "
+      << settings.RepeatNum << " runs, ns per object for animate, transform and cull (speed-up of animate and "
+      << "transform over glm), max errors against glm\n";
+   std::cout << "[Benchmark] " << std::left << std::setw( 22 ) << "glm" << std::right << std::fixed
+      << std::setprecision( 2 ) << std::setw( 7 ) << glm_time << " ns\n";
+
+   const RotationKernels::InstructionSet selected = RotationKernels::getInstructionSet();
+   const int supported = static_cast<int>(RotationKernels::getSupportedInstructionSet());
+   for (int i = 0; i <= supported; ++i) {
+      const auto instruction_set = static_cast<RotationKernels::InstructionSet>(i);
+      RotationKernels::setInstructionSet( instruction_set );
+      const std::string name = RotationKernels::getInstructionSetName( instruction_set );
+      for (TaskScheduler* tasks : { static_cast<TaskScheduler*>(nullptr), &scheduler }) {
+         const double animate_time = getBestTime( settings, [&]() { scene.animate( time, tasks ); } );
+         const double transform_time = getBestTime( settings, [&]() { scene.buildTransforms( tasks ); } );
+         const double cull_time = getBestTime( settings, [&]() { scene.cull( tasks ); } );
+         print_result(
+            tasks == nullptr ? name : name + " x" + std::to_string( scheduler.getThreadNum() ) + " threads",
+            animate_time, transform_time, cull_time
+         );
+      }
+   }
+   RotationKernels::setInstructionSet( selected );
+
+   if (within_tolerance) std::cout << "[Benchmark] every scene system matches glm\n";
+   else std::cerr << "[Benchmark] some scene systems differ from glm\n";
+}
\ No newline at end of file
@@ -20,16 +20,68 @@ CameraGL::CameraGL(
    IsMoving( false ), Width( 0 ), Height( 0 ), FOV( fov ), InitFOV( fov ), NearPlane( near_plane ), FarPlane( far_plane ),
    AspectRatio( 0.0f ), ZoomSensitivity( 1.0f ), MoveSensitivity( 0.05f ), RotationSensitivity( 0.005f ),  
    InitCamPos( cam_position ), InitRefPos( view_reference_position ), InitUpVec( view_up_vector ), CamPos( cam_position ),
-   ViewMatrix( lookAt( InitCamPos, InitRefPos, InitUpVec ) ), ProjectionMatrix(glm::mat4(1.0f) )
+   ViewMatrix( lookAt( InitCamPos, InitRefPos, InitUpVec ) ), Version( 0 ), CachedFlags( 0 ),
+   ProjectionMatrix( 1.0f ), ViewProjectionMatrix( 1.0f ), InverseViewMatrix( 1.0f ), FrustumPlanes{}
 {
 }
 
 void CameraGL::updateCamera()
 {
-   const glm::mat4 inverse_view = inverse( ViewMatrix );
-   CamPos.x = inverse_view[3][0];
-   CamPos.y = inverse_view[3][1];
-   CamPos.z = inverse_view[3][2];
+   // The view matrix only rotates and translates, so the camera position is the negative translation rotated back.
+   const glm::mat3 rotation(ViewMatrix);
+   CamPos = -(transpose( rotation ) * glm::vec3(ViewMatrix[3]));
+   CachedFlags &= ProjectionCached;
+   Version++;
+}
+
+void CameraGL::invalidateProjection()
+{
+   CachedFlags &= InverseViewCached;
+   Version++;
+}
+
+const glm::mat4& CameraGL::getProjectionMatrix() const
+{
+   if ((CachedFlags & ProjectionCached) == 0) {
+      ProjectionMatrix = AspectRatio > 0.0f ?
+         glm::perspective( glm::radians( FOV ), AspectRatio, NearPlane, FarPlane ) : glm::mat4(1.0f);
+      CachedFlags |= ProjectionCached;
+   }
+   return ProjectionMatrix;
+}
+
+const glm::mat4& CameraGL::getViewProjectionMatrix() const
+{
+   if ((CachedFlags & ViewProjectionCached) == 0) {
+      ViewProjectionMatrix = getProjectionMatrix() * ViewMatrix;
+      CachedFlags |= ViewProjectionCached;
+   }
+   return ViewProjectionMatrix;
+}
+
+const glm::mat4& CameraGL::getInverseViewMatrix() const
+{
+   if ((CachedFlags & InverseViewCached) == 0) {
+      InverseViewMatrix = glm::mat4(transpose( glm::mat3(ViewMatrix) ));
+      InverseViewMatrix[3] = glm::vec4(CamPos, 1.0f);
+      CachedFlags |= InverseViewCached;
+   }
+   return InverseViewMatrix;
+}
+
+const std::array<glm::vec4, 6>& CameraGL::getFrustumPlanes() const
+{
+   if ((CachedFlags & FrustumCached) == 0) {
+      // Gribb and Hartmann: each plane is the last row of the view-projection matrix plus or minus one of the others.
+      const glm::mat4 rows = transpose( getViewProjectionMatrix() );
+      for (int i = 0; i < 3; ++i) {
+         FrustumPlanes[2 * i] = rows[3] + rows[i];
+         FrustumPlanes[2 * i + 1] = rows[3] - rows[i];
+      }
+      for (auto& plane : FrustumPlanes) plane /= length( glm::vec3(plane) );
+      CachedFlags |= FrustumCached;
+   }
+   return FrustumPlanes;
 }
 
 void CameraGL::pitch(int angle)
@@ -99,7 +151,7 @@ void CameraGL::zoomIn()
 {
    if (FOV > 0.0f) {
       FOV -= ZoomSensitivity;
-      ProjectionMatrix = glm::perspective( glm::radians( FOV ), AspectRatio, NearPlane, FarPlane );
+      invalidateProjection();
    }
 }
 
@@ -107,21 +159,22 @@ void CameraGL::zoomOut()
 {
    if (FOV < 90.0f) {
       FOV += ZoomSensitivity;
-      ProjectionMatrix = glm::perspective( glm::radians( FOV ), AspectRatio, NearPlane, FarPlane );
+      invalidateProjection();
    }
 }
 
 void CameraGL::resetCamera()
 {
-   CamPos = InitCamPos; 
+   FOV = InitFOV;
    ViewMatrix = lookAt( InitCamPos, InitRefPos, InitUpVec );
-   ProjectionMatrix = glm::perspective( glm::radians( InitFOV ), AspectRatio, NearPlane, FarPlane );
+   invalidateProjection();
+   updateCamera();
 }
 
 void CameraGL::updateWindowSize(int width, int height)
 {
    Width = width;
    Height = height;
-   AspectRatio = static_cast<float>(width) / static_cast<float>(height);
-   ProjectionMatrix = glm::perspective( glm::radians( FOV ), AspectRatio, NearPlane, FarPlane );
+   AspectRatio = height > 0 ? static_cast<float>(width) / static_cast<float>(height) : 0.0f;
+   invalidateProjection();
 }
\ No newline at end of file
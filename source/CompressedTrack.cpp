@@ -0,0 +1,341 @@
+#include "CompressedTrack.h"
+#include "KeyframeFile.h"
+
+static_assert( sizeof( std::array<uint16_t, 3> ) == 6, "Rotations are packed into 48 bits" );
+
+void CompressedTrack::clear()
+{
+   Blocks.clear();
+   TimeDeltas.clear();
+   Rotations.clear();
+   Duration = 0.0;
+   Looping = true;
+}
+
+CompressedTrack::PackedQuaternion CompressedTrack::pack(const glm::quat& quaternion)
+{
+   const std::array<float, 4> components = { quaternion.w, quaternion.x, quaternion.y, quaternion.z };
+   size_t largest = 0;
+   for (size_t i = 1; i < 4; ++i) {
+      if (std::abs( components[i] ) > std::abs( components[largest] )) largest = i;
+   }
+
+   // q and -q are the same rotation, so the largest component can be made positive and left out.
+   const float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+   uint64_t bits = largest;
+   int shift = 2;
+   for (size_t i = 0; i < 4; ++i) {
+      if (i == largest) continue;
+      const float normalized = (sign * components[i] + ComponentBound) / (2.0f * ComponentBound);
+      bits |= static_cast<uint64_t>(std::lround( std::clamp( normalized, 0.0f, 1.0f ) * ComponentMax )) << shift;
+      shift += 15;
+   }
+   return { static_cast<uint16_t>(bits), static_cast<uint16_t>(bits >> 16), static_cast<uint16_t>(bits >> 32) };
+}
+
+glm::quat CompressedTrack::unpack(const PackedQuaternion& packed)
+{
+   const uint64_t bits = packed[0] | static_cast<uint64_t>(packed[1]) << 16 | static_cast<uint64_t>(packed[2]) << 32;
+   const auto largest = static_cast<size_t>(bits & 3u);
+   std::array<float, 4> components{};
+   float sum = 0.0f;
+   int shift = 2;
+   for (size_t i = 0; i < 4; ++i) {
+      if (i == largest) continue;
+      const auto value = static_cast<float>((bits >> shift) & ComponentMax);
+      components[i] = value / static_cast<float>(ComponentMax) * 2.0f * ComponentBound - ComponentBound;
+      sum += components[i] * components[i];
+      shift += 15;
+   }
+   components[largest] = std::sqrt( std::max( 1.0f - sum, 0.0f ) );
+   return normalize( glm::quat(components[0], components[1], components[2], components[3]) );
+}
+
+float CompressedTrack::getAngle(const glm::quat& a, const glm::quat& b)
+{
+   // acos of the dot product cannot resolve angles below about 1e-3 radians in float, this form can.
+   const glm::quat c = dot( a, b ) < 0.0f ? -b : b;
+   return 2.0f * std::atan2( length( a - c ), length( a + c ) );
+}
+
+CompressedTrack::Statistics CompressedTrack::compress(
+   const KeyframeTrack<glm::quat>& track,
+   float tolerance_in_radians,
+   size_t block_size
+)
+{
+   clear();
+   const size_t n = track.getKeyNum();
+   Statistics statistics{ n, 0, n * (sizeof( double ) + sizeof( glm::quat )), 0, 0.0f };
+   if (n == 0) return statistics;
+
+   Duration = track.getDuration();
+   Looping = track.isLooping();
+   block_size = std::max( block_size, size_t{ 1 } );
+
+   // Times are rounded to ticks from the first key on, so that the rounding errors do not add up over a block.
+   const double first_time = track.getTime( 0 );
+   std::vector<int64_t> ticks(n);
+   std::vector<double> decoded_times(n);
+   for (size_t i = 0; i < n; ++i) {
+      const auto tick = static_cast<int64_t>(std::llround( (track.getTime( i ) - first_time) * TicksPerMillisecond ));
+      ticks[i] = i == 0 ? 0 : std::max( tick, ticks[i - 1] + 1 );
+      decoded_times[i] = first_time + static_cast<double>(ticks[i]) / TicksPerMillisecond;
+   }
+
+   // Keys are removed by comparing against their quantized neighbours at the decoded times, which is what evaluate
+   // does later, so that the tolerance covers the quantization as well.
+   std::vector<PackedQuaternion> packed(n);
+   std::vector<glm::quat> quantized(n);
+   for (size_t i = 0; i < n; ++i) {
+      packed[i] = pack( normalize( track.getValue( i ) ) );
+      quantized[i] = unpack( packed[i] );
+   }
+   const auto reconstructs = [&](size_t from, size_t to) {
+      const double length = decoded_times[to] - decoded_times[from];
+      for (size_t k = from + 1; k < to; ++k) {
+         const auto t = static_cast<float>((track.getTime( k ) - decoded_times[from]) / length);
+         const glm::quat q = interpolate( quantized[from], quantized[to], t );
+         if (getAngle( q, track.getValue( k ) ) > tolerance_in_radians) return false;
+      }
+      return true;
+   };
+   std::vector<size_t> kept = { 0 };
+   for (size_t to = 2; to < n; ++to) {
+      if (to - kept.back() > MaxSegmentKeyNum || !reconstructs( kept.back(), to )) kept.emplace_back( to - 1 );
+   }
+   if (n > 1) kept.emplace_back( n - 1 );
+
+   int64_t previous_tick = 0;
+   for (const size_t key : kept) {
+      const int64_t delta = ticks[key] - previous_tick;
+      if (Rotations.empty() || Rotations.size() - Blocks.back().FirstKey == block_size ||
+          delta > std::numeric_limits<uint32_t>::max()) {
+         Blocks.push_back( { decoded_times[key], Rotations.size() } );
+         TimeDeltas.emplace_back( 0 );
+      }
+      else TimeDeltas.emplace_back( static_cast<uint32_t>(delta) );
+      Rotations.emplace_back( packed[key] );
+      previous_tick = ticks[key];
+   }
+
+   Cursor cursor;
+   for (size_t i = 0; i < n; ++i) {
+      statistics.MaxErrorInRadians = std::max(
+         statistics.MaxErrorInRadians, getAngle( evaluate( track.getTime( i ), cursor ), track.getValue( i ) )
+      );
+   }
+   statistics.KeptKeyNum = Rotations.size();
+   statistics.CompressedBytes = sizeof( FileHeader ) + getByteSize();
+   return statistics;
+}
+
+void CompressedTrack::decodeBlock(size_t block, double* times, glm::quat* quaternions) const
+{
+   const auto first = static_cast<size_t>(Blocks[block].FirstKey);
+   const size_t key_num = getBlockKeyNum( block );
+   uint64_t ticks = 0;
+   for (size_t k = 0; k < key_num; ++k) {
+      ticks += TimeDeltas[first + k];
+      times[k] = Blocks[block].StartTime + static_cast<double>(ticks) / TicksPerMillisecond;
+      quaternions[k] = unpack( Rotations[first + k] );
+   }
+}
+
+void CompressedTrack::seek(size_t block, Cursor& cursor) const
+{
+   const size_t key_num = getBlockKeyNum( block );
+   cursor.Block = block;
+   cursor.Times.resize( key_num + 1 );
+   cursor.Quaternions.resize( key_num + 1 );
+   decodeBlock( block, cursor.Times.data(), cursor.Quaternions.data() );
+
+   // The last key of the track blends into the first one, one loop later.
+   const bool last = block + 1 == Blocks.size();
+   cursor.Times[key_num] = last ? Blocks[0].StartTime + Duration : Blocks[block + 1].StartTime;
+   cursor.Quaternions[key_num] = unpack( Rotations[last ? 0 : Blocks[block + 1].FirstKey] );
+}
+
+double CompressedTrack::getLocalTime(double time) const
+{
+   const double start = Blocks[0].StartTime;
+   if (!Looping || Duration <= 0.0) return std::max( time, start );
+
+   const double local_time = std::fmod( time - start, Duration );
+   return start + (local_time < 0.0 ? local_time + Duration : local_time);
+}
+
+glm::quat CompressedTrack::evaluate(double time, Cursor& cursor) const
+{
+   if (Rotations.empty()) return { 1.0f, 0.0f, 0.0f, 0.0f };
+   if (Rotations.size() == 1) return unpack( Rotations[0] );
+
+   const double local_time = getLocalTime( time );
+   size_t block = cursor.Block;
+   if (block >= Blocks.size() || local_time < Blocks[block].StartTime ||
+       (block + 1 < Blocks.size() && local_time >= Blocks[block + 1].StartTime)) {
+      const auto next = std::upper_bound(
+         Blocks.begin(), Blocks.end(), local_time,
+         [](double t, const Block& b) { return t < b.StartTime; }
+      );
+      block = next == Blocks.begin() ? 0 : static_cast<size_t>(next - Blocks.begin()) - 1;
+      seek( block, cursor );
+   }
+
+   const size_t key_num = cursor.Times.size() - 1;
+   const auto next = std::upper_bound( cursor.Times.begin(), cursor.Times.begin() + key_num, local_time );
+   const size_t key = next == cursor.Times.begin() ? 0 : static_cast<size_t>(next - cursor.Times.begin()) - 1;
+   if (!Looping && block + 1 == Blocks.size() && key + 1 == key_num) return cursor.Quaternions[key];
+
+   const double length = cursor.Times[key + 1] - cursor.Times[key];
+   const auto t = static_cast<float>(length > 0.0 ? (local_time - cursor.Times[key]) / length : 0.0);
+   return interpolate( cursor.Quaternions[key], cursor.Quaternions[key + 1], t );
+}
+
+void CompressedTrack::decompress(KeyframeTrack<glm::quat>& track) const
+{
+   track.clear();
+   track.reserve( Rotations.size() );
+   std::vector<double> times;
+   std::vector<glm::quat> quaternions;
+   for (size_t block = 0; block < Blocks.size(); ++block) {
+      times.resize( getBlockKeyNum( block ) );
+      quaternions.resize( times.size() );
+      decodeBlock( block, times.data(), quaternions.data() );
+      for (size_t k = 0; k < times.size(); ++k) track.addKey( times[k], quaternions[k] );
+   }
+   track.setDuration( Duration );
+   track.setLooping( Looping );
+}
+
+bool CompressedTrack::save(const std::string& file_path) const
+{
+   const FileHeader header{
+      FileMagic, FileVersion, Rotations.size(), Blocks.size(), Duration, Looping ? 1u : 0u, 0u
+   };
+   std::ofstream file( file_path, std::ios::binary );
+   file.write( reinterpret_cast<const char*>(&header), sizeof( header ) );
+   file.write(
+      reinterpret_cast<const char*>(Blocks.data()), static_cast<std::streamsize>(Blocks.size() * sizeof( Block ))
+   );
+   file.write(
+      reinterpret_cast<const char*>(TimeDeltas.data()),
+      static_cast<std::streamsize>(TimeDeltas.size() * sizeof( uint32_t ))
+   );
+   file.write(
+      reinterpret_cast<const char*>(Rotations.data()),
+      static_cast<std::streamsize>(Rotations.size() * sizeof( PackedQuaternion ))
+   );
+   if (!file) {
+      std::cerr << "Cannot write compressed track: " << file_path << "\n";
+      return false;
+   }
+   return true;
+}
+
+bool CompressedTrack::load(const std::string& file_path)
+{
+   clear();
+   std::ifstream file( file_path, std::ios::binary );
+   FileHeader header{};
+   file.read( reinterpret_cast<char*>(&header), sizeof( header ) );
+   if (!file || header.Magic != FileMagic || header.Version != FileVersion || header.BlockNum > header.KeyNum) {
+      std::cerr << "Not a compressed track of this version: " << file_path << "\n";
+      return false;
+   }
+
+   // The counts come from the file, so they are checked against its size before anything is allocated for them.
+   std::error_code error;
+   const uint64_t file_size = std::filesystem::file_size( file_path, error );
+   constexpr uint64_t key_size = sizeof( uint32_t ) + sizeof( PackedQuaternion );
+   const uint64_t data_size = error ? 0 : file_size - std::min<uint64_t>( file_size, sizeof( header ) );
+   if (error || header.KeyNum > data_size / key_size || header.BlockNum > data_size / sizeof( Block ) ||
+       header.KeyNum * key_size + header.BlockNum * sizeof( Block ) != data_size) {
+      std::cerr << "Compressed track is damaged or truncated: " << file_path << "\n";
+      return false;
+   }
+
+   Blocks.resize( static_cast<size_t>(header.BlockNum) );
+   TimeDeltas.resize( static_cast<size_t>(header.KeyNum) );
+   Rotations.resize( static_cast<size_t>(header.KeyNum) );
+   file.read( reinterpret_cast<char*>(Blocks.data()), static_cast<std::streamsize>(Blocks.size() * sizeof( Block )) );
+   file.read(
+      reinterpret_cast<char*>(TimeDeltas.data()), static_cast<std::streamsize>(TimeDeltas.size() * sizeof( uint32_t ))
+   );
+   file.read(
+      reinterpret_cast<char*>(Rotations.data()),
+      static_cast<std::streamsize>(Rotations.size() * sizeof( PackedQuaternion ))
+   );
+   bool valid = header.KeyNum == 0 || (!Blocks.empty() && Blocks[0].FirstKey == 0);
+   for (size_t block = 1; valid && block < Blocks.size(); ++block) {
+      valid = Blocks[block - 1].FirstKey < Blocks[block].FirstKey && Blocks[block].FirstKey < header.KeyNum;
+   }
+   if (!file || !valid) {
+      std::cerr << "Compressed track is damaged or truncated: " << file_path << "\n";
+      clear();
+      return false;
+   }
+   Duration = header.Duration;
+   Looping = header.Looping != 0;
+   return true;
+}
+
+double CompressedTrack::measureDecoding(std::vector<double>& times, std::vector<glm::quat>& quaternions) const
+{
+   times.resize( Rotations.size() );
+   quaternions.resize( Rotations.size() );
+   const auto start = std::chrono::steady_clock::now();
+   for (size_t block = 0; block < Blocks.size(); ++block) {
+      const auto first = static_cast<size_t>(Blocks[block].FirstKey);
+      decodeBlock( block, times.data() + first, quaternions.data() + first );
+   }
+   return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool CompressedTrack::compressFile(const FileSettings& settings)
+{
+   KeyframeFile file;
+   if (!file.open( settings.TrackFilePath )) return false;
+
+   KeyframeTrack<glm::vec3> euler_angle_track;
+   KeyframeTrack<glm::quat> quaternion_track;
+   file.bind( euler_angle_track, quaternion_track );
+   if (quaternion_track.empty()) {
+      std::cerr << "The track file " << settings.TrackFilePath << " has no keys\n";
+      return false;
+   }
+
+   CompressedTrack track;
+   auto start = std::chrono::steady_clock::now();
+   const Statistics statistics = track.compress(
+      quaternion_track, glm::radians( settings.ToleranceInDegrees ), settings.BlockSize
+   );
+   const double compress_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   std::cout << "[Compression] " << statistics.OriginalKeyNum << " keys, " << statistics.KeptKeyNum << " kept in "
+      << track.getBlockNum() << " blocks, " << statistics.OriginalBytes << " -> " << statistics.CompressedBytes
+      << " bytes (" << std::fixed << std::setprecision( 1 )
+      << static_cast<double>(statistics.OriginalBytes) / static_cast<double>(statistics.CompressedBytes)
+      << "x), max error " << std::setprecision( 4 ) << glm::degrees( statistics.MaxErrorInRadians )
+      << " degrees, compressed in " << std::setprecision( 2 ) << compress_seconds * 1000.0 << " ms\n";
+
+   std::vector<double> times;
+   std::vector<glm::quat> quaternions;
+   const double decode_seconds = track.measureDecoding( times, quaternions );
+   Cursor cursor;
+   glm::quat sum(0.0f, 0.0f, 0.0f, 0.0f);
+   start = std::chrono::steady_clock::now();
+   for (size_t i = 0; i < quaternion_track.getKeyNum(); ++i) {
+      sum += track.evaluate( quaternion_track.getTime( i ), cursor );
+   }
+   const double playback_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   std::cout << "[Compression] decoded " << std::setprecision( 1 )
+      << static_cast<double>(track.getKeyNum()) / std::max( decode_seconds, 1e-9 ) * 1e-6 << "M keys/s, played back "
+      << static_cast<double>(quaternion_track.getKeyNum()) / std::max( playback_seconds, 1e-9 ) * 1e-6
+      << "M samples/s" << (std::isfinite( sum.w ) ? "\n" : " (not finite)\n");
+
+   if (settings.OutputFilePath.empty()) return true;
+   CompressedTrack loaded;
+   if (!track.save( settings.OutputFilePath ) || !loaded.load( settings.OutputFilePath )) return false;
+   std::cout << "[Compression] written to " << settings.OutputFilePath << "\n";
+   return true;
+}
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include "CpuProfiler.h"
+
+CpuProfiler::ThreadBuffer::~ThreadBuffer()
+{
+   Chunk* chunk = Head.Next.load( std::memory_order_relaxed );
+   while (chunk != nullptr) {
+      Chunk* next = chunk->Next.load( std::memory_order_relaxed );
+      delete chunk;
+      chunk = next;
+   }
+}
+
+uint64_t CpuProfiler::getTimestamp()
+{
+   static const auto epoch = std::chrono::steady_clock::now();
+   const auto elapsed = std::chrono::steady_clock::now() - epoch;
+   // Zero is reserved for "not recording", so every timestamp is shifted by one nanosecond.
+   return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) + 1;
+}
+
+CpuProfiler::ThreadBuffer* CpuProfiler::getThreadBuffer()
+{
+   thread_local ThreadBuffer* buffer = nullptr;
+   if (buffer == nullptr) {
+      std::lock_guard<std::mutex> lock( RegistryMutex );
+      Registry.emplace_back( std::make_unique<ThreadBuffer>() );
+      buffer = Registry.back().get();
+      buffer->ThreadID = static_cast<uint>(Registry.size());
+   }
+   return buffer;
+}
+
+void CpuProfiler::setThreadName(const char* name)
+{
+   ThreadBuffer* buffer = getThreadBuffer();
+   std::lock_guard<std::mutex> lock( RegistryMutex );
+   buffer->ThreadName = name;
+}
+
+void CpuProfiler::record(const Event& event)
+{
+   ThreadBuffer* buffer = getThreadBuffer();
+   Chunk* chunk = buffer->Tail;
+   size_t count = chunk->Count.load( std::memory_order_relaxed );
+   if (count == Chunk::Capacity) {
+      auto* next = new Chunk();
+      chunk->Next.store( next, std::memory_order_release );
+      buffer->Tail = chunk = next;
+      count = 0;
+   }
+   chunk->Events[count] = event;
+   chunk->Count.store( count + 1, std::memory_order_release );
+}
+
+void CpuProfiler::recordZone(const char* name, uint64_t start, uint64_t end)
+{
+   Event event{};
+   event.Name = name;
+   event.Timestamp = start;
+   event.Duration = end - start;
+   event.Type = EventType::Zone;
+   record( event );
+}
+
+void CpuProfiler::recordCounter(const char* name, double value)
+{
+   if (!isEnabled()) return;
+
+   Event event{};
+   event.Name = name;
+   event.Timestamp = getTimestamp();
+   event.Value = value;
+   event.Type = EventType::Counter;
+   record( event );
+}
+
+void CpuProfiler::markFrame(const char* name)
+{
+   if (!isEnabled()) return;
+
+   Event event{};
+   event.Name = name;
+   event.Timestamp = getTimestamp();
+   event.Type = EventType::Instant;
+   record( event );
+}
+
+bool CpuProfiler::writeChromeTrace(const std::string& file_path)
+{
+   std::ofstream file( file_path );
+   if (!file.is_open()) {
+      std::cerr << "Cannot write CPU trace: " << file_path << "\n";
+      return false;
+   }
+
+   // Chrome trace timestamps are in microseconds; three decimals keep the nanosecond resolution.
+   const auto to_microseconds = [](uint64_t nanoseconds) { return static_cast<double>(nanoseconds) * 1e-3; };
+   file << std::fixed << std::setprecision( 3 ) << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+   bool first = true;
+   std::lock_guard<std::mutex> lock( RegistryMutex );
+   for (const auto& buffer : Registry) {
+      if (!first) file << ",\n";
+      first = false;
+      file << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << buffer->ThreadID << R"(,"args":{"name":")"
+         << (buffer->ThreadName.empty() ? "Thread " + std::to_string( buffer->ThreadID ) : buffer->ThreadName)
+         << "\"}}";
+
+      for (const Chunk* chunk = &buffer->Head; chunk != nullptr; chunk = chunk->Next.load( std::memory_order_acquire )) {
+         const size_t count = chunk->Count.load( std::memory_order_acquire );
+         for (size_t i = 0; i < count; ++i) {
+            const Event& event = chunk->Events[i];
+            file << ",\n{\"name\":\"" << event.Name << "\",\"pid\":1,\"tid\":" << buffer->ThreadID
+               << ",\"ts\":" << to_microseconds( event.Timestamp );
+            switch (event.Type) {
+               case EventType::Zone:
+                  file << ",\"ph\":\"X\",\"dur\":" << to_microseconds( event.Duration ) << "}";
+                  break;
+               case EventType::Counter:
+                  file << ",\"ph\":\"C\",\"args\":{\"value\":" << event.Value << "}}";
+                  break;
+               case EventType::Instant:
+                  file << ",\"ph\":\"i\",\"s\":\"g\"}";
+                  break;
+            }
+         }
+      }
+   }
+   file << "\n]}\n";
+   return true;
+}
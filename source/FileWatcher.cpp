@@ -0,0 +1,113 @@
+#include "FileWatcher.h"
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+FileWatcher::FileWatcher() : Running( false )
+#ifdef __linux__
+   , INotify( -1 )
+#endif
+{
+}
+
+FileWatcher::~FileWatcher()
+{
+   stop();
+}
+
+std::string FileWatcher::getNormalizedPath(const std::string& file_path)
+{
+   return std::filesystem::absolute( file_path ).lexically_normal().string();
+}
+
+void FileWatcher::watch(const std::string& file_path)
+{
+   std::lock_guard<std::mutex> lock( Mutex );
+   WatchedFiles.emplace( getNormalizedPath( file_path ) );
+}
+
+void FileWatcher::start()
+{
+   if (Running) return;
+
+#ifdef __linux__
+   INotify = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+   if (INotify < 0) {
+      std::cerr << "Cannot initialize inotify\n";
+      return;
+   }
+   std::set<std::filesystem::path> directories;
+   for (const auto& file : WatchedFiles) directories.emplace( std::filesystem::path(file).parent_path() );
+   for (const auto& directory : directories) {
+      const int watch = inotify_add_watch( INotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE );
+      if (watch >= 0) WatchedDirectories.emplace( watch, directory );
+   }
+#else
+   std::error_code error;
+   for (const auto& file : WatchedFiles) LastWriteTimes[file] = std::filesystem::last_write_time( file, error );
+#endif
+
+   Running = true;
+   WatchThread = std::thread( &FileWatcher::watchLoop, this );
+}
+
+void FileWatcher::stop()
+{
+   if (!Running) return;
+
+   Running = false;
+   WatchThread.join();
+#ifdef __linux__
+   close( INotify );
+   INotify = -1;
+   WatchedDirectories.clear();
+#endif
+}
+
+std::vector<std::string> FileWatcher::takeChangedFiles()
+{
+   std::lock_guard<std::mutex> lock( Mutex );
+   std::vector<std::string> changed_files(ChangedFiles.begin(), ChangedFiles.end());
+   ChangedFiles.clear();
+   return changed_files;
+}
+
+void FileWatcher::watchLoop()
+{
+   CpuProfiler::setThreadName( "File Watcher" );
+#ifdef __linux__
+   std::array<char, 4096> events{};
+   pollfd descriptor{ INotify, POLLIN, 0 };
+   while (Running) {
+      if (poll( &descriptor, 1, 200 ) <= 0) continue;
+
+      const ssize_t length = read( INotify, events.data(), events.size() );
+      for (ssize_t i = 0; i < length;) {
+         const auto* event = reinterpret_cast<const inotify_event*>(events.data() + i);
+         i += static_cast<ssize_t>(sizeof( inotify_event ) + event->len);
+         const auto directory = WatchedDirectories.find( event->wd );
+         if (event->len == 0 || directory == WatchedDirectories.end()) continue;
+
+         const std::string file = (directory->second / event->name).string();
+         std::lock_guard<std::mutex> lock( Mutex );
+         if (WatchedFiles.count( file ) != 0) ChangedFiles.emplace( file );
+      }
+   }
+#else
+   while (Running) {
+      std::this_thread::sleep_for( std::chrono::milliseconds(200) );
+      for (auto& file : LastWriteTimes) {
+         std::error_code error;
+         const auto write_time = std::filesystem::last_write_time( file.first, error );
+         if (error || write_time == file.second) continue;
+
+         file.second = write_time;
+         std::lock_guard<std::mutex> lock( Mutex );
+         ChangedFiles.emplace( file.first );
+      }
+   }
+#endif
+}
@@ -0,0 +1,192 @@
+#include "FrameCapture.h"
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+FrameCaptureGL::FrameCaptureGL() :
+   IsCapturing( false ), Width( 0 ), Height( 0 ), FrameNumber( 0 ), DroppedFrames( 0 ), NextSlot( 0 ),
+   Pipe( nullptr ), StopWorkers( false )
+{
+}
+
+FrameCaptureGL::~FrameCaptureGL()
+{
+   if (IsCapturing) stop();
+}
+
+bool FrameCaptureGL::start(int width, int height)
+{
+   if (IsCapturing) return true;
+
+   if (!Setting.PipeCommand.empty()) {
+      Setting.Format = CaptureFormat::Raw;
+      Pipe = popen( Setting.PipeCommand.c_str(), "wb" );
+      if (Pipe == nullptr) {
+         std::cerr << "Cannot open capture pipe: " << Setting.PipeCommand << "\n";
+         return false;
+      }
+   }
+   else {
+      std::error_code error;
+      std::filesystem::create_directories( Setting.DirectoryPath, error );
+      if (error) {
+         std::cerr << "Cannot create capture directory: " << Setting.DirectoryPath << "\n";
+         return false;
+      }
+   }
+
+   Width = width;
+   Height = height;
+   FrameNumber = 0;
+   DroppedFrames = 0;
+   NextSlot = 0;
+
+   const auto buffer_size = static_cast<GLsizeiptr>(getBytesPerPixel() * Width * Height);
+   const GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+   Slots.resize( std::max( Setting.BufferCount, 2 ) );
+   for (auto& slot : Slots) {
+      slot = std::make_unique<Slot>();
+      glCreateBuffers( 1, &slot->Buffer );
+      glNamedBufferStorage( slot->Buffer, buffer_size, nullptr, flags );
+      slot->MappedPixels = glMapNamedBufferRange( slot->Buffer, 0, buffer_size, flags );
+   }
+
+   // Raw frames go to a single stream, so they are written by one worker to keep them in order.
+   StopWorkers = false;
+   const int worker_num = Setting.Format == CaptureFormat::Raw ? 1 : std::max( Setting.WorkerCount, 1 );
+   for (int i = 0; i < worker_num; ++i) Workers.emplace_back( &FrameCaptureGL::encodeLoop, this );
+
+   IsCapturing = true;
+   std::cout << "Frame capture started (" << Width << "x" << Height << ")\n";
+   return true;
+}
+
+void FrameCaptureGL::stop()
+{
+   if (!IsCapturing) return;
+
+   // Shutting down is the only place that waits: pending readbacks are finished and encoded before the buffers go.
+   for (auto* slot : InFlightSlots) {
+      glClientWaitSync( slot->Fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED );
+      glDeleteSync( slot->Fence );
+      slot->Fence = nullptr;
+      slot->State = SlotState::Encoding;
+      std::lock_guard<std::mutex> lock( QueueMutex );
+      EncodingQueue.emplace_back( slot );
+   }
+   InFlightSlots.clear();
+   {
+      std::lock_guard<std::mutex> lock( QueueMutex );
+      StopWorkers = true;
+   }
+   QueueCondition.notify_all();
+   for (auto& worker : Workers) worker.join();
+   Workers.clear();
+
+   for (auto& slot : Slots) {
+      glUnmapNamedBuffer( slot->Buffer );
+      glDeleteBuffers( 1, &slot->Buffer );
+   }
+   Slots.clear();
+   if (Pipe != nullptr) {
+      pclose( Pipe );
+      Pipe = nullptr;
+   }
+
+   IsCapturing = false;
+   std::cout << "Frame capture stopped: " << FrameNumber << " frames, " << DroppedFrames << " dropped\n";
+}
+
+void FrameCaptureGL::captureFrame()
+{
+   if (!IsCapturing) return;
+
+   Slot* slot = Slots[NextSlot].get();
+   if (slot->State.load( std::memory_order_acquire ) != SlotState::Free) {
+      DroppedFrames++;
+      return;
+   }
+   NextSlot = (NextSlot + 1) % Slots.size();
+
+   const bool is_float = Setting.Format == CaptureFormat::EXR;
+   glPixelStorei( GL_PACK_ALIGNMENT, 4 );
+   glBindBuffer( GL_PIXEL_PACK_BUFFER, slot->Buffer );
+   glReadPixels( 0, 0, Width, Height, is_float ? GL_RGBA : GL_BGRA, is_float ? GL_FLOAT : GL_UNSIGNED_BYTE, nullptr );
+   glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+   slot->Fence = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+   slot->FrameNumber = FrameNumber++;
+   slot->State = SlotState::InFlight;
+   InFlightSlots.emplace_back( slot );
+}
+
+void FrameCaptureGL::poll()
+{
+   while (!InFlightSlots.empty()) {
+      Slot* slot = InFlightSlots.front();
+      const GLenum result = glClientWaitSync( slot->Fence, 0, 0 );
+      if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED) break;
+
+      glDeleteSync( slot->Fence );
+      slot->Fence = nullptr;
+      slot->State = SlotState::Encoding;
+      InFlightSlots.pop_front();
+      {
+         std::lock_guard<std::mutex> lock( QueueMutex );
+         EncodingQueue.emplace_back( slot );
+      }
+      QueueCondition.notify_one();
+   }
+}
+
+void FrameCaptureGL::encode(const Slot& slot)
+{
+   auto* pixels = static_cast<BYTE*>(slot.MappedPixels);
+   if (Setting.Format == CaptureFormat::Raw) {
+      fwrite( pixels, getBytesPerPixel(), static_cast<size_t>(Width) * Height, Pipe );
+      return;
+   }
+
+   std::ostringstream file_name;
+   file_name << Setting.DirectoryPath << "/frame_" << std::setw( 6 ) << std::setfill( '0' ) << slot.FrameNumber;
+   FIBITMAP* image = nullptr;
+   if (Setting.Format == CaptureFormat::EXR) {
+      image = FreeImage_AllocateT( FIT_RGBAF, Width, Height );
+      const size_t row_size = getBytesPerPixel() * Width;
+      for (int y = 0; y < Height; ++y) {
+         std::memcpy( FreeImage_GetScanLine( image, y ), pixels + row_size * y, row_size );
+      }
+      file_name << ".exr";
+      FreeImage_Save( FIF_EXR, image, file_name.str().c_str() );
+   }
+   else {
+      // OpenGL and FreeImage both store rows bottom-up, so the readback can be wrapped without flipping.
+      image = FreeImage_ConvertFromRawBits(
+         pixels, Width, Height, 4 * Width, 32, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK, FALSE
+      );
+      file_name << ".png";
+      FreeImage_Save( FIF_PNG, image, file_name.str().c_str(), PNG_Z_BEST_SPEED );
+   }
+   FreeImage_Unload( image );
+}
+
+void FrameCaptureGL::encodeLoop()
+{
+   CpuProfiler::setThreadName( "Frame Encoder" );
+   while (true) {
+      Slot* slot;
+      {
+         std::unique_lock<std::mutex> lock( QueueMutex );
+         QueueCondition.wait( lock, [this] { return StopWorkers || !EncodingQueue.empty(); } );
+         if (EncodingQueue.empty()) return;
+         slot = EncodingQueue.front();
+         EncodingQueue.pop_front();
+      }
+      {
+         const CpuProfiler::Zone zone( "Encode Frame" );
+         encode( *slot );
+      }
+      slot->State.store( SlotState::Free, std::memory_order_release );
+   }
+}
@@ -0,0 +1,68 @@
+#include "FrameClock.h"
+
+FrameClock::FrameClock() :
+   ClockMode( Mode::Real ), Step( 1.0 / 60.0 ), SimulatedTime( 0.0 ), FrameIndex( 0 ),
+   StartTime( std::chrono::steady_clock::now() )
+{
+}
+
+void FrameClock::setRealTime()
+{
+   ClockMode = Mode::Real;
+   StartTime = std::chrono::steady_clock::now();
+}
+
+void FrameClock::setFixedStep(double step)
+{
+   ClockMode = Mode::FixedStep;
+   Step = step > 0.0 ? step : 1.0 / 60.0;
+   SimulatedTime = 0.0;
+}
+
+void FrameClock::setScript(std::vector<double> frame_times)
+{
+   ClockMode = Mode::Scripted;
+   FrameTimes = std::move( frame_times );
+   FrameIndex = 0;
+}
+
+bool FrameClock::loadScript(const std::string& file_path)
+{
+   std::ifstream file(file_path);
+   if (!file.is_open()) {
+      std::cerr << "Cannot open the clock script " << file_path << "\n";
+      return false;
+   }
+
+   std::vector<double> frame_times;
+   double time;
+   while (file >> time) {
+      if (!frame_times.empty() && time < frame_times.back()) {
+         std::cerr << "The clock script " << file_path << " goes back in time at frame " << frame_times.size() << "\n";
+         return false;
+      }
+      frame_times.emplace_back( time );
+   }
+   setScript( std::move( frame_times ) );
+   return true;
+}
+
+double FrameClock::now() const
+{
+   switch (ClockMode) {
+      case Mode::Real:
+         return std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+      case Mode::FixedStep:
+         return SimulatedTime;
+      case Mode::Scripted:
+         if (FrameTimes.empty()) return 0.0;
+         return FrameTimes[std::min( FrameIndex, FrameTimes.size() - 1 )];
+   }
+   return 0.0;
+}
+
+void FrameClock::advanceFrame()
+{
+   if (ClockMode == Mode::FixedStep) SimulatedTime += Step;
+   else if (ClockMode == Mode::Scripted && FrameIndex < FrameTimes.size()) ++FrameIndex;
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "FrameScheduler.h"
+
+FrameScheduler::FrameScheduler(const Settings& settings) :
+   Setting( settings ), IsActive( false ), FixedStep( 1.0 / settings.SimulationRate ), Accumulator( 0.0 ),
+   LastFrameTime( 0.0 ), LastActivityTime( 0.0 ), LastReportTime( 0.0 )
+{
+}
+
+void FrameScheduler::setSettings(const Settings& settings)
+{
+   Setting = settings;
+   FixedStep = 1.0 / Setting.SimulationRate;
+   Accumulator = 0.0;
+}
+
+void FrameScheduler::start(double now)
+{
+   Accumulator = 0.0;
+   LastFrameTime = now;
+   LastActivityTime = now;
+   LastReportTime = now;
+   FrameIntervals.clear();
+}
+
+double FrameScheduler::getNextFrameTime() const
+{
+   const double frame_rate = isIdle( LastFrameTime ) ? Setting.IdleFrameRate : Setting.TargetFrameRate;
+   if (frame_rate <= 0.0) return LastFrameTime;
+   return LastFrameTime + 1.0 / frame_rate;
+}
+
+int FrameScheduler::advance(double now)
+{
+   const double interval = now - LastFrameTime;
+   LastFrameTime = now;
+   if (Setting.ReportInterval > 0.0) FrameIntervals.emplace_back( interval );
+
+   // A long stall (debugger, window drag) must not turn into a burst of catch-up steps.
+   Accumulator += std::min( interval, FixedStep * MaxStepsPerFrame );
+   int steps = 0;
+   while (Accumulator >= FixedStep) {
+      Accumulator -= FixedStep;
+      steps++;
+   }
+   return steps;
+}
+
+void FrameScheduler::reportFrameTimes(double now)
+{
+   if (Setting.ReportInterval <= 0.0 || now - LastReportTime < Setting.ReportInterval) return;
+   LastReportTime = now;
+   if (FrameIntervals.empty()) return;
+
+   double sum = 0.0, squared_sum = 0.0;
+   for (const auto& interval : FrameIntervals) {
+      sum += interval;
+      squared_sum += interval * interval;
+   }
+   const auto n = static_cast<double>(FrameIntervals.size());
+   const double mean = sum / n;
+   const double jitter = std::sqrt( std::max( squared_sum / n - mean * mean, 0.0 ) );
+   const auto p99 = FrameIntervals.begin() + static_cast<std::ptrdiff_t>(0.99 * (n - 1.0));
+   std::nth_element( FrameIntervals.begin(), p99, FrameIntervals.end() );
+   const auto minmax = std::minmax_element( FrameIntervals.begin(), FrameIntervals.end() );
+
+   std::cout << std::fixed << std::setprecision( 3 )
+      << "[Frame] " << FrameIntervals.size() << " frames, mean " << mean * 1000.0 << " ms, jitter "
+      << jitter * 1000.0 << " ms, min " << *minmax.first * 1000.0 << " ms, p99 " << *p99 * 1000.0
+      << " ms, max " << *minmax.second * 1000.0 << " ms\n";
+   FrameIntervals.clear();
+}
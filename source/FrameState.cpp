@@ -0,0 +1,50 @@
+#include "FrameState.h"
+
+FrameStateBuffer::FrameStateBuffer() : Back( 0 ), Ready( 1 ), Front( 2 ), HasNewPacket( false ), Stopped( false )
+{
+}
+
+void FrameStateBuffer::publish()
+{
+   {
+      std::lock_guard<std::mutex> lock( Mutex );
+      std::swap( Back, Ready );
+      HasNewPacket = true;
+   }
+   Condition.notify_all();
+}
+
+void FrameStateBuffer::waitUntilConsumed()
+{
+   std::unique_lock<std::mutex> lock( Mutex );
+   Condition.wait( lock, [this] { return !HasNewPacket || Stopped; } );
+}
+
+const FramePacket* FrameStateBuffer::acquireLatest()
+{
+   std::unique_lock<std::mutex> lock( Mutex );
+   Condition.wait( lock, [this] { return HasNewPacket || Stopped; } );
+   if (Stopped) return nullptr;
+
+   std::swap( Front, Ready );
+   HasNewPacket = false;
+   lock.unlock();
+   Condition.notify_all();
+   return &Slots[Front];
+}
+
+void FrameStateBuffer::stop()
+{
+   {
+      std::lock_guard<std::mutex> lock( Mutex );
+      Stopped = true;
+   }
+   Condition.notify_all();
+}
+
+void FrameStateBuffer::reset()
+{
+   std::lock_guard<std::mutex> lock( Mutex );
+   HasNewPacket = false;
+   Stopped = false;
+}
@@ -0,0 +1,155 @@
+#include "FrustumCuller.h"
+
+void FrustumCuller::VolumeArrays::push(const glm::vec3& center, const glm::vec3& extent, float radius)
+{
+   for (int k = 0; k < 3; ++k) {
+      Centers[k].push_back( center[k] );
+      Extents[k].push_back( extent[k] );
+   }
+   Radii.push_back( radius );
+}
+
+void FrustumCuller::VolumeArrays::clear()
+{
+   for (int k = 0; k < 3; ++k) {
+      Centers[k].clear();
+      Extents[k].clear();
+   }
+   Radii.clear();
+}
+
+BoundingVolumeArrays FrustumCuller::VolumeArrays::getArrays(size_t offset) const
+{
+   return {
+      { Centers[0].data() + offset, Centers[1].data() + offset, Centers[2].data() + offset },
+      { Extents[0].data() + offset, Extents[1].data() + offset, Extents[2].data() + offset },
+      Radii.data() + offset
+   };
+}
+
+int FrustumCuller::addFrustum(const std::array<glm::vec4, 6>& planes)
+{
+   assert( getFrustumNum() < MaxFrustumNum );
+
+   const int frustum = getFrustumNum();
+   Planes.resize( Planes.size() + 24 );
+   setFrustum( frustum, planes );
+   return frustum;
+}
+
+void FrustumCuller::setFrustum(int frustum, const std::array<glm::vec4, 6>& planes)
+{
+   for (int p = 0; p < 6; ++p) {
+      for (int k = 0; k < 4; ++k) Planes[(frustum * 6 + p) * 4 + k] = planes[p][k];
+   }
+}
+
+void FrustumCuller::reserve(size_t object_num)
+{
+   for (int k = 0; k < 3; ++k) {
+      Objects.Centers[k].reserve( object_num );
+      Objects.Extents[k].reserve( object_num );
+   }
+   Objects.Radii.reserve( object_num );
+   Visibility.reserve( object_num );
+}
+
+size_t FrustumCuller::addObject(const BoundingVolume& volume)
+{
+   if (!GroupOpen) {
+      GroupOffsets.push_back( getObjectNum() );
+      GroupLower = volume.Center - volume.Extent;
+      GroupUpper = volume.Center + volume.Extent;
+      GroupOpen = true;
+   }
+   else {
+      GroupLower = glm::min( GroupLower, volume.Center - volume.Extent );
+      GroupUpper = glm::max( GroupUpper, volume.Center + volume.Extent );
+   }
+   Objects.push( volume.Center, volume.Extent, volume.Radius );
+   Visibility.push_back( 0 );
+
+   const size_t object = getObjectNum() - 1;
+   if (getObjectNum() - GroupOffsets.back() == GroupSize) endGroup();
+   return object;
+}
+
+void FrustumCuller::endGroup()
+{
+   if (!GroupOpen) return;
+
+   // The box of a group holds the boxes of its objects; the sphere around it never reaches less far than the box.
+   const BoundingVolume group( (GroupLower + GroupUpper) * 0.5f, (GroupUpper - GroupLower) * 0.5f );
+   Groups.push( group.Center, group.Extent, group.Radius );
+   GroupOpen = false;
+}
+
+void FrustumCuller::clearObjects()
+{
+   Objects.clear();
+   Groups.clear();
+   Visibility.clear();
+   GroupOffsets.clear();
+   GroupOpen = false;
+}
+
+void FrustumCuller::cullGroups(size_t begin, size_t end)
+{
+   const int frustum_num = getFrustumNum();
+   for (size_t g = begin; g < end; ++g) {
+      const size_t first = GroupOffsets[g];
+      const size_t last = g + 1 < GroupOffsets.size() ? GroupOffsets[g + 1] : getObjectNum();
+      const uint group_visibility = GroupVisibility[g];
+      const uint group_containment = GroupContainment[g];
+      if ((group_visibility & ~group_containment) == 0) {
+         std::fill( Visibility.begin() + first, Visibility.begin() + last, group_visibility );
+         continue;
+      }
+
+      RotationKernels::cullBoundingVolumes(
+         Objects.getArrays( first ), Planes.data(), frustum_num, last - first, Visibility.data() + first, nullptr
+      );
+      for (size_t i = first; i < last; ++i) {
+         Visibility[i] = (Visibility[i] & group_visibility) | group_containment;
+      }
+   }
+}
+
+void FrustumCuller::cull(TaskScheduler* scheduler)
+{
+   const CpuProfiler::Zone zone( "Frustum Culling" );
+   endGroup();
+   const int frustum_num = getFrustumNum();
+   const size_t group_num = GroupOffsets.size();
+   GroupVisibility.resize( group_num );
+   GroupContainment.resize( group_num );
+   RotationKernels::cullBoundingVolumes(
+      Groups.getArrays( 0 ), Planes.data(), frustum_num, group_num, GroupVisibility.data(), GroupContainment.data()
+   );
+
+   if (scheduler != nullptr) {
+      scheduler->parallelFor(
+         0, group_num, GroupGrainSize, [this](size_t begin, size_t end, int) { cullGroups( begin, end ); }
+      );
+   }
+   else cullGroups( 0, group_num );
+
+   // Settled groups count at once, so the tally costs no more than the culling itself.
+   TestedNum = group_num;
+   CulledNums.fill( 0 );
+   for (size_t g = 0; g < group_num; ++g) {
+      const size_t first = GroupOffsets[g];
+      const size_t last = g + 1 < group_num ? GroupOffsets[g + 1] : getObjectNum();
+      if ((GroupVisibility[g] & ~GroupContainment[g]) == 0) {
+         for (int f = 0; f < frustum_num; ++f) {
+            if (((GroupVisibility[g] >> f) & 1u) == 0) CulledNums[f] += last - first;
+         }
+         continue;
+      }
+
+      TestedNum += last - first;
+      for (size_t i = first; i < last; ++i) {
+         for (int f = 0; f < frustum_num; ++f) CulledNums[f] += ((Visibility[i] >> f) & 1u) ^ 1u;
+      }
+   }
+}
\ No newline at end of file
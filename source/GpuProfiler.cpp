@@ -0,0 +1,157 @@
+#include "GpuProfiler.h"
+
+GpuProfilerGL::GpuProfilerGL(int frame_latency) :
+   Enabled( false ), FrameLatency( std::max( frame_latency, 2 ) ), FrameIndex( 0 ), DroppedFrames( 0 ),
+   ReportInterval( 0.0 ), LastReportTime( std::chrono::steady_clock::now() ), Frames( FrameLatency )
+{
+}
+
+void GpuProfilerGL::destroy()
+{
+   for (auto& frame : Frames) {
+      if (!frame.Queries.empty()) {
+         glDeleteQueries( static_cast<GLsizei>(frame.Queries.size()), frame.Queries.data() );
+      }
+      frame = FrameQueries();
+   }
+}
+
+GLuint GpuProfilerGL::getQuery(FrameQueries& frame)
+{
+   if (frame.UsedQueries == frame.Queries.size()) {
+      GLuint query = 0;
+      glCreateQueries( GL_TIMESTAMP, 1, &query );
+      frame.Queries.emplace_back( query );
+   }
+   return frame.Queries[frame.UsedQueries++];
+}
+
+void GpuProfilerGL::collect(FrameQueries& frame)
+{
+   frame.Pending = false;
+   if (frame.Scopes.empty()) return;
+
+   // Only the last query of the frame has to be checked; if it is not ready yet, the frame is dropped rather than
+   // waited for.
+   GLint available = 0;
+   glGetQueryObjectiv( frame.Queries[frame.UsedQueries - 1], GL_QUERY_RESULT_AVAILABLE, &available );
+   if (available == GL_FALSE) {
+      DroppedFrames++;
+      return;
+   }
+
+   FrameSums.assign( ScopeNames.size(), -1.0 );
+   for (const auto& scope : frame.Scopes) {
+      if (scope.EndQuery == 0) continue;
+      GLuint64 begin = 0, end = 0;
+      glGetQueryObjectui64v( frame.Queries[scope.BeginQuery], GL_QUERY_RESULT, &begin );
+      glGetQueryObjectui64v( frame.Queries[scope.EndQuery], GL_QUERY_RESULT, &end );
+      double& sum = FrameSums[scope.NameIndex];
+      sum = std::max( sum, 0.0 ) + static_cast<double>(end - begin) * 1e-6;
+   }
+   for (size_t i = 0; i < FrameSums.size(); ++i) {
+      if (FrameSums[i] < 0.0) continue;
+      Statistics& statistics = ScopeStatistics[i];
+      if (statistics.Samples.size() < SampleWindow) statistics.Samples.emplace_back( FrameSums[i] );
+      else statistics.Samples[statistics.FrameCount % SampleWindow] = FrameSums[i];
+      statistics.Max = std::max( statistics.Max, FrameSums[i] );
+      statistics.FrameCount++;
+   }
+}
+
+void GpuProfilerGL::beginFrame()
+{
+   if (!Enabled) return;
+
+   FrameQueries& frame = Frames[FrameIndex % FrameLatency];
+   if (frame.Pending) collect( frame );
+   frame.UsedQueries = 0;
+   frame.Scopes.clear();
+}
+
+void GpuProfilerGL::endFrame()
+{
+   if (!Enabled) return;
+
+   Frames[FrameIndex % FrameLatency].Pending = true;
+   FrameIndex++;
+
+   if (ReportInterval > 0.0) {
+      const auto now = std::chrono::steady_clock::now();
+      if (std::chrono::duration<double>(now - LastReportTime).count() >= ReportInterval) {
+         LastReportTime = now;
+         printStatistics( std::cout );
+      }
+   }
+}
+
+int GpuProfilerGL::beginScope(const char* name)
+{
+   if (!Enabled) return -1;
+
+   auto it = ScopeNameIndices.find( name );
+   if (it == ScopeNameIndices.end()) {
+      it = ScopeNameIndices.emplace( name, static_cast<int>(ScopeNames.size()) ).first;
+      ScopeNames.emplace_back( name );
+      ScopeStatistics.emplace_back();
+   }
+
+   FrameQueries& frame = Frames[FrameIndex % FrameLatency];
+   const uint begin_query = frame.UsedQueries;
+   glQueryCounter( getQuery( frame ), GL_TIMESTAMP );
+   frame.Scopes.push_back( { it->second, begin_query, 0 } );
+   return static_cast<int>(frame.Scopes.size() - 1);
+}
+
+void GpuProfilerGL::endScope(int scope_index)
+{
+   FrameQueries& frame = Frames[FrameIndex % FrameLatency];
+   const uint end_query = frame.UsedQueries;
+   glQueryCounter( getQuery( frame ), GL_TIMESTAMP );
+   frame.Scopes[scope_index].EndQuery = end_query;
+}
+
+void GpuProfilerGL::getSummary(const Statistics& statistics, double& mean, double& p95)
+{
+   mean = p95 = 0.0;
+   if (statistics.Samples.empty()) return;
+
+   std::vector<double> samples = statistics.Samples;
+   for (const auto& sample : samples) mean += sample;
+   mean /= static_cast<double>(samples.size());
+   const auto p95_position = samples.begin() + static_cast<std::ptrdiff_t>(0.95 * static_cast<double>(samples.size() - 1));
+   std::nth_element( samples.begin(), p95_position, samples.end() );
+   p95 = *p95_position;
+}
+
+void GpuProfilerGL::printStatistics(std::ostream& stream) const
+{
+   stream << "[GPU] " << std::setw( 20 ) << std::left << "scope" << std::right
+      << std::setw( 10 ) << "mean(ms)" << std::setw( 10 ) << "p95(ms)" << std::setw( 10 ) << "max(ms)"
+      << "   dropped frames: " << DroppedFrames << "\n";
+   for (size_t i = 0; i < ScopeNames.size(); ++i) {
+      double mean, p95;
+      getSummary( ScopeStatistics[i], mean, p95 );
+      stream << std::fixed << std::setprecision( 3 ) << "[GPU] " << std::setw( 20 ) << std::left << ScopeNames[i]
+         << std::right << std::setw( 10 ) << mean << std::setw( 10 ) << p95 << std::setw( 10 )
+         << ScopeStatistics[i].Max << "\n";
+   }
+}
+
+bool GpuProfilerGL::writeCSV(const std::string& file_path) const
+{
+   std::ofstream file( file_path );
+   if (!file.is_open()) {
+      std::cerr << "Cannot write GPU profile: " << file_path << "\n";
+      return false;
+   }
+
+   file << "scope,frames,mean_ms,p95_ms,max_ms\n";
+   for (size_t i = 0; i < ScopeNames.size(); ++i) {
+      double mean, p95;
+      getSummary( ScopeStatistics[i], mean, p95 );
+      file << ScopeNames[i] << "," << ScopeStatistics[i].FrameCount << "," << mean << "," << p95 << ","
+         << ScopeStatistics[i].Max << "\n";
+   }
+   return true;
+}
@@ -0,0 +1,154 @@
+#include "JointHierarchy.h"
+
+void JointHierarchy::build(const std::vector<Joint>& joints)
+{
+   const size_t joint_num = joints.size();
+   std::vector<int> depths(joint_num, -1);
+   std::vector<size_t> ancestors;
+   int max_depth = -1;
+   for (size_t i = 0; i < joint_num; ++i) {
+      // Walks up to the first joint whose depth is known, then assigns the depths on the way back down.
+      size_t joint = i;
+      while (depths[joint] < 0 && joints[joint].Parent >= 0) {
+         ancestors.emplace_back( joint );
+         joint = static_cast<size_t>(joints[joint].Parent);
+      }
+      if (depths[joint] < 0) depths[joint] = 0;
+      int depth = depths[joint];
+      while (!ancestors.empty()) {
+         depths[ancestors.back()] = ++depth;
+         ancestors.pop_back();
+      }
+      max_depth = std::max( max_depth, depths[i] );
+   }
+
+   // A stable counting sort by depth, so that joints of one level keep their given order.
+   LevelOffsets.assign( static_cast<size_t>(max_depth + 2), 0 );
+   for (const int depth : depths) ++LevelOffsets[depth + 1];
+   for (size_t level = 1; level < LevelOffsets.size(); ++level) LevelOffsets[level] += LevelOffsets[level - 1];
+   std::vector<size_t> next_index(LevelOffsets.begin(), LevelOffsets.end() - 1);
+   SortedIndices.resize( joint_num );
+   for (size_t i = 0; i < joint_num; ++i) SortedIndices[i] = next_index[depths[i]]++;
+
+   Parents.resize( joint_num );
+   Lengths.resize( joint_num );
+   for (auto& values : LocalTranslations) values.resize( joint_num );
+   for (size_t i = 0; i < joint_num; ++i) {
+      const size_t joint = SortedIndices[i];
+      Parents[joint] = joints[i].Parent < 0 ? -1 : static_cast<int>(SortedIndices[joints[i].Parent]);
+      Lengths[joint] = joints[i].Length;
+      for (int k = 0; k < 3; ++k) LocalTranslations[k][joint] = joints[i].Translation[k];
+   }
+   for (auto& values : LocalEulerAngles) values.assign( joint_num, 0.0f );
+   for (auto& values : WorldPositions) values.assign( joint_num, 0.0f );
+   for (auto& values : WorldRotations) values.assign( joint_num, 0.0f );
+   fillLocalRotations( glm::quat(1.0f, 0.0f, 0.0f, 0.0f) );
+}
+
+glm::vec3 JointHierarchy::getLocalTranslation(size_t joint) const
+{
+   return { LocalTranslations[0][joint], LocalTranslations[1][joint], LocalTranslations[2][joint] };
+}
+
+void JointHierarchy::setLocalRotation(size_t joint, const glm::quat& rotation)
+{
+   LocalRotations[0][joint] = rotation.w;
+   LocalRotations[1][joint] = rotation.x;
+   LocalRotations[2][joint] = rotation.y;
+   LocalRotations[3][joint] = rotation.z;
+}
+
+void JointHierarchy::setLocalEulerAngle(size_t joint, const glm::vec3& angle)
+{
+   for (int k = 0; k < 3; ++k) LocalEulerAngles[k][joint] = angle[k];
+}
+
+void JointHierarchy::fillLocalRotations(const glm::quat& rotation)
+{
+   const float components[4] = { rotation.w, rotation.x, rotation.y, rotation.z };
+   for (int k = 0; k < 4; ++k) LocalRotations[k].assign( getJointNum(), components[k] );
+}
+
+void JointHierarchy::fillLocalEulerAngles(const glm::vec3& angle)
+{
+   for (int k = 0; k < 3; ++k) std::fill( LocalEulerAngles[k].begin(), LocalEulerAngles[k].end(), angle[k] );
+}
+
+glm::quat JointHierarchy::getLocalRotation(size_t joint) const
+{
+   return { LocalRotations[0][joint], LocalRotations[1][joint], LocalRotations[2][joint], LocalRotations[3][joint] };
+}
+
+glm::quat JointHierarchy::getWorldRotation(size_t joint) const
+{
+   return { WorldRotations[0][joint], WorldRotations[1][joint], WorldRotations[2][joint], WorldRotations[3][joint] };
+}
+
+glm::vec3 JointHierarchy::getWorldPosition(size_t joint) const
+{
+   return { WorldPositions[0][joint], WorldPositions[1][joint], WorldPositions[2][joint] };
+}
+
+JointArrays JointHierarchy::getArrays()
+{
+   return {
+      Parents.data(),
+      { LocalRotations[0].data(), LocalRotations[1].data(), LocalRotations[2].data(), LocalRotations[3].data() },
+      { LocalTranslations[0].data(), LocalTranslations[1].data(), LocalTranslations[2].data() },
+      { WorldRotations[0].data(), WorldRotations[1].data(), WorldRotations[2].data(), WorldRotations[3].data() },
+      { WorldPositions[0].data(), WorldPositions[1].data(), WorldPositions[2].data() }
+   };
+}
+
+void JointHierarchy::propagate(TaskScheduler* scheduler)
+{
+   const size_t joint_num = getJointNum();
+   if (joint_num == 0) return;
+
+   const JointArrays arrays = getArrays();
+   const auto parallel_for = [scheduler](size_t begin, size_t end, const std::function<void(size_t, size_t)>& job) {
+      if (scheduler == nullptr) job( begin, end );
+      else scheduler->parallelFor( begin, end, GrainSize, [&job](size_t from, size_t to, int) { job( from, to ); } );
+   };
+
+   if (Form == RotationForm::EulerAngle) {
+      parallel_for( 0, joint_num, [this](size_t begin, size_t end) {
+         const EulerAngleArrays angles{
+            LocalEulerAngles[0].data() + begin, LocalEulerAngles[1].data() + begin, LocalEulerAngles[2].data() + begin
+         };
+         const QuaternionArrays rotations{
+            LocalRotations[0].data() + begin, LocalRotations[1].data() + begin,
+            LocalRotations[2].data() + begin, LocalRotations[3].data() + begin
+         };
+         RotationKernels::toQuaternions( angles, rotations, end - begin );
+      } );
+   }
+
+   // Roots have nothing to gather from, and every later level only reads the levels before it.
+   for (size_t joint = 0; joint < LevelOffsets[1]; ++joint) {
+      for (int k = 0; k < 4; ++k) WorldRotations[k][joint] = LocalRotations[k][joint];
+      for (int k = 0; k < 3; ++k) WorldPositions[k][joint] = LocalTranslations[k][joint];
+   }
+   for (size_t level = 1; level < getLevelNum(); ++level) {
+      parallel_for( LevelOffsets[level], LevelOffsets[level + 1], [&arrays](size_t begin, size_t end) {
+         RotationKernels::propagateJoints( arrays, begin, end );
+      } );
+   }
+}
+
+void JointHierarchy::getInstances(std::vector<glm::vec4>& instances, TaskScheduler* scheduler) const
+{
+   instances.resize( getJointNum() * 2 );
+   const auto fill = [this, &instances](size_t begin, size_t end, int) {
+      for (size_t joint = begin; joint < end; ++joint) {
+         instances[joint * 2] = glm::vec4(
+            WorldRotations[1][joint], WorldRotations[2][joint], WorldRotations[3][joint], WorldRotations[0][joint]
+         );
+         instances[joint * 2 + 1] = glm::vec4(
+            WorldPositions[0][joint], WorldPositions[1][joint], WorldPositions[2][joint], Lengths[joint]
+         );
+      }
+   };
+   if (scheduler == nullptr) fill( 0, getJointNum(), 0 );
+   else scheduler->parallelFor( 0, getJointNum(), GrainSize, fill );
+}
\ No newline at end of file
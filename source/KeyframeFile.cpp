@@ -0,0 +1,219 @@
+#include "KeyframeFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static_assert( sizeof( KeyframeFile::Record ) == 40, "Key records are written to disk as they are" );
+
+KeyframeFile::KeyframeFile() : Header{}, MappedData( nullptr ), MappedSize( 0 )
+{
+}
+
+KeyframeFile::~KeyframeFile()
+{
+   close();
+}
+
+bool KeyframeFile::writeHeader() const
+{
+   std::fstream file( FilePath, std::ios::in | std::ios::out | std::ios::binary );
+   if (!file.is_open()) return false;
+
+   file.write( reinterpret_cast<const char*>(&Header), sizeof( Header ) );
+   return static_cast<bool>(file);
+}
+
+bool KeyframeFile::map()
+{
+   std::error_code error;
+   MappedSize = static_cast<size_t>(std::filesystem::file_size( FilePath, error ));
+   // Compared by division, so a crafted key count cannot wrap the size of the records around.
+   if (error || MappedSize < sizeof( FileHeader ) ||
+       Header.KeyNum > (MappedSize - sizeof( FileHeader )) / sizeof( Record )) {
+      std::cerr << "Keyframe file is truncated: " << FilePath << "\n";
+      MappedSize = 0;
+      return false;
+   }
+
+#ifdef _WIN32
+   // The view keeps the file and the mapping object alive, so both handles can be closed right away.
+   const HANDLE file = CreateFileA(
+      FilePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+      nullptr
+   );
+   if (file == INVALID_HANDLE_VALUE) return false;
+
+   const HANDLE mapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+   CloseHandle( file );
+   if (mapping == nullptr) return false;
+
+   MappedData = static_cast<const uchar*>(MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 ));
+   CloseHandle( mapping );
+#else
+   const int file = ::open( FilePath.c_str(), O_RDONLY );
+   if (file < 0) return false;
+
+   void* data = mmap( nullptr, MappedSize, PROT_READ, MAP_SHARED, file, 0 );
+   ::close( file );
+   MappedData = data == MAP_FAILED ? nullptr : static_cast<const uchar*>(data);
+#endif
+   if (MappedData == nullptr) {
+      std::cerr << "Cannot map keyframe file: " << FilePath << "\n";
+      MappedSize = 0;
+      return false;
+   }
+
+   const uint64_t chunk_num = (Header.KeyNum + Header.ChunkSize - 1) / Header.ChunkSize;
+   if (Header.ChunkIndexOffset != 0 &&
+       (Header.ChunkIndexOffset < getRecordsEnd() || Header.ChunkIndexOffset > MappedSize ||
+        (MappedSize - Header.ChunkIndexOffset) / sizeof( double ) < chunk_num)) {
+      Header.ChunkIndexOffset = 0;
+   }
+   return true;
+}
+
+void KeyframeFile::unmap()
+{
+   if (MappedData == nullptr) return;
+
+#ifdef _WIN32
+   UnmapViewOfFile( MappedData );
+#else
+   munmap( const_cast<uchar*>(MappedData), MappedSize );
+#endif
+   MappedData = nullptr;
+   MappedSize = 0;
+}
+
+bool KeyframeFile::open(const std::string& file_path)
+{
+   close();
+   FilePath = file_path;
+   if (!std::filesystem::exists( FilePath )) {
+      Header = {};
+      Header.Magic = FileMagic;
+      Header.Version = FileVersion;
+      Header.RecordSize = sizeof( Record );
+      Header.ChunkSize = ChunkSize;
+      std::ofstream file( FilePath, std::ios::binary );
+      if (!file.is_open() || !file.write( reinterpret_cast<const char*>(&Header), sizeof( Header ) )) {
+         std::cerr << "Cannot create keyframe file: " << FilePath << "\n";
+         FilePath.clear();
+         return false;
+      }
+   }
+   else {
+      std::ifstream file( FilePath, std::ios::binary );
+      file.read( reinterpret_cast<char*>(&Header), sizeof( Header ) );
+      if (!file || Header.Magic != FileMagic || Header.Version != FileVersion ||
+         Header.RecordSize != sizeof( Record ) || Header.ChunkSize == 0) {
+         std::cerr << "Not a keyframe file of this version: " << FilePath << "\n";
+         FilePath.clear();
+         return false;
+      }
+   }
+
+   if (!map()) {
+      FilePath.clear();
+      return false;
+   }
+   std::cout << "[Keyframe] mapped " << Header.KeyNum << " keys from " << FilePath
+      << (Header.ChunkIndexOffset != 0 ? " with a chunk index\n" : "\n");
+   return true;
+}
+
+void KeyframeFile::close()
+{
+   if (!isOpen()) return;
+
+   if (Header.ChunkIndexOffset == 0 && Header.KeyNum > Header.ChunkSize && MappedData != nullptr) {
+      std::vector<double> chunk_start_times;
+      const Record* records = getRecords();
+      for (uint64_t key = 0; key < Header.KeyNum; key += Header.ChunkSize) chunk_start_times.emplace_back( records[key].Time );
+      unmap();
+
+      std::fstream file( FilePath, std::ios::in | std::ios::out | std::ios::binary );
+      file.seekp( static_cast<std::streamoff>(getRecordsEnd()) );
+      file.write(
+         reinterpret_cast<const char*>(chunk_start_times.data()),
+         static_cast<std::streamsize>(chunk_start_times.size() * sizeof( double ))
+      );
+      if (file) {
+         Header.ChunkIndexOffset = getRecordsEnd();
+         file.seekp( 0 );
+         file.write( reinterpret_cast<const char*>(&Header), sizeof( Header ) );
+      }
+   }
+   unmap();
+   FilePath.clear();
+}
+
+bool KeyframeFile::append(double time, const glm::vec3& euler_angle, const glm::quat& quaternion, double duration)
+{
+   if (!isOpen()) return false;
+
+   unmap();
+   if (Header.ChunkIndexOffset != 0) {
+      std::error_code error;
+      std::filesystem::resize_file( FilePath, getRecordsEnd(), error );
+      Header.ChunkIndexOffset = 0;
+   }
+
+   const Record record{ time, euler_angle, quaternion, 0.0f };
+   {
+      std::fstream file( FilePath, std::ios::in | std::ios::out | std::ios::binary );
+      file.seekp( static_cast<std::streamoff>(getRecordsEnd()) );
+      file.write( reinterpret_cast<const char*>(&record), sizeof( record ) );
+      if (!file) {
+         std::cerr << "Cannot append to keyframe file: " << FilePath << "\n";
+         map();
+         return false;
+      }
+   }
+   Header.KeyNum++;
+   Header.Duration = duration;
+   return writeHeader() && map();
+}
+
+bool KeyframeFile::clear()
+{
+   if (!isOpen()) return false;
+
+   unmap();
+   std::error_code error;
+   std::filesystem::resize_file( FilePath, sizeof( FileHeader ), error );
+   Header.KeyNum = 0;
+   Header.ChunkIndexOffset = 0;
+   Header.Duration = 0.0;
+   return !error && writeHeader() && map();
+}
+
+void KeyframeFile::bind(KeyframeTrack<glm::vec3>& euler_angle_track, KeyframeTrack<glm::quat>& quaternion_track) const
+{
+   if (MappedData == nullptr || Header.KeyNum == 0) {
+      euler_angle_track.clear();
+      quaternion_track.clear();
+      return;
+   }
+
+   const Record* records = getRecords();
+   const auto key_num = static_cast<size_t>(Header.KeyNum);
+   euler_angle_track.setView(
+      &records[0].Time, sizeof( Record ), &records[0].EulerAngle, sizeof( Record ), key_num, Header.Duration
+   );
+   quaternion_track.setView(
+      &records[0].Time, sizeof( Record ), &records[0].Quaternion, sizeof( Record ), key_num, Header.Duration
+   );
+   if (Header.ChunkIndexOffset != 0) {
+      const auto chunk_start_times = reinterpret_cast<const double*>(MappedData + Header.ChunkIndexOffset);
+      euler_angle_track.setSeekIndex( chunk_start_times, Header.ChunkSize );
+      quaternion_track.setSeekIndex( chunk_start_times, Header.ChunkSize );
+   }
+}
\ No newline at end of file
@@ -1,8 +1,8 @@
 #include "Object.h"
 
 ObjectGL::ObjectGL() :
-   ImageBuffer( nullptr ), VAO( 0 ), VBO( 0 ), DrawMode( 0 ), VerticesCount( 0 ),
-   DiffuseReflectionColor( 0.8f, 0.8f, 0.8f, 1.0f )
+   ImageBuffer( nullptr ), VAO( 0 ), VBO( 0 ), DrawMode( 0 ), VerticesCount( 0 ), InstancesCount( 0 ),
+   Vec4NumPerInstance( 1 ), DiffuseReflectionColor( 0.8f, 0.8f, 0.8f, 1.0f )
 {
 }
 
@@ -124,8 +124,17 @@ void ObjectGL::prepareNormal() const
    glVertexArrayAttribBinding( VAO, NormalLoc, 0 );
 }
 
+void ObjectGL::updateBounds(int floats_per_vertex)
+{
+   Bounds = BoundingVolume::fromPoints(
+      DataBuffer.data(), static_cast<size_t>(floats_per_vertex), static_cast<size_t>(VerticesCount)
+   );
+}
+
 void ObjectGL::prepareVertexBuffer(int n_bytes_per_vertex)
 {
+   updateBounds( n_bytes_per_vertex / static_cast<int>(sizeof( GLfloat )) );
+
    glCreateBuffers( 1, &VBO );
    glNamedBufferStorage( VBO, sizeof( GLfloat ) * DataBuffer.size(), DataBuffer.data(), GL_DYNAMIC_STORAGE_BIT );
 
@@ -295,6 +304,33 @@ void ObjectGL::setSquareObject(
    setObject( draw_mode, square_vertices, square_normals, square_textures, texture_file_path, is_grayscale );
 }
 
+void ObjectGL::setInstanceBuffer(int vec4_num)
+{
+   assert( VAO != 0 );
+   constexpr GLuint instance_binding = 1;
+   GLuint& buffer = CustomBuffers["Instance"];
+   if (buffer == 0) glCreateBuffers( 1, &buffer );
+   Vec4NumPerInstance = std::max( vec4_num, 1 );
+   glVertexArrayVertexBuffer( VAO, instance_binding, buffer, 0, Vec4NumPerInstance * sizeof( glm::vec4 ) );
+   glVertexArrayBindingDivisor( VAO, instance_binding, 1 );
+   for (int i = 0; i < Vec4NumPerInstance; ++i) {
+      const auto location = static_cast<GLuint>(InstanceLoc + i);
+      glVertexArrayAttribFormat( VAO, location, 4, GL_FLOAT, GL_FALSE, i * sizeof( glm::vec4 ) );
+      glEnableVertexArrayAttrib( VAO, location );
+      glVertexArrayAttribBinding( VAO, location, instance_binding );
+   }
+}
+
+void ObjectGL::updateInstanceBuffer(const std::vector<glm::vec4>& instances)
+{
+   // Respecifying the whole store orphans the previous one, so the draws still reading it do not stall the upload.
+   assert( CustomBuffers.count( "Instance" ) != 0 );
+   glNamedBufferData(
+      CustomBuffers["Instance"], sizeof( glm::vec4 ) * instances.size(), instances.data(), GL_STREAM_DRAW
+   );
+   InstancesCount = static_cast<GLsizei>(instances.size() / Vec4NumPerInstance);
+}
+
 void ObjectGL::updateDataBuffer(const std::vector<glm::vec3>& vertices, const std::vector<glm::vec3>& normals)
 {
    assert( VBO != 0 );
@@ -310,6 +346,7 @@ void ObjectGL::updateDataBuffer(const std::vector<glm::vec3>& vertices, const st
       DataBuffer.push_back( normals[i].z );
       VerticesCount++;
    }
+   updateBounds( 6 );
    glNamedBufferSubData( VBO, 0, sizeof( GLfloat ) * DataBuffer.size(), DataBuffer.data() );
 }
 
@@ -334,6 +371,7 @@ void ObjectGL::updateDataBuffer(
       DataBuffer.push_back( textures[i].y );
       VerticesCount++;
    }
+   updateBounds( 8 );
    glNamedBufferSubData( VBO, 0, sizeof( GLfloat ) * DataBuffer.size(), DataBuffer.data() );
 }
 
@@ -355,6 +393,7 @@ void ObjectGL::replaceVertices(
       DataBuffer[i * step + 2] = vertices[i].z;
       VerticesCount++;
    }
+   updateBounds( step );
    glNamedBufferSubData( VBO, 0, sizeof( GLfloat ) * VerticesCount * step, DataBuffer.data() );
 }
 
@@ -376,6 +415,7 @@ void ObjectGL::replaceVertices(
       DataBuffer[j * step + 2] = vertices[i + 2];
       VerticesCount++;
    }
+   updateBounds( step );
    glNamedBufferSubData( VBO, 0, sizeof( GLfloat ) * VerticesCount * step, DataBuffer.data() );
 }
 
@@ -386,6 +426,7 @@ bool ObjectGL::readObjectFile(
    const std::string& file_path
 ) const
 {
+   const CpuProfiler::Zone zone( "Read Object File" );
    std::ifstream file(file_path);
    if (!file.is_open()) {
       std::cout << "The object file is not correct.\n";
@@ -0,0 +1,58 @@
+#include "QuaternionSlerp.h"
+#include "RotationKernelsSimd.h"
+
+float QuaternionSlerp::getWeight(float t, float cos_minus_one)
+{
+   using Polynomial = RotationKernelsSimd::SlerpPolynomial;
+   const float t_squared = t * t;
+   float weight = 1.0f;
+   for (int i = Polynomial::TermNum - 1; i >= 0; --i) {
+      const float b = Polynomial::SquareCoefficients[i] * t_squared - Polynomial::ConstantCoefficients[i];
+      weight = b * cos_minus_one * weight + 1.0f;
+   }
+   return weight * t;
+}
+
+glm::quat QuaternionSlerp::approximate(const glm::quat& from, const glm::quat& to, float t)
+{
+   const float cosine = dot( from, to );
+   const float cos_minus_one = std::abs( cosine ) - 1.0f;
+   const float weight_to = getWeight( t, cos_minus_one );
+   return getWeight( 1.0f - t, cos_minus_one ) * from + (cosine < 0.0f ? -weight_to : weight_to) * to;
+}
+
+glm::quat QuaternionSlerp::interpolate(const glm::quat& from, const glm::quat& to, float t)
+{
+   return Selected == Method::Polynomial ? approximate( from, to, t ) : slerp( from, to, t );
+}
+
+void QuaternionSlerp::interpolate(
+   const ConstQuaternionArrays& from,
+   const ConstQuaternionArrays& to,
+   const float* t,
+   size_t count,
+   const QuaternionArrays& quaternions
+)
+{
+   if (Selected == Method::Polynomial) {
+      RotationKernels::slerpQuaternions( from, to, t, count, quaternions );
+      return;
+   }
+
+   for (size_t i = 0; i < count; ++i) {
+      const glm::quat q = slerp(
+         glm::quat(from.W[i], from.X[i], from.Y[i], from.Z[i]),
+         glm::quat(to.W[i], to.X[i], to.Y[i], to.Z[i]),
+         t[i]
+      );
+      quaternions.W[i] = q.w;
+      quaternions.X[i] = q.x;
+      quaternions.Y[i] = q.y;
+      quaternions.Z[i] = q.z;
+   }
+}
+
+const char* QuaternionSlerp::getMethodName(Method method)
+{
+   return method == Method::Polynomial ? "polynomial slerp" : "slerp";
+}
\ No newline at end of file
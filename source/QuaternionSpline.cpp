@@ -0,0 +1,151 @@
+#include "QuaternionSpline.h"
+
+void QuaternionSpline::clear()
+{
+   AngularVelocities.clear();
+   Segments.clear();
+}
+
+glm::vec3 QuaternionSpline::getLogarithm(const glm::quat& from, const glm::quat& to)
+{
+   // Half the rotation vector that turns from into to, in the frame of from and along the shorter arc.
+   glm::quat rotation = conjugate( from ) * to;
+   if (rotation.w < 0.0f) rotation = -rotation;
+
+   const glm::vec3 axis(rotation.x, rotation.y, rotation.z);
+   const float sine = length( axis );
+   return sine > 1e-7f ? axis * (std::atan2( sine, rotation.w ) / sine) : axis;
+}
+
+double QuaternionSpline::getSegmentLength(const KeyframeTrack<glm::quat>& track, size_t key)
+{
+   if (key + 1 < track.getKeyNum()) return track.getTime( key + 1 ) - track.getTime( key );
+   return track.isLooping() ? track.getTime( 0 ) + track.getDuration() - track.getTime( key ) : 0.0;
+}
+
+void QuaternionSpline::updateAngularVelocity(const KeyframeTrack<glm::quat>& track, size_t key)
+{
+   // Angular velocities are per unit of track time, so keys with uneven spacing still join without a velocity jump.
+   const size_t key_num = track.getKeyNum();
+   const size_t previous = key > 0 ? key - 1 : key_num - 1;
+   const size_t next = key + 1 < key_num ? key + 1 : 0;
+   const double previous_length = key > 0 || track.isLooping() ? getSegmentLength( track, previous ) : 0.0;
+   const double next_length = getSegmentLength( track, key );
+
+   glm::vec3 incoming(0.0f), outgoing(0.0f);
+   if (previous_length > 0.0) {
+      incoming = getLogarithm( track.getValue( previous ), track.getValue( key ) ) / static_cast<float>(previous_length);
+   }
+   if (next_length > 0.0) {
+      outgoing = getLogarithm( track.getValue( key ), track.getValue( next ) ) / static_cast<float>(next_length);
+   }
+
+   if (previous_length > 0.0 && next_length > 0.0) {
+      AngularVelocities[key] = static_cast<float>(1.0 / (previous_length + next_length)) *
+         (incoming * static_cast<float>(next_length) + outgoing * static_cast<float>(previous_length));
+   }
+   else AngularVelocities[key] = previous_length > 0.0 ? incoming : outgoing;
+}
+
+void QuaternionSpline::updateSegment(const KeyframeTrack<glm::quat>& track, size_t key)
+{
+   const size_t next = key + 1 < track.getKeyNum() ? key + 1 : 0;
+   const auto length = static_cast<float>(getSegmentLength( track, key ));
+   const glm::quat start = track.getValue( key );
+   glm::quat end = track.getValue( next );
+   if (dot( start, end ) < 0.0f) end = -end;
+
+   const auto to_vector = [](const glm::quat& q) { return glm::vec4(q.x, q.y, q.z, q.w); };
+   const glm::vec3 start_velocity = AngularVelocities[key] * length;
+   const glm::vec3 end_velocity = AngularVelocities[next] * length;
+   const glm::vec4 p0 = to_vector( start );
+   const glm::vec4 p1 = to_vector( end );
+   const glm::vec4 m0 = to_vector( start * glm::quat(0.0f, start_velocity.x, start_velocity.y, start_velocity.z) );
+   const glm::vec4 m1 = to_vector( end * glm::quat(0.0f, end_velocity.x, end_velocity.y, end_velocity.z) );
+
+   auto& coefficients = Segments[key].Coefficients;
+   coefficients[0] = p0;
+   coefficients[1] = m0;
+   coefficients[2] = 3.0f * (p1 - p0) - 2.0f * m0 - m1;
+   coefficients[3] = 2.0f * (p0 - p1) + m0 + m1;
+}
+
+void QuaternionSpline::update(const KeyframeTrack<glm::quat>& track, size_t first_changed_key)
+{
+   const size_t key_num = track.getKeyNum();
+   if (key_num == 0) {
+      clear();
+      return;
+   }
+
+   AngularVelocities.resize( key_num );
+   Segments.resize( key_num == 1 || track.isLooping() ? key_num : key_num - 1 );
+   if (key_num == 1) {
+      const glm::quat& q = track.getValue( 0 );
+      AngularVelocities[0] = glm::vec3(0.0f);
+      Segments[0].Coefficients = { glm::vec4(q.x, q.y, q.z, q.w), glm::vec4(0.0f), glm::vec4(0.0f), glm::vec4(0.0f) };
+      return;
+   }
+
+   // A key changes the velocities of its neighbours, and a velocity the segments on both sides of its key;
+   // when looping, the first key is a neighbour of the last one.
+   const size_t first_key = std::min( first_changed_key, key_num );
+   const size_t first_velocity = first_key > 0 ? first_key - 1 : 0;
+   for (size_t key = first_velocity; key < key_num; ++key) updateAngularVelocity( track, key );
+   if (first_velocity > 0) updateAngularVelocity( track, 0 );
+
+   const size_t first_segment = first_velocity > 0 ? first_velocity - 1 : 0;
+   for (size_t key = first_segment; key < Segments.size(); ++key) updateSegment( track, key );
+   if (first_segment > 0) updateSegment( track, 0 );
+}
+
+size_t QuaternionSpline::getSegment(
+   const KeyframeTrack<glm::quat>& track,
+   double time,
+   KeyframeCursor& cursor,
+   float& t
+) const
+{
+   const size_t key = track.findSegment( time, cursor, t );
+   if (key < Segments.size()) return key;
+
+   // The last key of a track that does not loop has no segment of its own; it is the end of the one before.
+   t = 1.0f;
+   return Segments.size() - 1;
+}
+
+glm::quat QuaternionSpline::evaluate(const KeyframeTrack<glm::quat>& track, double time, KeyframeCursor& cursor) const
+{
+   if (Segments.empty()) return { 1.0f, 0.0f, 0.0f, 0.0f };
+
+   float t;
+   const auto& coefficients = Segments[getSegment( track, time, cursor, t )].Coefficients;
+   const glm::vec4 p = ((coefficients[3] * t + coefficients[2]) * t + coefficients[1]) * t + coefficients[0];
+   const glm::vec4 q = p / length( p );
+   return { q.w, q.x, q.y, q.z };
+}
+
+void QuaternionSpline::evaluate(
+   const KeyframeTrack<glm::quat>& track,
+   const double* times,
+   size_t count,
+   const QuaternionArrays& quaternions
+) const
+{
+   if (Segments.empty()) {
+      std::fill( quaternions.W, quaternions.W + count, 1.0f );
+      std::fill( quaternions.X, quaternions.X + count, 0.0f );
+      std::fill( quaternions.Y, quaternions.Y + count, 0.0f );
+      std::fill( quaternions.Z, quaternions.Z + count, 0.0f );
+      return;
+   }
+
+   static_assert( sizeof( Segment ) == 16 * sizeof( float ), "Segments are read as 16 packed floats" );
+   std::vector<int> segments(count);
+   std::vector<float> t(count);
+   KeyframeCursor cursor;
+   for (size_t i = 0; i < count; ++i) segments[i] = static_cast<int>(getSegment( track, times[i], cursor, t[i] ));
+   RotationKernels::evaluateQuaternionCubics(
+      &Segments[0].Coefficients[0].x, segments.data(), t.data(), count, quaternions
+   );
+}
\ No newline at end of file
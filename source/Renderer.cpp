@@ -1,17 +1,32 @@
 #include "Renderer.h"
 
 RendererGL::RendererGL() : 
-   Window( nullptr ), FrameWidth( 1920 ), FrameHeight( 1080 ),
-   ObjectShader( std::make_unique<ShaderGL>() ), AxisObject( std::make_unique<ObjectGL>() ),
-   TeapotObject( std::make_unique<ObjectGL>() )
+   Window( nullptr ), FrameWidth( 1920 ), FrameHeight( 1080 ), FrameIndex( 0 ),
+   Scheduler( std::make_unique<FrameScheduler>() ), GpuProfiler( std::make_unique<GpuProfilerGL>() ),
+   FrameCapture( std::make_unique<FrameCaptureGL>() ), ShaderHotReload( false ),
+   ShaderWatcher( std::make_unique<FileWatcher>() ),
+   ObjectShader( std::make_unique<ShaderGL>() ), AxisShader( std::make_unique<ShaderGL>() ),
+   JointShader( std::make_unique<ShaderGL>() ), SceneShader( std::make_unique<ShaderGL>() ),
+   SkippedUniformUploadNum( 0 ), AxisObject( std::make_unique<ObjectGL>() ),
+   TeapotObject( std::make_unique<ObjectGL>() ), JointObject( std::make_unique<ObjectGL>() ), JointDepth( 0 ),
+   SceneObjectNum( 0 ), CulledCameraVersion( 0 ), Thumbnails( std::make_unique<ThumbnailAtlasGL>() ),
+   ThumbnailCameraVersion( std::numeric_limits<uint64_t>::max() ), DrawnCameraVersion( 0 ), DrawnEulerAngle( 0.0f ),
+   CaptureFailed( false )
 {
    ClickedPoint = { -1, -1 };
    MainCamera = std::make_unique<CameraGL>();
    EulerAngle = {};
-   CapturedFrameIndex = 0;
-   CapturedEulerAngles.resize( 5 );
-   CapturedQuaternions.resize( 5 );
+   EulerAngleTrack.clear();
+   QuaternionTrack.clear();
+   QuaternionCurve.clear();
+   TrackFile = std::make_unique<KeyframeFile>();
    Animator = std::make_unique<Animation>();
+   RecordingMode = false;
+   JointMode = false;
+   SceneMode = false;
+   SceneTime = 0.0;
+   PreviousSceneTime = 0.0;
+   Damage = WindowDamage;
 
    initialize();
    printOpenGLInformation();
@@ -54,11 +69,85 @@ void RendererGL::initialize()
 
    MainCamera->updateWindowSize( FrameWidth, FrameHeight );
 
+   // All permutations are only started here; they compile in parallel while the meshes are loaded in play().
+   ShaderGL::initializeCompilerCapabilities();
    const std::string shader_directory_path = std::string(CMAKE_SOURCE_DIR) + "/shaders";
-   ObjectShader->setShader(
+   ObjectShader->beginShader(
+      std::string(shader_directory_path + "/BasicPipeline.vert").c_str(),
+      std::string(shader_directory_path + "/BasicPipeline.frag").c_str(),
+      { "USE_NORMAL", "PRECOMPUTED_NORMAL_MATRIX" }
+   );
+   AxisShader->beginShader(
       std::string(shader_directory_path + "/BasicPipeline.vert").c_str(),
       std::string(shader_directory_path + "/BasicPipeline.frag").c_str()
    );
+   JointShader->beginShader(
+      std::string(shader_directory_path + "/BasicPipeline.vert").c_str(),
+      std::string(shader_directory_path + "/BasicPipeline.frag").c_str(),
+      { "USE_NORMAL", "PRECOMPUTED_NORMAL_MATRIX", "INSTANCED_JOINTS" }
+   );
+   SceneShader->beginShader(
+      std::string(shader_directory_path + "/BasicPipeline.vert").c_str(),
+      std::string(shader_directory_path + "/BasicPipeline.frag").c_str(),
+      { "USE_NORMAL", "PRECOMPUTED_NORMAL_MATRIX", "INSTANCED_JOINTS", "INSTANCED_COLORS" }
+   );
+}
+
+void RendererGL::setGpuProfiling(double report_interval, const std::string& csv_path)
+{
+   GpuProfiler->setEnabled( report_interval > 0.0 || !csv_path.empty() );
+   GpuProfiler->setReportInterval( report_interval );
+   GpuProfileFilePath = csv_path;
+}
+
+bool RendererGL::setTrackFile(const std::string& file_path)
+{
+   if (!TrackFile->open( file_path )) return false;
+
+   TrackFile->bind( EulerAngleTrack, QuaternionTrack );
+   QuaternionCurve.build( QuaternionTrack );
+   return true;
+}
+
+void RendererGL::setJointChains(int chain_num, int depth)
+{
+   assert( chain_num > 0 && depth > 0 );
+
+   // Roots on a square grid in the xz-plane, and every chain 12 units long straight up at rest.
+   const int side = static_cast<int>(std::ceil( std::sqrt( static_cast<double>(chain_num) ) ));
+   const float spacing = 24.0f / static_cast<float>(side);
+   const float length = 12.0f / static_cast<float>(depth);
+   const float offset = 0.5f * static_cast<float>(side - 1);
+   std::vector<JointHierarchy::Joint> joints;
+   joints.reserve( static_cast<size_t>(chain_num) * depth );
+   for (int chain = 0; chain < chain_num; ++chain) {
+      const glm::vec3 root(
+         (static_cast<float>(chain % side) - offset) * spacing,
+         0.0f,
+         (static_cast<float>(chain / side) - offset) * spacing
+      );
+      for (int i = 0; i < depth; ++i) {
+         const int parent = i == 0 ? -1 : static_cast<int>(joints.size()) - 1;
+         joints.push_back( { parent, i == 0 ? root : glm::vec3(0.0f, length, 0.0f), length } );
+      }
+   }
+   EulerAngleJoints.build( joints );
+   EulerAngleJoints.setRotationForm( JointHierarchy::RotationForm::EulerAngle );
+   QuaternionJoints.build( joints );
+   if (Tasks == nullptr) Tasks = std::make_unique<TaskScheduler>();
+   JointDepth = depth;
+   JointMode = true;
+   SceneMode = false;
+}
+
+void RendererGL::setSceneObjects(int object_num)
+{
+   // The objects are made in play(), once the meshes they are fitted to have been loaded.
+   assert( object_num > 0 );
+   SceneObjectNum = object_num;
+   if (Tasks == nullptr) Tasks = std::make_unique<TaskScheduler>();
+   SceneMode = true;
+   JointMode = false;
 }
 
 void RendererGL::cleanup(GLFWwindow* window)
@@ -67,35 +156,112 @@ void RendererGL::cleanup(GLFWwindow* window)
    glfwSetWindowShouldClose( renderer->Window, GLFW_TRUE );
 }
 
+void RendererGL::notifyActivity(GLFWwindow* window)
+{
+   auto renderer = reinterpret_cast<RendererGL*>(glfwGetWindowUserPointer( window ));
+   renderer->Scheduler->notifyActivity( renderer->Clock.now() );
+}
+
+uint RendererGL::getDamage() const
+{
+   uint damage = Damage;
+   if (MainCamera->getVersion() != DrawnCameraVersion) damage |= CameraDamage;
+   if (EulerAngle != DrawnEulerAngle) damage |= EulerAngleDamage;
+   if (Animator->AnimationMode || RecordingMode || isSceneShown()) damage |= AnimationDamage;
+   return damage;
+}
+
+void RendererGL::clearDamage()
+{
+   Damage = 0;
+   DrawnCameraVersion = MainCamera->getVersion();
+   DrawnEulerAngle = EulerAngle;
+}
+
 void RendererGL::captureFrame()
 {
-   if (CapturedFrameIndex < 5) {
-      CapturedEulerAngles[CapturedFrameIndex] = EulerAngle;
-      CapturedQuaternions[CapturedFrameIndex] = toQuat( orientate3( EulerAngle ) );
-      CapturedFrameIndex++;
+   // Captured keys are evenly spaced, and the track loops back from the last key to the first one.
+   const size_t key_num = EulerAngleTrack.getKeyNum();
+   const double time = key_num == 0 ? 0.0 : EulerAngleTrack.getTime( key_num - 1 ) + Animator->KeyInterval;
+   const double duration = time + Animator->KeyInterval - (key_num == 0 ? 0.0 : EulerAngleTrack.getTime( 0 ));
+   const glm::quat quaternion = QuaternionView::fromMatrix( EulerAngleView::toMatrix( EulerAngle ) );
+   if (TrackFile->isOpen()) {
+      TrackFile->append( time, EulerAngle, quaternion, duration );
+      TrackFile->bind( EulerAngleTrack, QuaternionTrack );
    }
+   else {
+      EulerAngleTrack.addKey( time, EulerAngle );
+      QuaternionTrack.addKey( time, quaternion );
+      EulerAngleTrack.setDuration( duration );
+      QuaternionTrack.setDuration( duration );
+   }
+   QuaternionCurve.update( QuaternionTrack, key_num );
+   Damage |= CaptureDamage;
 }
 
 void RendererGL::keyboard(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
    if (action != GLFW_PRESS) return;
 
+   notifyActivity( window );
    switch (key) {
       case GLFW_KEY_C:
          captureFrame();
          break;
       case GLFW_KEY_P:
-         if (!Animator->AnimationMode && CapturedFrameIndex == static_cast<int>(CapturedEulerAngles.size())) {
-            Animator->StartTiming = glfwGetTime() * 1000.0;
+         if (!Animator->AnimationMode && EulerAngleTrack.getKeyNum() >= 2) {
+            Animator->AnimationDuration = EulerAngleTrack.getDuration();
+            Animator->ElapsedTime = 0.0;
+            Animator->PreviousElapsedTime = 0.0;
+            Animator->EulerAngleCursor = {};
+            Animator->QuaternionCursor = {};
             Animator->AnimationMode = true;
          }
          break;
       case GLFW_KEY_R:
-         CapturedFrameIndex = 0;
-         CapturedEulerAngles.clear();
-         CapturedQuaternions.clear();
-         CapturedEulerAngles.resize( 5 );
-         CapturedQuaternions.resize( 5 );
+         Animator->AnimationMode = false;
+         EulerAngleTrack.clear();
+         QuaternionTrack.clear();
+         QuaternionCurve.clear();
+         if (TrackFile->isOpen()) {
+            // Only shift+r empties the track file; r leaves it as it is and captures the next keys in memory.
+            if ((mods & GLFW_MOD_SHIFT) != 0) {
+               if (TrackFile->clear()) std::cout << "[Track] the track file has been emptied\n";
+            }
+            else {
+               TrackFile->close();
+               std::cout << "[Track] the track file is kept, and new keys are no longer written to it\n";
+            }
+         }
+         Damage |= CaptureDamage;
+         break;
+      case GLFW_KEY_S:
+         Animator->SplineMode = !Animator->SplineMode;
+         std::cout << "[Animation] quaternions are interpolated with " << (Animator->SplineMode ?
+            "squad" : QuaternionSlerp::getMethodName( QuaternionSlerp::getMethod() )) << "\n";
+         break;
+      case GLFW_KEY_F:
+         QuaternionSlerp::setMethod(
+            QuaternionSlerp::getMethod() == QuaternionSlerp::Method::Exact ?
+               QuaternionSlerp::Method::Polynomial : QuaternionSlerp::Method::Exact
+         );
+         std::cout << "[Animation] slerp segments use "
+            << QuaternionSlerp::getMethodName( QuaternionSlerp::getMethod() ) << "\n";
+         break;
+      case GLFW_KEY_J:
+         JointMode = !JointMode;
+         if (JointMode) SceneMode = false;
+         Damage |= SceneDamage;
+         break;
+      case GLFW_KEY_O:
+         SceneMode = !SceneMode;
+         if (SceneMode) JointMode = false;
+         Damage |= SceneDamage;
+         break;
+      case GLFW_KEY_V:
+         // One more frame after recording stops lets the render thread end the capture.
+         RecordingMode = !RecordingMode;
+         Damage |= SceneDamage;
          break;
       case GLFW_KEY_Q:
       case GLFW_KEY_ESCAPE:
@@ -109,6 +275,7 @@ void RendererGL::keyboard(GLFWwindow* window, int key, int scancode, int action,
 void RendererGL::cursor(GLFWwindow* window, double xpos, double ypos)
 {
    if (MainCamera->getMovingState()) {
+      notifyActivity( window );
       const auto x = static_cast<int>(round( xpos ));
       const auto y = static_cast<int>(round( ypos ));
       const int dx = x - ClickedPoint.x;
@@ -132,6 +299,7 @@ void RendererGL::cursor(GLFWwindow* window, double xpos, double ypos)
 
 void RendererGL::mouse(GLFWwindow* window, int button, int action, int mods)
 {
+   notifyActivity( window );
    if (button == GLFW_MOUSE_BUTTON_LEFT) {
       const bool moving_state = action == GLFW_PRESS;
       if (moving_state) {
@@ -147,8 +315,20 @@ void RendererGL::mouse(GLFWwindow* window, int button, int action, int mods)
 
 void RendererGL::reshape(GLFWwindow* window, int width, int height)
 {
+   notifyActivity( window );
    MainCamera->updateWindowSize( width, height );
-   glViewport( 0, 0, width, height );
+
+   auto renderer = reinterpret_cast<RendererGL*>(glfwGetWindowUserPointer( window ));
+   renderer->FrameWidth = width;
+   renderer->FrameHeight = height;
+   Damage |= WindowDamage;
+}
+
+void RendererGL::refresh(GLFWwindow* window)
+{
+   // The window system has lost the contents, e.g. of an uncovered window, so they have to be drawn again.
+   notifyActivity( window );
+   Damage |= WindowDamage;
 }
 
 void RendererGL::registerCallbacks() const
@@ -158,6 +338,7 @@ void RendererGL::registerCallbacks() const
    glfwSetCursorPosCallback( Window, cursor );
    glfwSetMouseButtonCallback( Window, mouse );
    glfwSetFramebufferSizeCallback( Window, reshape );
+   glfwSetWindowRefreshCallback( Window, refresh );
 }
 
 void RendererGL::setAxisObject() const
@@ -170,6 +351,7 @@ void RendererGL::setAxisObject() const
 
 void RendererGL::setTeapotObject() const
 {
+   const CpuProfiler::Zone zone( "Load Teapot" );
    std::vector<glm::vec3> teapot_vertices, teapot_normals;
    std::vector<glm::vec2> teapot_textures;
    const std::string sample_directory_path = std::string(CMAKE_SOURCE_DIR) + "/samples";
@@ -183,113 +365,495 @@ void RendererGL::setTeapotObject() const
    TeapotObject->setObject( GL_TRIANGLES, teapot_vertices, teapot_normals );
 }
 
-void RendererGL::drawAxisObject(float scale_factor) const
+void RendererGL::getBoxObject(
+   std::vector<glm::vec3>& vertices,
+   std::vector<glm::vec3>& normals,
+   const glm::vec3& center,
+   const glm::vec3& extent
+)
 {
-   glUseProgram( ObjectShader->getShaderProgram() );
+   const std::array<glm::vec2, 6> corners = {
+      glm::vec2(-1.0f, -1.0f), glm::vec2(1.0f, -1.0f), glm::vec2(1.0f, 1.0f),
+      glm::vec2(-1.0f, -1.0f), glm::vec2(1.0f, 1.0f), glm::vec2(-1.0f, 1.0f)
+   };
+   for (int axis = 0; axis < 3; ++axis) {
+      for (const float sign : { -1.0f, 1.0f }) {
+         glm::vec3 normal(0.0f), u(0.0f), v(0.0f);
+         normal[axis] = sign;
+         u[(axis + 1) % 3] = 1.0f;
+         v[(axis + 2) % 3] = sign;
+         for (const auto& corner : corners) {
+            vertices.emplace_back( center + extent * (normal + corner.x * u + corner.y * v) );
+            normals.emplace_back( normal );
+         }
+      }
+   }
+}
+
+void RendererGL::setJointObject() const
+{
+   // A box around the unit bone from the joint along y, which the instanced shader scales by the bone length.
+   std::vector<glm::vec3> joint_vertices, joint_normals;
+   getBoxObject( joint_vertices, joint_normals, glm::vec3(0.0f, 0.5f, 0.0f), glm::vec3(0.1f, 0.5f, 0.1f) );
+   JointObject->setObject( GL_TRIANGLES, joint_vertices, joint_normals );
+   JointObject->setInstanceBuffer( 2 );
+}
+
+void RendererGL::buildScene()
+{
+   Scene.clear();
+   SceneMeshes.clear();
+   if (SceneObjectNum == 0) return;
+
+   const CpuProfiler::Zone zone( "Build Scene" );
+   std::vector<glm::vec3> vertices, normals;
+   std::vector<glm::vec2> textures;
+   auto teapot = std::make_unique<ObjectGL>();
+   const std::string sample_directory_path = std::string(CMAKE_SOURCE_DIR) + "/samples";
+   teapot->readObjectFile( vertices, normals, textures, std::string(sample_directory_path + "/teapot.obj") );
+   teapot->setObject( GL_TRIANGLES, vertices, normals );
+   SceneMeshes.emplace_back( std::move( teapot ) );
+   vertices.clear();
+   normals.clear();
+   auto box = std::make_unique<ObjectGL>();
+   getBoxObject( vertices, normals, glm::vec3(0.0f), glm::vec3(0.5f) );
+   box->setObject( GL_TRIANGLES, vertices, normals );
+   SceneMeshes.emplace_back( std::move( box ) );
+   for (const auto& mesh : SceneMeshes) {
+      mesh->setInstanceBuffer( 3 );
+      Scene.addMesh( mesh->getBounds() );
+   }
+
+   // Objects on a square grid in the xz-plane over the same 24 units as the joint chains, added row by row so that
+   // neighbors are culled together, and each swinging between two random orientations of its own.
+   const int side = static_cast<int>(std::ceil( std::sqrt( static_cast<double>(SceneObjectNum) ) ));
+   const float spacing = 24.0f / static_cast<float>(side);
+   const float offset = 0.5f * static_cast<float>(side - 1);
+   std::mt19937 generator( 0 );
+   std::uniform_real_distribution<float> angle( -glm::pi<float>(), glm::pi<float>() );
+   std::uniform_real_distribution<float> unit( 0.0f, 1.0f );
+   for (int i = 0; i < SceneObjectNum; ++i) {
+      SceneStore::Entity entity{};
+      entity.Mesh = i % SceneMeshNum;
+      const BoundingVolume& bounds = SceneMeshes[entity.Mesh]->getBounds();
+      entity.Position = {
+         (static_cast<float>(i % side) - offset) * spacing,
+         0.0f,
+         (static_cast<float>(i / side) - offset) * spacing
+      };
+      entity.Scale = 0.4f * spacing / (glm::length( bounds.Center ) + bounds.Radius);
+      entity.Color = glm::vec4(0.2f) + 0.8f * glm::vec4(unit( generator ), unit( generator ), unit( generator ), 1.0f);
+      entity.FromEulerAngle = { angle( generator ), angle( generator ), angle( generator ) };
+      entity.ToEulerAngle = { angle( generator ), angle( generator ), angle( generator ) };
+      entity.Period = 2.0f + 6.0f * unit( generator );
+      entity.Phase = unit( generator );
+      Scene.addEntity( entity );
+   }
+}
+
+void RendererGL::drawAxisObject(const FramePacket& frame, float scale_factor) const
+{
+   const GpuProfilerGL::Scope scope( GpuProfiler.get(), "Axes" );
+   glUseProgram( AxisShader->getShaderProgram() );
    glLineWidth( 5.0f );
 
    const glm::mat4 scale_matrix = scale(glm::mat4(1.0f), glm::vec3(scale_factor) );
    glm::mat4 to_world = scale_matrix;
-   ObjectShader->transferBasicTransformationUniforms( to_world, MainCamera.get(), { 1.0f, 0.0f, 0.0f, 1.0f } );
+   AxisShader->transferBasicTransformationUniforms(
+      to_world, frame.ViewMatrix, frame.ProjectionMatrix, frame.ViewProjectionMatrix, frame.CameraVersion,
+      { 1.0f, 0.0f, 0.0f, 1.0f }
+   );
 
    glBindVertexArray( AxisObject->getVAO() );
    glDrawArrays( AxisObject->getDrawMode(), 0, AxisObject->getVertexNum() );
 
    to_world = scale_matrix * glm::rotate( glm::mat4(1.0f), glm::radians( 90.0f ), glm::vec3(0.0f, 0.0f, 1.0f) );
-   ObjectShader->transferBasicTransformationUniforms( to_world, MainCamera.get(), { 0.0f, 1.0f, 0.0f, 1.0f } );
+   AxisShader->transferBasicTransformationUniforms(
+      to_world, frame.ViewMatrix, frame.ProjectionMatrix, frame.ViewProjectionMatrix, frame.CameraVersion,
+      { 0.0f, 1.0f, 0.0f, 1.0f }
+   );
    glDrawArrays( AxisObject->getDrawMode(), 0, AxisObject->getVertexNum() );
 
    to_world = scale_matrix * glm::rotate( glm::mat4(1.0f), glm::radians( -90.0f ), glm::vec3(0.0f, 1.0f, 0.0f) );
-   ObjectShader->transferBasicTransformationUniforms( to_world, MainCamera.get(), { 0.0f, 0.0f, 1.0f, 1.0f } );
+   AxisShader->transferBasicTransformationUniforms(
+      to_world, frame.ViewMatrix, frame.ProjectionMatrix, frame.ViewProjectionMatrix, frame.CameraVersion,
+      { 0.0f, 0.0f, 1.0f, 1.0f }
+   );
    glDrawArrays( AxisObject->getDrawMode(), 0, AxisObject->getVertexNum() );
 
    glLineWidth( 1.0f );
 }
 
-void RendererGL::drawTeapotObject(const glm::mat4& to_world) const
+void RendererGL::drawTeapotObject(const FramePacket& frame, const glm::mat4& to_world) const
 {
    glUseProgram( ObjectShader->getShaderProgram() );
-   ObjectShader->transferBasicTransformationUniforms( to_world, MainCamera.get(), TeapotObject->getColor() );
+   ObjectShader->transferBasicTransformationUniforms(
+      to_world, frame.ViewMatrix, frame.ProjectionMatrix, frame.ViewProjectionMatrix, frame.CameraVersion,
+      TeapotObject->getColor()
+   );
    glBindVertexArray( TeapotObject->getVAO() );
    glDrawArrays( TeapotObject->getDrawMode(), 0, TeapotObject->getVertexNum() );
 }
 
-void RendererGL::displayEulerAngleMode()
+void RendererGL::drawJointObjects(const FramePacket& frame, const std::vector<glm::vec4>& instances) const
 {
+   if (instances.empty()) return;
+
+   glUseProgram( JointShader->getShaderProgram() );
+   JointShader->transferBasicTransformationUniforms(
+      glm::mat4(1.0f), frame.ViewMatrix, frame.ProjectionMatrix, frame.ViewProjectionMatrix, frame.CameraVersion,
+      JointObject->getColor()
+   );
+   JointObject->updateInstanceBuffer( instances );
+   glBindVertexArray( JointObject->getVAO() );
+   glDrawArraysInstanced(
+      JointObject->getDrawMode(), 0, JointObject->getVertexNum(), JointObject->getInstanceNum()
+   );
+}
+
+void RendererGL::drawSceneObjects(
+   const FramePacket& frame,
+   const std::vector<std::vector<glm::vec4>>& instances
+) const
+{
+   glUseProgram( SceneShader->getShaderProgram() );
+   SceneShader->transferBasicTransformationUniforms(
+      glm::mat4(1.0f), frame.ViewMatrix, frame.ProjectionMatrix, frame.ViewProjectionMatrix, frame.CameraVersion,
+      glm::vec4(1.0f)
+   );
+   for (size_t mesh = 0; mesh < instances.size() && mesh < SceneMeshes.size(); ++mesh) {
+      if (instances[mesh].empty()) continue;
+
+      ObjectGL* object = SceneMeshes[mesh].get();
+      object->updateInstanceBuffer( instances[mesh] );
+      glBindVertexArray( object->getVAO() );
+      glDrawArraysInstanced( object->getDrawMode(), 0, object->getVertexNum(), object->getInstanceNum() );
+   }
+}
+
+void RendererGL::displayEulerAngleMode(const FramePacket& frame)
+{
+   const GpuProfilerGL::Scope scope( GpuProfiler.get(), "Euler View" );
    glViewport( 0, 216, 980, 864 );
-   drawAxisObject( 15.0f );
+   drawAxisObject( frame, 15.0f );
 
-   if (Animator->AnimationMode) {
-      const uint curr = Animator->CurrentFrameIndex;
-      const uint next = (Animator->CurrentFrameIndex + 1) % CapturedEulerAngles.size();
-      const auto t = static_cast<float>(Animator->ElapsedTime / Animator->TimePerSection - curr);
-      EulerAngle = (1 - t) * CapturedEulerAngles[curr] + t * CapturedEulerAngles[next];
+   if (frame.JointMode) {
+      JointObject->setDiffuseReflectionColor( { 0.0f, 0.47f, 0.75f, 1.0f } );
+      drawJointObjects( frame, frame.EulerAngleJoints );
+      return;
    }
-   TeapotObject->setDiffuseReflectionColor( { 0.0f, 0.47f, 0.75f, 1.0f } );
+   if (frame.SceneMode) {
+      drawSceneObjects( frame, frame.EulerAngleObjects );
+      return;
+   }
+   if ((frame.VisibleTeapots & 1u) == 0) return;
 
-   const glm::mat4 to_world = orientate4( EulerAngle );
-   drawTeapotObject( to_world );
+   TeapotObject->setDiffuseReflectionColor( { 0.0f, 0.47f, 0.75f, 1.0f } );
+   drawTeapotObject( frame, frame.EulerAngleWorld );
 }
 
-void RendererGL::displayQuaternionMode()
+void RendererGL::displayQuaternionMode(const FramePacket& frame)
 {
+   const GpuProfilerGL::Scope scope( GpuProfiler.get(), "Quaternion View" );
    glViewport( 980, 216, 980, 864 );
-   drawAxisObject( 15.0f );
+   drawAxisObject( frame, 15.0f );
 
-   glm::mat4 to_world;
-   if (Animator->AnimationMode) {
-      const uint curr = Animator->CurrentFrameIndex;
-      const uint next = (Animator->CurrentFrameIndex + 1) % CapturedQuaternions.size();
-      const auto t = static_cast<float>(Animator->ElapsedTime / Animator->TimePerSection - curr);
-      to_world = toMat4( slerp( CapturedQuaternions[curr], CapturedQuaternions[next], t ) );
+   if (frame.JointMode) {
+      JointObject->setDiffuseReflectionColor( { 1.0f, 0.37f, 0.37f, 1.0f } );
+      drawJointObjects( frame, frame.QuaternionJoints );
+      return;
+   }
+   if (frame.SceneMode) {
+      drawSceneObjects( frame, frame.QuaternionObjects );
+      return;
    }
-   else to_world = orientate4( EulerAngle );
+   if ((frame.VisibleTeapots & 2u) == 0) return;
 
    TeapotObject->setDiffuseReflectionColor( { 1.0f, 0.37f, 0.37f, 1.0f } );
-   drawTeapotObject( to_world );
+   drawTeapotObject( frame, frame.QuaternionWorld );
 }
 
-void RendererGL::displayCapturedFrames()
+void RendererGL::drawThumbnail(const FramePacket& frame, const ThumbnailContent& content) const
 {
-   for (int i = 0; i < 5; ++i) {
-      glViewport( 384 * i, 0, 384, 216 );
-      drawAxisObject( 15.0f );
+   drawAxisObject( frame, 15.0f );
+   if (!content.TeapotDrawn) return;
 
-      if (i < CapturedFrameIndex) {
-         if (Animator->AnimationMode && i == Animator->CurrentFrameIndex) {
-            TeapotObject->setDiffuseReflectionColor( { 1.0f, 0.7f, 0.0f, 1.0f } );
-         }
-         else TeapotObject->setDiffuseReflectionColor( { 0.7f, 0.7f, 1.0f, 1.0f } );
+   if (content.Highlighted) TeapotObject->setDiffuseReflectionColor( { 1.0f, 0.7f, 0.0f, 1.0f } );
+   else TeapotObject->setDiffuseReflectionColor( { 0.7f, 0.7f, 1.0f, 1.0f } );
+   drawTeapotObject( frame, content.ToWorld );
+}
+
+void RendererGL::displayCapturedFrames(const FramePacket& frame)
+{
+   const GpuProfilerGL::Scope scope( GpuProfiler.get(), "Thumbnails" );
+   const bool cached = Thumbnails->isCreated();
+   if (cached && ThumbnailCameraVersion != frame.CameraVersion) {
+      Thumbnails->invalidateAll();
+      ThumbnailCameraVersion = frame.CameraVersion;
+   }
 
-         glm::mat4 to_world = toMat4( CapturedQuaternions[i] );
-         drawTeapotObject( to_world );
+   int redrawn_num = 0;
+   for (int i = 0; i < static_cast<int>(ThumbnailNum); ++i) {
+      ThumbnailContent content;
+      content.TeapotDrawn = i < static_cast<int>(frame.CapturedFrameTransforms.size()) &&
+         ((frame.VisibleTeapots >> (2 + i)) & 1u) != 0;
+      content.Highlighted = i == frame.HighlightedFrameIndex;
+      if (content.TeapotDrawn) content.ToWorld = frame.CapturedFrameTransforms[i];
+      if (!(content == ThumbnailContents[i])) {
+         ThumbnailContents[i] = content;
+         if (cached) Thumbnails->invalidate( i );
       }
+      if (cached && Thumbnails->isValid( i )) continue;
+
+      if (cached) Thumbnails->beginSlot( i );
+      else glViewport( ThumbnailWidth * i, 0, ThumbnailWidth, ThumbnailHeight );
+      drawThumbnail( frame, content );
+      ++redrawn_num;
    }
+   CpuProfiler::recordCounter( "Redrawn Thumbnails", redrawn_num );
+   if (!cached) return;
+
+   if (redrawn_num > 0) Thumbnails->endSlots();
+   Thumbnails->blit( 0, 0 );
 }
 
-void RendererGL::render()
+void RendererGL::render(const FramePacket& frame)
 {
-   glClear( OPENGL_COLOR_BUFFER_BIT | OPENGL_DEPTH_BUFFER_BIT );
-
-   displayEulerAngleMode();
-   displayQuaternionMode();
-   displayCapturedFrames();
+   const CpuProfiler::Zone zone( "Render" );
+   GpuProfiler->beginFrame();
+   {
+      const GpuProfilerGL::Scope scope( GpuProfiler.get(), "Frame" );
+      glClear( OPENGL_COLOR_BUFFER_BIT | OPENGL_DEPTH_BUFFER_BIT );
+
+      displayEulerAngleMode( frame );
+      displayQuaternionMode( frame );
+      displayCapturedFrames( frame );
+
+      glBindVertexArray( 0 );
+      glUseProgram( 0 );
+   }
+   GpuProfiler->endFrame();
 
-   glBindVertexArray( 0 );
-   glUseProgram( 0 );
+   const uint64_t skipped = ObjectShader->getSkippedUniformUploadNum() + AxisShader->getSkippedUniformUploadNum() +
+      JointShader->getSkippedUniformUploadNum() + SceneShader->getSkippedUniformUploadNum();
+   CpuProfiler::recordCounter( "Skipped Uniform Uploads", static_cast<double>(skipped - SkippedUniformUploadNum) );
+   SkippedUniformUploadNum = skipped;
+   CpuProfiler::recordCounter( "Culled Objects", static_cast<double>(frame.CulledObjectNum) );
 }
 
-void RendererGL::update()
+void RendererGL::update(double step)
 {
+   const CpuProfiler::Zone zone( "Update" );
    if (Animator->AnimationMode) {
-      const double now = glfwGetTime() * 1000.0;
-      Animator->ElapsedTime = now - Animator->StartTiming;
+      Animator->PreviousElapsedTime = Animator->ElapsedTime;
+      Animator->ElapsedTime += step;
       if (Animator->ElapsedTime >= Animator->AnimationDuration) {
-         Animator->StartTiming = now;
-         Animator->ElapsedTime = 0.0;
+         Animator->ElapsedTime -= Animator->AnimationDuration;
+         Animator->PreviousElapsedTime -= Animator->AnimationDuration;
+      }
+   }
+   if (SceneMode) {
+      PreviousSceneTime = SceneTime;
+      SceneTime += step;
+   }
+}
+
+void RendererGL::cullObjects(FramePacket& frame)
+{
+   // Every view looks through the main camera, so its frusta only change with the camera. The scene keeps frusta of
+   // its own for the two main views, the only ones its objects are drawn in.
+   if (Culler.getFrustumNum() == 0 || CulledCameraVersion != frame.CameraVersion) {
+      const std::array<glm::vec4, 6>& planes = MainCamera->getFrustumPlanes();
+      for (int view = 0; view < ViewFrustumNum; ++view) {
+         if (view < Culler.getFrustumNum()) Culler.setFrustum( view, planes );
+         else Culler.addFrustum( planes );
+      }
+      Scene.setFrustum( EulerAngleFrustum, planes );
+      Scene.setFrustum( QuaternionFrustum, planes );
+   }
+   CulledCameraVersion = frame.CameraVersion;
+
+   // Teapots make one group; the joints come sorted by depth, so each run of a level holds neighboring chains.
+   Culler.clearObjects();
+   const BoundingVolume& teapot = TeapotObject->getBounds();
+   Culler.addObject( teapot.transform( frame.EulerAngleWorld ) );
+   Culler.addObject( teapot.transform( frame.QuaternionWorld ) );
+   for (const auto& to_world : frame.CapturedFrameTransforms) Culler.addObject( teapot.transform( to_world ) );
+   Culler.endGroup();
+   const BoundingVolume& joint = JointObject->getBounds();
+   const auto add_joints = [this, &joint](const std::vector<glm::vec4>& instances) {
+      const size_t first = Culler.getObjectNum();
+      for (size_t i = 0; i < instances.size(); i += 2) {
+         const glm::vec4& r = instances[i];
+         const glm::vec4& p = instances[i + 1];
+         Culler.addObject( joint.transform( glm::quat(r.w, r.x, r.y, r.z), glm::vec3(p), p.w ) );
+      }
+      Culler.endGroup();
+      return first;
+   };
+   const size_t euler_angle_joints = add_joints( frame.EulerAngleJoints );
+   const size_t quaternion_joints = add_joints( frame.QuaternionJoints );
+   Culler.cull( Tasks.get() );
+
+   size_t drawn_num = 0, visible_num = 0;
+   frame.VisibleTeapots = 0;
+   const auto show_teapot = [&](size_t object, int frustum, uint bit) {
+      ++drawn_num;
+      if (!Culler.isVisible( object, frustum )) return;
+      frame.VisibleTeapots |= bit;
+      ++visible_num;
+   };
+   if (!frame.JointMode && !frame.SceneMode) {
+      show_teapot( 0, EulerAngleFrustum, 1u );
+      show_teapot( 1, QuaternionFrustum, 2u );
+   }
+   for (size_t i = 0; i < frame.CapturedFrameTransforms.size(); ++i) {
+      show_teapot( 2 + i, ThumbnailFrustum, 1u << (2 + i) );
+   }
+   const auto compact_joints = [&](std::vector<glm::vec4>& instances, size_t first, int frustum) {
+      size_t kept = 0;
+      for (size_t i = 0; i < instances.size() / 2; ++i) {
+         if (!Culler.isVisible( first + i, frustum )) continue;
+         instances[kept * 2] = instances[i * 2];
+         instances[kept * 2 + 1] = instances[i * 2 + 1];
+         ++kept;
+      }
+      drawn_num += instances.size() / 2;
+      visible_num += kept;
+      instances.resize( kept * 2 );
+   };
+   compact_joints( frame.EulerAngleJoints, euler_angle_joints, EulerAngleFrustum );
+   compact_joints( frame.QuaternionJoints, quaternion_joints, QuaternionFrustum );
+   frame.CulledObjectNum = drawn_num - visible_num;
+
+   if (frame.SceneMode) {
+      Scene.cull( Tasks.get() );
+      Scene.getInstances( SceneStore::RotationForm::EulerAngle, EulerAngleFrustum, frame.EulerAngleObjects );
+      Scene.getInstances( SceneStore::RotationForm::Quaternion, QuaternionFrustum, frame.QuaternionObjects );
+      frame.CulledObjectNum += Scene.getCulledNum( EulerAngleFrustum ) + Scene.getCulledNum( QuaternionFrustum );
+   }
+}
+
+void RendererGL::prepareFramePacket(FramePacket& frame, double interpolation_factor)
+{
+   const CpuProfiler::Zone zone( "Prepare Frame Packet" );
+   frame.FrameIndex = FrameIndex++;
+   frame.IsRecording = RecordingMode;
+   frame.FrameSize = { FrameWidth, FrameHeight };
+   frame.ViewMatrix = MainCamera->getViewMatrix();
+   frame.ProjectionMatrix = MainCamera->getProjectionMatrix();
+   frame.ViewProjectionMatrix = MainCamera->getViewProjectionMatrix();
+   frame.CameraVersion = MainCamera->getVersion();
+
+   // The thumbnails show the latest captured keys, or the ones around the current key during the animation.
+   const size_t key_num = QuaternionTrack.getKeyNum();
+   const size_t thumbnail_num = std::min( key_num, ThumbnailNum );
+   size_t first_thumbnail = key_num - thumbnail_num;
+   if (Animator->AnimationMode) {
+      const double elapsed_time = Animator->PreviousElapsedTime +
+         interpolation_factor * (Animator->ElapsedTime - Animator->PreviousElapsedTime);
+      EulerAngle = evaluateTrack<EulerAngleView>( EulerAngleTrack, elapsed_time, Animator->EulerAngleCursor );
+      frame.Quaternion = Animator->SplineMode ?
+         QuaternionCurve.evaluate( QuaternionTrack, elapsed_time, Animator->QuaternionCursor ) :
+         evaluateTrack<QuaternionView>( QuaternionTrack, elapsed_time, Animator->QuaternionCursor );
+
+      const size_t current_key = Animator->QuaternionCursor.Key;
+      first_thumbnail = std::min( current_key - std::min( current_key, ThumbnailNum / 2 ), first_thumbnail );
+      frame.HighlightedFrameIndex = static_cast<int>(current_key - first_thumbnail);
+   }
+   else {
+      frame.Quaternion = QuaternionView::fromMatrix( EulerAngleView::toMatrix( EulerAngle ) );
+      frame.HighlightedFrameIndex = -1;
+   }
+   frame.EulerAngle = EulerAngle;
+   frame.EulerAngleWorld = getWorldMatrix<EulerAngleView>( EulerAngle );
+   frame.QuaternionWorld = getWorldMatrix<QuaternionView>( frame.Quaternion );
+
+   frame.CapturedFrameTransforms.clear();
+   for (size_t i = first_thumbnail; i < first_thumbnail + thumbnail_num; ++i) {
+      frame.CapturedFrameTransforms.emplace_back( getWorldMatrix<QuaternionView>( QuaternionTrack.getValue( i ) ) );
+   }
+
+   frame.EulerAngleJoints.clear();
+   frame.QuaternionJoints.clear();
+   if (JointMode && JointDepth > 0) {
+      // Every joint turns by 1/depth of the rotation, interpolated from the identity in either representation,
+      // so the chains curl up towards it, and the Euler ones differently near gimbal lock.
+      const CpuProfiler::Zone joint_zone( "Propagate Joints" );
+      const float share = 1.0f / static_cast<float>(JointDepth);
+      EulerAngleJoints.fillLocalEulerAngles(
+         EulerAngleView::interpolate( EulerAngleView::identity(), EulerAngle, share )
+      );
+      EulerAngleJoints.propagate( Tasks.get() );
+      EulerAngleJoints.getInstances( frame.EulerAngleJoints, Tasks.get() );
+      QuaternionJoints.fillLocalRotations(
+         QuaternionView::interpolate( QuaternionView::identity(), frame.Quaternion, share )
+      );
+      QuaternionJoints.propagate( Tasks.get() );
+      QuaternionJoints.getInstances( frame.QuaternionJoints, Tasks.get() );
+   }
+   frame.JointMode = JointMode && JointDepth > 0;
+
+   frame.SceneMode = isSceneShown();
+   if (frame.SceneMode) {
+      const double scene_time = PreviousSceneTime + interpolation_factor * (SceneTime - PreviousSceneTime);
+      Scene.animate( scene_time * 0.001, Tasks.get() );
+      Scene.buildTransforms( Tasks.get() );
+   }
+   cullObjects( frame );
+}
+
+bool RendererGL::reloadChangedShaders() const
+{
+   bool replaced = false;
+   const std::vector<std::string> changed_files = ShaderWatcher->takeChangedFiles();
+   for (const auto& shader : { ObjectShader.get(), AxisShader.get(), JointShader.get(), SceneShader.get() }) {
+      const bool changed = std::any_of(
+         changed_files.begin(), changed_files.end(),
+         [shader](const std::string& file) { return shader->usesShaderFile( file ); }
+      );
+      if (changed) shader->reload();
+      if (shader->updatePendingProgram()) {
+         std::cout << "[Shader] reloaded program is now in use\n";
+         replaced = true;
       }
-      Animator->CurrentFrameIndex = static_cast<int>(std::floor( Animator->ElapsedTime / Animator->TimePerSection ));
    }
+   return replaced;
+}
+
+void RendererGL::renderLoop()
+{
+   CpuProfiler::setThreadName( "Render" );
+   glfwMakeContextCurrent( Window );
+   glfwSwapInterval( Scheduler->getSettings().VSync ? 1 : 0 );
+   // A recording that failed to start is not retried by the frames still in flight.
+   bool capture_failed = false;
+   while (true) {
+      const FramePacket* frame = FrameState.acquireLatest();
+      if (frame == nullptr) break;
+
+      if (ShaderHotReload && reloadChangedShaders()) Thumbnails->invalidateAll();
+      render( *frame );
+      if (frame->IsRecording != FrameCapture->isCapturing()) {
+         if (!frame->IsRecording) FrameCapture->stop();
+         else if (!capture_failed && !FrameCapture->start( frame->FrameSize.x, frame->FrameSize.y )) {
+            capture_failed = true;
+            CaptureFailed = true;
+         }
+      }
+      if (!frame->IsRecording) capture_failed = false;
+      FrameCapture->captureFrame();
+      FrameCapture->poll();
+      {
+         const CpuProfiler::Zone zone( "Swap Buffers" );
+         glfwSwapBuffers( Window );
+      }
+      CpuProfiler::markFrame( "Render Frame" );
+   }
+   FrameCapture->stop();
+   Thumbnails->destroy();
+   GpuProfiler->destroy();
+   glfwMakeContextCurrent( nullptr );
 }
 
 void RendererGL::play()
@@ -298,14 +862,80 @@ void RendererGL::play()
 
    setAxisObject();
    setTeapotObject();
-   ObjectShader->setBasicTransformationUniforms();
+   setJointObject();
+   buildScene();
+   ObjectShader->waitForPendingProgram();
+   AxisShader->waitForPendingProgram();
+   JointShader->waitForPendingProgram();
+   SceneShader->waitForPendingProgram();
+   Thumbnails->create( ThumbnailWidth, ThumbnailHeight, static_cast<int>(ThumbnailNum) );
+
+   // The render thread owns the context from here on; the main thread only polls events and simulates,
+   // so frame N+1 is being prepared while frame N is submitted and swapped.
+   if (ShaderHotReload) {
+      // Hot reload watches the shader directory, so from now on sources have to come from disk.
+      ShaderPreprocessor::setUseEmbeddedSources( false );
+      for (const auto& file : ObjectShader->getShaderFiles()) ShaderWatcher->watch( file );
+      for (const auto& file : AxisShader->getShaderFiles()) ShaderWatcher->watch( file );
+      for (const auto& file : JointShader->getShaderFiles()) ShaderWatcher->watch( file );
+      for (const auto& file : SceneShader->getShaderFiles()) ShaderWatcher->watch( file );
+      ShaderWatcher->start();
+   }
 
-   Animator->TimePerSection = Animator->AnimationDuration / static_cast<double>(CapturedEulerAngles.size());
-   while (!glfwWindowShouldClose( Window )) {
-      update();
-      render();
-      glfwSwapBuffers( Window );
+   FrameState.reset();
+   glfwMakeContextCurrent( nullptr );
+   std::thread render_thread( &RendererGL::renderLoop, this );
+   Scheduler->start( Clock.now() );
+   const double step_in_ms = Scheduler->getFixedStep() * 1000.0;
+   // Hot reload needs frames to pick up edited shaders, so it keeps rendering idle frames at the idle frame rate.
+   const bool on_demand = Scheduler->getSettings().RenderOnDemand && !ShaderHotReload;
+   Damage = WindowDamage;
+   while (!glfwWindowShouldClose( Window ) && !Clock.hasEnded()) {
+      Scheduler->setActive( Animator->AnimationMode || isSceneShown() || MainCamera->getMovingState() );
+      if (Clock.isRealTime()) {
+         // An undamaged frame would show the same as the last one, so the loop sleeps until an event changes something.
+         if (on_demand && getDamage() == 0) {
+            glfwWaitEventsTimeout( IdleWaitTime );
+            continue;
+         }
+         const double remaining_time = Scheduler->getNextFrameTime() - Clock.now();
+         if (remaining_time > 0.0) {
+            glfwWaitEventsTimeout( remaining_time );
+            continue;
+         }
+      }
       glfwPollEvents();
+      if (CaptureFailed.exchange( false )) {
+         RecordingMode = false;
+         std::cerr << "[Capture] recording has been turned off\n";
+      }
+
+      const double now = Clock.now();
+      const int steps = Scheduler->advance( now );
+      CpuProfiler::recordCounter( "Simulation Steps", steps );
+      for (int i = 0; i < steps; ++i) update( step_in_ms );
+      prepareFramePacket( FrameState.getWritablePacket(), Scheduler->getInterpolationFactor() );
+      clearDamage();
+      FrameState.publish();
+      {
+         const CpuProfiler::Zone zone( "Wait For Render Thread" );
+         FrameState.waitUntilConsumed();
+      }
+      Scheduler->reportFrameTimes( now );
+      Clock.advanceFrame();
+      CpuProfiler::markFrame( "Simulation Frame" );
+   }
+   FrameState.stop();
+   render_thread.join();
+   ShaderWatcher->stop();
+   EulerAngleTrack.clear();
+   QuaternionTrack.clear();
+   QuaternionCurve.clear();
+   TrackFile->close();
+   if (!GpuProfileFilePath.empty() && GpuProfiler->writeCSV( GpuProfileFilePath )) {
+      std::cout << "GPU profile written to " << GpuProfileFilePath << "\n";
    }
+
+   glfwMakeContextCurrent( Window );
    glfwDestroyWindow( Window );
 }
\ No newline at end of file
@@ -0,0 +1,195 @@
+#include "RotationKernelsSimd.h"
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
+#if defined( GIMBAL_LOCK_X86_KERNELS ) && defined( _MSC_VER )
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace
+{
+   // The same kernels one lane at a time, for CPUs without any of the vector paths.
+   struct ScalarLanes
+   {
+      using Float = float;
+      using Int = uint32_t;
+      static constexpr size_t Width = 1;
+
+      static Float load(const float* p) { return *p; }
+      static void store(float* p, Float a) { *p = a; }
+      static Float set(float a) { return a; }
+      static Float add(Float a, Float b) { return a + b; }
+      static Float sub(Float a, Float b) { return a - b; }
+      static Float mul(Float a, Float b) { return a * b; }
+      static Float div(Float a, Float b) { return a / b; }
+      static Float sqrt(Float a) { return std::sqrt( a ); }
+      static Float fma(Float a, Float b, Float c) { return a * b + c; }
+      static Float max(Float a, Float b) { return a < b ? b : a; }
+      static Float min(Float a, Float b) { return b < a ? b : a; }
+      static Float lessThanSelect(Float a, Float b, Float if_less, Float otherwise) { return a < b ? if_less : otherwise; }
+      static Int setInt(int a) { return static_cast<Int>(a); }
+      static Int loadInt(const int* p) { return static_cast<Int>(*p); }
+      static void storeInt(int* p, Int a) { *p = static_cast<int>(a); }
+      static Float gather(const float* base, Int indices) { return base[static_cast<int32_t>(indices)]; }
+      static Int toInt(Float a) { return static_cast<Int>(static_cast<int32_t>(a)); }
+      static Float toFloat(Int a) { return static_cast<Float>(static_cast<int32_t>(a)); }
+      static Int castToInt(Float a) { Int b; std::memcpy( &b, &a, sizeof( b ) ); return b; }
+      static Float castToFloat(Int a) { Float b; std::memcpy( &b, &a, sizeof( b ) ); return b; }
+      static Int addInt(Int a, Int b) { return a + b; }
+      static Int subInt(Int a, Int b) { return a - b; }
+      static Int andInt(Int a, Int b) { return a & b; }
+      static Int andNotInt(Int a, Int b) { return ~a & b; }
+      static Int orInt(Int a, Int b) { return a | b; }
+      static Int xorInt(Int a, Int b) { return a ^ b; }
+      template<int N> static Int shiftLeft(Int a) { return a << N; }
+      template<int N> static Int shiftRightArithmetic(Int a) { return static_cast<Int>(static_cast<int32_t>(a) >> N); }
+   };
+}
+
+const RotationKernels::KernelTable RotationKernels::ScalarKernels = {
+   &RotationKernelsSimd::toQuaternions<ScalarLanes>,
+   &RotationKernelsSimd::toMatrices3<ScalarLanes>,
+   &RotationKernelsSimd::toMatrices4<ScalarLanes>,
+   &RotationKernelsSimd::evaluateQuaternionCubics<ScalarLanes>,
+   &RotationKernelsSimd::slerpQuaternions<ScalarLanes>,
+   &RotationKernelsSimd::getGimbalMetrics<ScalarLanes>,
+   &RotationKernelsSimd::propagateJoints<ScalarLanes>,
+   &RotationKernelsSimd::getPointBounds<ScalarLanes>,
+   &RotationKernelsSimd::cullBoundingVolumes<ScalarLanes>
+};
+
+RotationKernels::InstructionSet RotationKernels::Selected = RotationKernels::getSupportedInstructionSet();
+
+RotationKernels::InstructionSet RotationKernels::getSupportedInstructionSet()
+{
+#if defined( GIMBAL_LOCK_X86_KERNELS ) && defined( _MSC_VER )
+   int info[4];
+   __cpuid( info, 0 );
+   if (info[0] < 7) return InstructionSet::SSE;
+
+   __cpuid( info, 1 );
+   const bool fma = (info[2] & (1 << 12)) != 0;
+   const bool os_saves_ymm = (info[2] & (1 << 27)) != 0 && (_xgetbv( 0 ) & 0x6) == 0x6;
+   __cpuidex( info, 7, 0 );
+   const bool avx2 = (info[1] & (1 << 5)) != 0;
+   const bool avx512f = (info[1] & (1 << 16)) != 0;
+   if (avx512f && os_saves_ymm && (_xgetbv( 0 ) & 0xe6) == 0xe6) return InstructionSet::AVX512;
+   if (avx2 && fma && os_saves_ymm) return InstructionSet::AVX2;
+   return InstructionSet::SSE;
+#elif defined( GIMBAL_LOCK_X86_KERNELS )
+   // Called during static initialization, possibly before the CPU model has been filled in.
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports( "avx512f" )) return InstructionSet::AVX512;
+   if (__builtin_cpu_supports( "avx2" ) && __builtin_cpu_supports( "fma" )) return InstructionSet::AVX2;
+   return InstructionSet::SSE;
+#else
+   return InstructionSet::Scalar;
+#endif
+}
+
+void RotationKernels::setInstructionSet(InstructionSet instruction_set)
+{
+   const InstructionSet supported = getSupportedInstructionSet();
+   Selected = static_cast<int>(instruction_set) <= static_cast<int>(supported) ? instruction_set : supported;
+}
+
+const char* RotationKernels::getInstructionSetName(InstructionSet instruction_set)
+{
+   switch (instruction_set) {
+      case InstructionSet::SSE: return "SSE";
+      case InstructionSet::AVX2: return "AVX2";
+      case InstructionSet::AVX512: return "AVX-512";
+      default: return "Scalar";
+   }
+}
+
+const RotationKernels::KernelTable& RotationKernels::getKernels()
+{
+#ifdef GIMBAL_LOCK_X86_KERNELS
+   switch (Selected) {
+      case InstructionSet::SSE: return SSEKernels;
+      case InstructionSet::AVX2: return AVX2Kernels;
+      case InstructionSet::AVX512: return AVX512Kernels;
+      default: return ScalarKernels;
+   }
+#else
+   return ScalarKernels;
+#endif
+}
+
+void RotationKernels::toQuaternions(const EulerAngleArrays& angles, const QuaternionArrays& quaternions, size_t count)
+{
+   getKernels().ToQuaternions( angles, quaternions, count );
+}
+
+void RotationKernels::toMatrices(const EulerAngleArrays& angles, const Matrix3Arrays& matrices, size_t count)
+{
+   getKernels().ToMatrices3( angles, matrices, count );
+}
+
+void RotationKernels::toMatrices(const EulerAngleArrays& angles, const Matrix4Arrays& matrices, size_t count)
+{
+   getKernels().ToMatrices4( angles, matrices, count );
+}
+
+void RotationKernels::evaluateQuaternionCubics(
+   const float* coefficients,
+   const int* segments,
+   const float* t,
+   size_t count,
+   const QuaternionArrays& quaternions
+)
+{
+   getKernels().EvaluateQuaternionCubics( coefficients, segments, t, count, quaternions );
+}
+
+void RotationKernels::slerpQuaternions(
+   const ConstQuaternionArrays& from,
+   const ConstQuaternionArrays& to,
+   const float* t,
+   size_t count,
+   const QuaternionArrays& quaternions
+)
+{
+   getKernels().SlerpQuaternions( from, to, t, count, quaternions );
+}
+
+void RotationKernels::getGimbalMetrics(
+   const EulerAngleArrays& angles,
+   float interpolation_step,
+   const GimbalMetricArrays& metrics,
+   size_t count
+)
+{
+   getKernels().GetGimbalMetrics( angles, interpolation_step, metrics, count );
+}
+
+void RotationKernels::propagateJoints(const JointArrays& joints, size_t begin, size_t end)
+{
+   getKernels().PropagateJoints( joints, begin, end );
+}
+
+void RotationKernels::getPointBounds(
+   const float* points,
+   size_t stride,
+   size_t count,
+   const float* center,
+   PointBounds& bounds
+)
+{
+   getKernels().GetPointBounds( points, stride, count, center, bounds );
+}
+
+void RotationKernels::cullBoundingVolumes(
+   const BoundingVolumeArrays& volumes,
+   const float* planes,
+   int frustum_num,
+   size_t count,
+   unsigned int* visible,
+   unsigned int* contained
+)
+{
+   getKernels().CullBoundingVolumes( volumes, planes, frustum_num, count, visible, contained );
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include "RotationKernelsSimd.h"
+#include <immintrin.h>
+
+namespace
+{
+   struct AVX2Lanes
+   {
+      using Float = __m256;
+      using Int = __m256i;
+      static constexpr size_t Width = 8;
+
+      static Float load(const float* p) { return _mm256_loadu_ps( p ); }
+      static void store(float* p, Float a) { _mm256_storeu_ps( p, a ); }
+      static Float set(float a) { return _mm256_set1_ps( a ); }
+      static Float add(Float a, Float b) { return _mm256_add_ps( a, b ); }
+      static Float sub(Float a, Float b) { return _mm256_sub_ps( a, b ); }
+      static Float mul(Float a, Float b) { return _mm256_mul_ps( a, b ); }
+      static Float div(Float a, Float b) { return _mm256_div_ps( a, b ); }
+      static Float sqrt(Float a) { return _mm256_sqrt_ps( a ); }
+      static Float fma(Float a, Float b, Float c) { return _mm256_fmadd_ps( a, b, c ); }
+      static Float max(Float a, Float b) { return _mm256_max_ps( a, b ); }
+      static Float min(Float a, Float b) { return _mm256_min_ps( a, b ); }
+      static Float lessThanSelect(Float a, Float b, Float if_less, Float otherwise)
+      {
+         return _mm256_blendv_ps( otherwise, if_less, _mm256_cmp_ps( a, b, _CMP_LT_OQ ) );
+      }
+      static Int setInt(int a) { return _mm256_set1_epi32( a ); }
+      static Int loadInt(const int* p) { return _mm256_loadu_si256( reinterpret_cast<const __m256i*>(p) ); }
+      static void storeInt(int* p, Int a) { _mm256_storeu_si256( reinterpret_cast<__m256i*>(p), a ); }
+      static Float gather(const float* base, Int indices) { return _mm256_i32gather_ps( base, indices, 4 ); }
+      static Int toInt(Float a) { return _mm256_cvttps_epi32( a ); }
+      static Float toFloat(Int a) { return _mm256_cvtepi32_ps( a ); }
+      static Int castToInt(Float a) { return _mm256_castps_si256( a ); }
+      static Float castToFloat(Int a) { return _mm256_castsi256_ps( a ); }
+      static Int addInt(Int a, Int b) { return _mm256_add_epi32( a, b ); }
+      static Int subInt(Int a, Int b) { return _mm256_sub_epi32( a, b ); }
+      static Int andInt(Int a, Int b) { return _mm256_and_si256( a, b ); }
+      static Int andNotInt(Int a, Int b) { return _mm256_andnot_si256( a, b ); }
+      static Int orInt(Int a, Int b) { return _mm256_or_si256( a, b ); }
+      static Int xorInt(Int a, Int b) { return _mm256_xor_si256( a, b ); }
+      template<int N> static Int shiftLeft(Int a) { return _mm256_slli_epi32( a, N ); }
+      template<int N> static Int shiftRightArithmetic(Int a) { return _mm256_srai_epi32( a, N ); }
+   };
+}
+
+const RotationKernels::KernelTable RotationKernels::AVX2Kernels = {
+   &RotationKernelsSimd::toQuaternions<AVX2Lanes>,
+   &RotationKernelsSimd::toMatrices3<AVX2Lanes>,
+   &RotationKernelsSimd::toMatrices4<AVX2Lanes>,
+   &RotationKernelsSimd::evaluateQuaternionCubics<AVX2Lanes>,
+   &RotationKernelsSimd::slerpQuaternions<AVX2Lanes>,
+   &RotationKernelsSimd::getGimbalMetrics<AVX2Lanes>,
+   &RotationKernelsSimd::propagateJoints<AVX2Lanes>,
+   &RotationKernelsSimd::getPointBounds<AVX2Lanes>,
+   &RotationKernelsSimd::cullBoundingVolumes<AVX2Lanes>
+};
\ No newline at end of file
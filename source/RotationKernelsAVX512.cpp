@@ -0,0 +1,56 @@
+#include "RotationKernelsSimd.h"
+#include <immintrin.h>
+
+namespace
+{
+   struct AVX512Lanes
+   {
+      using Float = __m512;
+      using Int = __m512i;
+      static constexpr size_t Width = 16;
+
+      static Float load(const float* p) { return _mm512_loadu_ps( p ); }
+      static void store(float* p, Float a) { _mm512_storeu_ps( p, a ); }
+      static Float set(float a) { return _mm512_set1_ps( a ); }
+      static Float add(Float a, Float b) { return _mm512_add_ps( a, b ); }
+      static Float sub(Float a, Float b) { return _mm512_sub_ps( a, b ); }
+      static Float mul(Float a, Float b) { return _mm512_mul_ps( a, b ); }
+      static Float div(Float a, Float b) { return _mm512_div_ps( a, b ); }
+      static Float sqrt(Float a) { return _mm512_sqrt_ps( a ); }
+      static Float fma(Float a, Float b, Float c) { return _mm512_fmadd_ps( a, b, c ); }
+      static Float max(Float a, Float b) { return _mm512_max_ps( a, b ); }
+      static Float min(Float a, Float b) { return _mm512_min_ps( a, b ); }
+      static Float lessThanSelect(Float a, Float b, Float if_less, Float otherwise)
+      {
+         return _mm512_mask_blend_ps( _mm512_cmp_ps_mask( a, b, _CMP_LT_OQ ), otherwise, if_less );
+      }
+      static Int setInt(int a) { return _mm512_set1_epi32( a ); }
+      static Int loadInt(const int* p) { return _mm512_loadu_si512( p ); }
+      static void storeInt(int* p, Int a) { _mm512_storeu_si512( p, a ); }
+      static Float gather(const float* base, Int indices) { return _mm512_i32gather_ps( indices, base, 4 ); }
+      static Int toInt(Float a) { return _mm512_cvttps_epi32( a ); }
+      static Float toFloat(Int a) { return _mm512_cvtepi32_ps( a ); }
+      static Int castToInt(Float a) { return _mm512_castps_si512( a ); }
+      static Float castToFloat(Int a) { return _mm512_castsi512_ps( a ); }
+      static Int addInt(Int a, Int b) { return _mm512_add_epi32( a, b ); }
+      static Int subInt(Int a, Int b) { return _mm512_sub_epi32( a, b ); }
+      static Int andInt(Int a, Int b) { return _mm512_and_si512( a, b ); }
+      static Int andNotInt(Int a, Int b) { return _mm512_andnot_si512( a, b ); }
+      static Int orInt(Int a, Int b) { return _mm512_or_si512( a, b ); }
+      static Int xorInt(Int a, Int b) { return _mm512_xor_si512( a, b ); }
+      template<int N> static Int shiftLeft(Int a) { return _mm512_slli_epi32( a, N ); }
+      template<int N> static Int shiftRightArithmetic(Int a) { return _mm512_srai_epi32( a, N ); }
+   };
+}
+
+const RotationKernels::KernelTable RotationKernels::AVX512Kernels = {
+   &RotationKernelsSimd::toQuaternions<AVX512Lanes>,
+   &RotationKernelsSimd::toMatrices3<AVX512Lanes>,
+   &RotationKernelsSimd::toMatrices4<AVX512Lanes>,
+   &RotationKernelsSimd::evaluateQuaternionCubics<AVX512Lanes>,
+   &RotationKernelsSimd::slerpQuaternions<AVX512Lanes>,
+   &RotationKernelsSimd::getGimbalMetrics<AVX512Lanes>,
+   &RotationKernelsSimd::propagateJoints<AVX512Lanes>,
+   &RotationKernelsSimd::getPointBounds<AVX512Lanes>,
+   &RotationKernelsSimd::cullBoundingVolumes<AVX512Lanes>
+};
\ No newline at end of file
@@ -0,0 +1,62 @@
+#include "RotationKernelsSimd.h"
+#include <immintrin.h>
+
+namespace
+{
+   struct SSELanes
+   {
+      using Float = __m128;
+      using Int = __m128i;
+      static constexpr size_t Width = 4;
+
+      static Float load(const float* p) { return _mm_loadu_ps( p ); }
+      static void store(float* p, Float a) { _mm_storeu_ps( p, a ); }
+      static Float set(float a) { return _mm_set1_ps( a ); }
+      static Float add(Float a, Float b) { return _mm_add_ps( a, b ); }
+      static Float sub(Float a, Float b) { return _mm_sub_ps( a, b ); }
+      static Float mul(Float a, Float b) { return _mm_mul_ps( a, b ); }
+      static Float div(Float a, Float b) { return _mm_div_ps( a, b ); }
+      static Float sqrt(Float a) { return _mm_sqrt_ps( a ); }
+      static Float fma(Float a, Float b, Float c) { return _mm_add_ps( _mm_mul_ps( a, b ), c ); }
+      static Float max(Float a, Float b) { return _mm_max_ps( a, b ); }
+      static Float min(Float a, Float b) { return _mm_min_ps( a, b ); }
+      static Float lessThanSelect(Float a, Float b, Float if_less, Float otherwise)
+      {
+         const Float mask = _mm_cmplt_ps( a, b );
+         return _mm_or_ps( _mm_and_ps( mask, if_less ), _mm_andnot_ps( mask, otherwise ) );
+      }
+      static Int setInt(int a) { return _mm_set1_epi32( a ); }
+      static Int loadInt(const int* p) { return _mm_loadu_si128( reinterpret_cast<const __m128i*>(p) ); }
+      static void storeInt(int* p, Int a) { _mm_storeu_si128( reinterpret_cast<__m128i*>(p), a ); }
+      static Float gather(const float* base, Int indices)
+      {
+         alignas(16) int i[4];
+         _mm_store_si128( reinterpret_cast<__m128i*>(i), indices );
+         return _mm_setr_ps( base[i[0]], base[i[1]], base[i[2]], base[i[3]] );
+      }
+      static Int toInt(Float a) { return _mm_cvttps_epi32( a ); }
+      static Float toFloat(Int a) { return _mm_cvtepi32_ps( a ); }
+      static Int castToInt(Float a) { return _mm_castps_si128( a ); }
+      static Float castToFloat(Int a) { return _mm_castsi128_ps( a ); }
+      static Int addInt(Int a, Int b) { return _mm_add_epi32( a, b ); }
+      static Int subInt(Int a, Int b) { return _mm_sub_epi32( a, b ); }
+      static Int andInt(Int a, Int b) { return _mm_and_si128( a, b ); }
+      static Int andNotInt(Int a, Int b) { return _mm_andnot_si128( a, b ); }
+      static Int orInt(Int a, Int b) { return _mm_or_si128( a, b ); }
+      static Int xorInt(Int a, Int b) { return _mm_xor_si128( a, b ); }
+      template<int N> static Int shiftLeft(Int a) { return _mm_slli_epi32( a, N ); }
+      template<int N> static Int shiftRightArithmetic(Int a) { return _mm_srai_epi32( a, N ); }
+   };
+}
+
+const RotationKernels::KernelTable RotationKernels::SSEKernels = {
+   &RotationKernelsSimd::toQuaternions<SSELanes>,
+   &RotationKernelsSimd::toMatrices3<SSELanes>,
+   &RotationKernelsSimd::toMatrices4<SSELanes>,
+   &RotationKernelsSimd::evaluateQuaternionCubics<SSELanes>,
+   &RotationKernelsSimd::slerpQuaternions<SSELanes>,
+   &RotationKernelsSimd::getGimbalMetrics<SSELanes>,
+   &RotationKernelsSimd::propagateJoints<SSELanes>,
+   &RotationKernelsSimd::getPointBounds<SSELanes>,
+   &RotationKernelsSimd::cullBoundingVolumes<SSELanes>
+};
\ No newline at end of file
@@ -0,0 +1,174 @@
+#include "SceneStore.h"
+
+int SceneStore::addMesh(const BoundingVolume& bounds)
+{
+   MeshBounds.emplace_back( bounds );
+   return getMeshNum() - 1;
+}
+
+size_t SceneStore::addEntity(const Entity& entity)
+{
+   assert( entity.Mesh >= 0 && entity.Mesh < getMeshNum() );
+
+   const glm::quat from = QuaternionRotation::fromMatrix( OrientateRotation::toMatrix( entity.FromEulerAngle ) );
+   const glm::quat to = QuaternionRotation::fromMatrix( OrientateRotation::toMatrix( entity.ToEulerAngle ) );
+   const float from_components[4] = { from.w, from.x, from.y, from.z };
+   const float to_components[4] = { to.w, to.x, to.y, to.z };
+   Meshes.emplace_back( entity.Mesh );
+   Scales.emplace_back( entity.Scale );
+   Colors.emplace_back( entity.Color );
+   Frequencies.emplace_back( entity.Period > 0.0f ? 1.0f / entity.Period : 0.0f );
+   Phases.emplace_back( entity.Phase );
+   Weights.emplace_back( 0.0f );
+   for (int k = 0; k < 3; ++k) {
+      Positions[k].emplace_back( entity.Position[k] );
+      FromEulerAngles[k].emplace_back( entity.FromEulerAngle[k] );
+      ToEulerAngles[k].emplace_back( entity.ToEulerAngle[k] );
+      EulerAngles[k].emplace_back( entity.FromEulerAngle[k] );
+   }
+   for (int k = 0; k < 4; ++k) {
+      FromRotations[k].emplace_back( from_components[k] );
+      ToRotations[k].emplace_back( to_components[k] );
+      Rotations[k].emplace_back( from_components[k] );
+      EulerAngleRotations[k].emplace_back( from_components[k] );
+   }
+   BoundsChanged = true;
+   return getEntityNum() - 1;
+}
+
+void SceneStore::clear()
+{
+   MeshBounds.clear();
+   Meshes.clear();
+   Scales.clear();
+   Colors.clear();
+   Frequencies.clear();
+   Phases.clear();
+   Weights.clear();
+   for (int k = 0; k < 3; ++k) {
+      Positions[k].clear();
+      FromEulerAngles[k].clear();
+      ToEulerAngles[k].clear();
+      EulerAngles[k].clear();
+   }
+   for (int k = 0; k < 4; ++k) {
+      FromRotations[k].clear();
+      ToRotations[k].clear();
+      Rotations[k].clear();
+      EulerAngleRotations[k].clear();
+   }
+   Culler.clearObjects();
+   BoundsChanged = false;
+}
+
+glm::vec3 SceneStore::getEulerAngle(size_t entity) const
+{
+   return { EulerAngles[0][entity], EulerAngles[1][entity], EulerAngles[2][entity] };
+}
+
+glm::quat SceneStore::getRotation(size_t entity, RotationForm form) const
+{
+   const auto& rotations = form == RotationForm::Quaternion ? Rotations : EulerAngleRotations;
+   return { rotations[0][entity], rotations[1][entity], rotations[2][entity], rotations[3][entity] };
+}
+
+QuaternionArrays SceneStore::getArrays(std::array<std::vector<float>, 4>& quaternions, size_t offset)
+{
+   return {
+      quaternions[0].data() + offset, quaternions[1].data() + offset,
+      quaternions[2].data() + offset, quaternions[3].data() + offset
+   };
+}
+
+ConstQuaternionArrays SceneStore::getConstArrays(const std::array<std::vector<float>, 4>& quaternions, size_t offset)
+{
+   return {
+      quaternions[0].data() + offset, quaternions[1].data() + offset,
+      quaternions[2].data() + offset, quaternions[3].data() + offset
+   };
+}
+
+void SceneStore::animateRange(double time, size_t begin, size_t end)
+{
+   // A smoothed triangle wave, so the entities ease in and out at both keys.
+   for (size_t i = begin; i < end; ++i) {
+      const double cycle = static_cast<double>(Phases[i]) + time * Frequencies[i];
+      const auto s = static_cast<float>(cycle - std::floor( cycle ));
+      const float w = 1.0f - std::abs( 2.0f * s - 1.0f );
+      Weights[i] = w * w * (3.0f - 2.0f * w);
+   }
+   for (int k = 0; k < 3; ++k) {
+      const float* from = FromEulerAngles[k].data();
+      const float* to = ToEulerAngles[k].data();
+      float* angles = EulerAngles[k].data();
+      for (size_t i = begin; i < end; ++i) angles[i] = from[i] + Weights[i] * (to[i] - from[i]);
+   }
+   RotationKernels::slerpQuaternions(
+      getConstArrays( FromRotations, begin ), getConstArrays( ToRotations, begin ), Weights.data() + begin, end - begin,
+      getArrays( Rotations, begin )
+   );
+}
+
+void SceneStore::animate(double time, TaskScheduler* scheduler)
+{
+   const CpuProfiler::Zone zone( "Animate Scene" );
+   const auto animate_range = [this, time](size_t begin, size_t end, int) { animateRange( time, begin, end ); };
+   if (scheduler == nullptr) animate_range( 0, getEntityNum(), 0 );
+   else scheduler->parallelFor( 0, getEntityNum(), GrainSize, animate_range );
+}
+
+void SceneStore::buildTransforms(TaskScheduler* scheduler)
+{
+   const CpuProfiler::Zone zone( "Build Scene Transforms" );
+   const auto build = [this](size_t begin, size_t end, int) {
+      const EulerAngleArrays angles{
+         EulerAngles[0].data() + begin, EulerAngles[1].data() + begin, EulerAngles[2].data() + begin
+      };
+      RotationKernels::toQuaternions( angles, getArrays( EulerAngleRotations, begin ), end - begin );
+   };
+   if (scheduler == nullptr) build( 0, getEntityNum(), 0 );
+   else scheduler->parallelFor( 0, getEntityNum(), GrainSize, build );
+}
+
+void SceneStore::setFrustum(int frustum, const std::array<glm::vec4, 6>& planes)
+{
+   while (Culler.getFrustumNum() <= frustum) Culler.addFrustum( planes );
+   Culler.setFrustum( frustum, planes );
+}
+
+void SceneStore::cull(TaskScheduler* scheduler)
+{
+   if (BoundsChanged) {
+      // A sphere around the position that holds the mesh bounds in every orientation, and the box around it.
+      Culler.clearObjects();
+      Culler.reserve( getEntityNum() );
+      for (size_t i = 0; i < getEntityNum(); ++i) {
+         const BoundingVolume& mesh = MeshBounds[Meshes[i]];
+         const float radius = (glm::length( mesh.Center ) + mesh.Radius) * std::abs( Scales[i] );
+         BoundingVolume volume( { Positions[0][i], Positions[1][i], Positions[2][i] }, glm::vec3(radius) );
+         volume.Radius = radius;
+         Culler.addObject( volume );
+      }
+      BoundsChanged = false;
+   }
+   Culler.cull( scheduler );
+}
+
+void SceneStore::getInstances(
+   RotationForm form,
+   int frustum,
+   std::vector<std::vector<glm::vec4>>& instances
+) const
+{
+   const auto& rotations = form == RotationForm::Quaternion ? Rotations : EulerAngleRotations;
+   instances.resize( MeshBounds.size() );
+   for (auto& mesh_instances : instances) mesh_instances.clear();
+   for (size_t i = 0; i < getEntityNum(); ++i) {
+      if (!Culler.isVisible( i, frustum )) continue;
+
+      std::vector<glm::vec4>& mesh_instances = instances[Meshes[i]];
+      mesh_instances.emplace_back( rotations[1][i], rotations[2][i], rotations[3][i], rotations[0][i] );
+      mesh_instances.emplace_back( Positions[0][i], Positions[1][i], Positions[2][i], Scales[i] );
+      mesh_instances.emplace_back( Colors[i] );
+   }
+}
\ No newline at end of file
@@ -1,28 +1,46 @@
 #include "Shader.h"
 
-ShaderGL::ShaderGL() : ShaderProgram( 0 )
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+ShaderGL::ShaderGL() :
+   ShaderProgram( 0 ), IsSpirVProgram( false ), UniformUploadNum( 0 ), SkippedUniformUploadNum( 0 ),
+   CameraVersion( std::numeric_limits<uint64_t>::max() ), PendingProgram( 0 ), PendingVertexShader( 0 ), PendingFragmentShader( 0 ), PendingKey( 0 )
 {
 }
 
 ShaderGL::~ShaderGL()
 {
+   if (PendingProgram != 0) {
+      glDeleteShader( PendingVertexShader );
+      glDeleteShader( PendingFragmentShader );
+      glDeleteProgram( PendingProgram );
+   }
    if (ShaderProgram != 0) glDeleteProgram( ShaderProgram );
 }
 
-void ShaderGL::readShaderFile(std::string& shader_contents, const char* shader_path)
+void ShaderGL::initializeCompilerCapabilities()
 {
-   std::ifstream file( shader_path, std::ios::in );
-   if (!file.is_open()) {
-      std::cerr << "Cannot open shader file: " << shader_path << "\n";
-      return;
-   }
+   SpirVSupported = GLAD_GL_VERSION_4_6 != 0 || glfwExtensionSupported( "GL_ARB_gl_spirv" ) == GLFW_TRUE;
 
-   std::string line;
-   while (!file.eof()) {
-      getline( file, line );
-      shader_contents.append( line + "\n" );
-   }
-   file.close();
+   using MaxShaderCompilerThreads = void (APIENTRYP)(GLuint count);
+   const char* extension = glfwExtensionSupported( "GL_KHR_parallel_shader_compile" ) ? "glMaxShaderCompilerThreadsKHR" :
+      glfwExtensionSupported( "GL_ARB_parallel_shader_compile" ) ? "glMaxShaderCompilerThreadsARB" : nullptr;
+   if (extension == nullptr) return;
+
+   const auto max_shader_compiler_threads = reinterpret_cast<MaxShaderCompilerThreads>(glfwGetProcAddress( extension ));
+   if (max_shader_compiler_threads == nullptr) return;
+
+   // 0xFFFFFFFF lets the driver pick its own number of compiler threads.
+   max_shader_compiler_threads( 0xFFFFFFFFu );
+   ParallelCompileSupported = true;
+}
+
+bool ShaderGL::usesShaderFile(const std::string& file_path) const
+{
+   const std::string path = std::filesystem::absolute( file_path ).lexically_normal().string();
+   return std::find( ShaderFiles.begin(), ShaderFiles.end(), path ) != ShaderFiles.end();
 }
 
 std::string ShaderGL::getShaderTypeString(GLenum shader_type)
@@ -36,6 +54,12 @@ std::string ShaderGL::getShaderTypeString(GLenum shader_type)
 
 bool ShaderGL::checkCompileError(GLenum shader_type, const GLuint& shader)
 {
+   // No shader is created when the source could not be read, and there is no log to ask for.
+   if (shader == 0) {
+      std::cerr << " ======= " << getShaderTypeString( shader_type ) << " has no source ======= \n";
+      return false;
+   }
+
    GLint compiled = 0;
    glGetShaderiv( shader, GL_COMPILE_STATUS, &compiled );
 
@@ -44,62 +68,529 @@ bool ShaderGL::checkCompileError(GLenum shader_type, const GLuint& shader)
       glGetShaderiv( shader, GL_INFO_LOG_LENGTH, &max_length );
 
       std::cerr << " ======= " << getShaderTypeString( shader_type ) << " log ======= \n";
-      std::vector<GLchar> error_log(max_length);
+      std::vector<GLchar> error_log(std::max( max_length, 1 ));
       glGetShaderInfoLog( shader, max_length, &max_length, &error_log[0] );
       for (const auto& c : error_log) std::cerr << c;
       std::cerr << "\n";
-      glDeleteShader( shader );
    }
    return compiled == GL_TRUE;
 }
 
-GLuint ShaderGL::getCompiledShader(GLenum shader_type, const char* shader_path)
+bool ShaderGL::checkLinkError(const GLuint& program)
 {
-   if (shader_path == nullptr) return 0;
+   GLint linked = 0;
+   glGetProgramiv( program, GL_LINK_STATUS, &linked );
+
+   if (linked == GL_FALSE) {
+      GLint max_length = 0;
+      glGetProgramiv( program, GL_INFO_LOG_LENGTH, &max_length );
+
+      std::cerr << " ======= Program log ======= \n";
+      std::vector<GLchar> error_log(std::max( max_length, 1 ));
+      glGetProgramInfoLog( program, max_length, &max_length, &error_log[0] );
+      for (const auto& c : error_log) std::cerr << c;
+      std::cerr << "\n";
+   }
+   return linked == GL_TRUE;
+}
 
-   std::string shader_contents;
-   readShaderFile( shader_contents, shader_path );
+GLuint ShaderGL::getCompilingShader(GLenum shader_type, const std::string& shader_contents)
+{
+   if (shader_contents.empty()) return 0;
 
    const GLuint shader = glCreateShader( shader_type );
    const char* shader_source = shader_contents.c_str();
    glShaderSource( shader, 1, &shader_source, nullptr );
    glCompileShader( shader );
-   if (!checkCompileError( shader_type, shader )) {
-      std::cerr << "Could not compile shader\n";
-      return 0;
-   }
    return shader;
 }
 
-void ShaderGL::setShader(const char* vertex_shader_path, const char* fragment_shader_path)
+GLuint ShaderGL::getSpecializedShader(GLenum shader_type, const EmbeddedShaderFile& spirv)
+{
+   const GLuint shader = glCreateShader( shader_type );
+   glShaderBinary( 1, &shader, GL_SHADER_BINARY_FORMAT_SPIR_V, spirv.Contents, static_cast<GLsizei>(spirv.Size) );
+   glSpecializeShader( shader, "main", 0, nullptr, nullptr );
+   return shader;
+}
+
+uint64_t ShaderGL::getProgramKey(const std::vector<const std::string*>& sources, const std::string& defines)
+{
+   // FNV-1a over everything a driver could bake into the binary; a new driver version changes GL_VERSION.
+   uint64_t hash = 0xcbf29ce484222325ull;
+   const auto combine = [&hash](const char* data, size_t size) {
+      for (size_t i = 0; i < size; ++i) {
+         hash ^= static_cast<uchar>(data[i]);
+         hash *= 0x100000001b3ull;
+      }
+      hash ^= 0xff;
+      hash *= 0x100000001b3ull;
+   };
+   for (const auto& source : sources) combine( source->data(), source->size() );
+   combine( defines.data(), defines.size() );
+   const auto renderer = reinterpret_cast<const char*>(glGetString( GL_RENDERER ));
+   const auto version = reinterpret_cast<const char*>(glGetString( GL_VERSION ));
+   if (renderer != nullptr) combine( renderer, std::strlen( renderer ) );
+   if (version != nullptr) combine( version, std::strlen( version ) );
+   return hash;
+}
+
+const std::string& ShaderGL::getProgramCacheDirectory()
+{
+   if (ProgramCacheDirectory.empty()) {
+      // Without a usable temp directory the cache goes next to the working directory.
+      std::error_code error;
+      const std::filesystem::path temp_directory = std::filesystem::temp_directory_path( error );
+      ProgramCacheDirectory =
+         ((error ? std::filesystem::path(".") : temp_directory) / "GimbalLock" / "ProgramCache").string();
+   }
+   return ProgramCacheDirectory;
+}
+
+std::string ShaderGL::getProgramCachePath(uint64_t key)
+{
+   std::ostringstream file_name;
+   file_name << std::hex << std::setw( 16 ) << std::setfill( '0' ) << key << ".bin";
+   return (std::filesystem::path(getProgramCacheDirectory()) / file_name.str()).string();
+}
+
+bool ShaderGL::loadProgramBinary(uint64_t key)
+{
+   const std::string file_path = getProgramCachePath( key );
+   std::ifstream file( file_path, std::ios::binary );
+   if (!file.is_open()) return false;
+
+   const auto start = std::chrono::steady_clock::now();
+   ProgramBinaryHeader header{};
+   file.read( reinterpret_cast<char*>(&header), sizeof( header ) );
+   if (!file || header.Magic != ProgramBinaryMagic) return false;
+
+   // A truncated or corrupt entry is a miss, so the program is compiled again and the entry rewritten.
+   std::error_code error;
+   const uintmax_t file_size = std::filesystem::file_size( file_path, error );
+   if (error || file_size < sizeof( header ) || header.Length != file_size - sizeof( header )) {
+      std::cout << "[Shader] cached binary " << std::hex << key << std::dec << " is corrupt\n";
+      return false;
+   }
+
+   std::vector<char> binary(header.Length);
+   file.read( binary.data(), header.Length );
+   if (!file) return false;
+
+   const GLuint program = glCreateProgram();
+   glProgramBinary( program, header.Format, binary.data(), static_cast<GLsizei>(header.Length) );
+   GLint linked = GL_FALSE;
+   glGetProgramiv( program, GL_LINK_STATUS, &linked );
+   if (linked == GL_FALSE) {
+      std::cout << "[Shader] cached binary " << std::hex << key << std::dec << " was rejected by the driver\n";
+      glDeleteProgram( program );
+      return false;
+   }
+
+   installProgram( program );
+   const double load_time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+   std::cout << std::fixed << std::setprecision( 2 ) << "[Shader] cache hit " << std::hex << key << std::dec
+      << ": loaded in " << load_time << " ms, saved " << std::max( header.BuildTime - load_time, 0.0 ) << " ms\n";
+   return true;
+}
+
+void ShaderGL::saveProgramBinary(uint64_t key, double build_time_in_ms) const
+{
+   GLint length = 0;
+   glGetProgramiv( ShaderProgram, GL_PROGRAM_BINARY_LENGTH, &length );
+   if (length <= 0) return;
+
+   ProgramBinaryHeader header{};
+   std::vector<char> binary(length);
+   glGetProgramBinary( ShaderProgram, length, nullptr, &header.Format, binary.data() );
+   header.Magic = ProgramBinaryMagic;
+   header.Length = static_cast<uint>(length);
+   header.BuildTime = build_time_in_ms;
+
+   std::error_code error;
+   std::filesystem::create_directories( getProgramCacheDirectory(), error );
+   std::ofstream file( getProgramCachePath( key ), std::ios::binary );
+   if (error || !file.is_open()) {
+      std::cerr << "Cannot write program cache: " << getProgramCachePath( key ) << "\n";
+      return;
+   }
+   file.write( reinterpret_cast<const char*>(&header), sizeof( header ) );
+   file.write( binary.data(), length );
+}
+
+void ShaderGL::installProgram(GLuint program)
+{
+   if (ShaderProgram != 0) glDeleteProgram( ShaderProgram );
+   ShaderProgram = program;
+   reflectUniforms();
+   setBasicTransformationUniforms();
+}
+
+void ShaderGL::beginShader(
+   const char* vertex_shader_path,
+   const char* fragment_shader_path,
+   const std::vector<std::string>& defines
+)
+{
+   const CpuProfiler::Zone zone( "Begin Shader Program" );
+
+   VertexShaderPath = vertex_shader_path;
+   FragmentShaderPath = fragment_shader_path;
+   Defines = defines;
+   if (PendingProgram != 0) {
+      glDeleteShader( PendingVertexShader );
+      glDeleteShader( PendingFragmentShader );
+      glDeleteProgram( PendingProgram );
+      PendingProgram = 0;
+   }
+
+   const auto vertex = ShaderPreprocessor::getExpandedSource( VertexShaderPath, Defines );
+   const auto fragment = ShaderPreprocessor::getExpandedSource( FragmentShaderPath, Defines );
+   const std::string& vertex_contents = vertex->Source;
+   const std::string& fragment_contents = fragment->Source;
+   ShaderFiles = vertex->Dependencies;
+   ShaderFiles.insert( ShaderFiles.end(), fragment->Dependencies.begin(), fragment->Dependencies.end() );
+
+   GLint binary_format_num = 0;
+   glGetIntegerv( GL_NUM_PROGRAM_BINARY_FORMATS, &binary_format_num );
+   const bool use_cache = binary_format_num > 0;
+   std::string define_set;
+   for (const auto& define : Defines) define_set += define + ";";
+   PendingKey = use_cache ? getProgramKey( { &vertex_contents, &fragment_contents }, define_set ) : 0;
+   const EmbeddedShaderFile* vertex_spirv = SpirVSupported ?
+      ShaderPreprocessor::findEmbeddedSpirV( VertexShaderPath, Defines ) : nullptr;
+   const EmbeddedShaderFile* fragment_spirv = SpirVSupported ?
+      ShaderPreprocessor::findEmbeddedSpirV( FragmentShaderPath, Defines ) : nullptr;
+   IsSpirVProgram = vertex_spirv != nullptr && fragment_spirv != nullptr;
+   if (use_cache && loadProgramBinary( PendingKey )) return;
+
+   // Nothing here queries a status, so with parallel shader compilation the driver keeps compiling and linking
+   // on its own threads until finishPendingProgram() sees GL_COMPLETION_STATUS_KHR.
+   PendingStartTime = std::chrono::steady_clock::now();
+   if (IsSpirVProgram) {
+      PendingVertexShader = getSpecializedShader( GL_VERTEX_SHADER, *vertex_spirv );
+      PendingFragmentShader = getSpecializedShader( GL_FRAGMENT_SHADER, *fragment_spirv );
+   }
+   else {
+      PendingVertexShader = getCompilingShader( GL_VERTEX_SHADER, vertex_contents );
+      PendingFragmentShader = getCompilingShader( GL_FRAGMENT_SHADER, fragment_contents );
+   }
+   PendingProgram = glCreateProgram();
+   if (use_cache) glProgramParameteri( PendingProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE );
+   glAttachShader( PendingProgram, PendingVertexShader );
+   glAttachShader( PendingProgram, PendingFragmentShader );
+   glLinkProgram( PendingProgram );
+}
+
+bool ShaderGL::finishPendingProgram(bool wait)
+{
+   if (PendingProgram == 0) return false;
+
+   if (!wait && ParallelCompileSupported) {
+      GLint completed = GL_FALSE;
+      glGetProgramiv( PendingProgram, GL_COMPLETION_STATUS_KHR, &completed );
+      if (completed == GL_FALSE) return false;
+   }
+
+   const CpuProfiler::Zone zone( "Finish Shader Program" );
+   const GLuint program = PendingProgram;
+   PendingProgram = 0;
+   const bool compiled = checkCompileError( GL_VERTEX_SHADER, PendingVertexShader ) &
+      checkCompileError( GL_FRAGMENT_SHADER, PendingFragmentShader );
+   glDeleteShader( PendingVertexShader );
+   glDeleteShader( PendingFragmentShader );
+   if (!compiled || !checkLinkError( program )) {
+      std::cerr << "Could not build shader program; keeping the previous one\n";
+      glDeleteProgram( program );
+      return false;
+   }
+
+   installProgram( program );
+   const double build_time =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - PendingStartTime).count();
+   if (PendingKey != 0) {
+      std::cout << std::fixed << std::setprecision( 2 ) << "[Shader] cache miss " << std::hex << PendingKey << std::dec
+         << ": compiled and linked in " << build_time << " ms\n";
+      saveProgramBinary( PendingKey, build_time );
+   }
+   return true;
+}
+
+void ShaderGL::setShader(
+   const char* vertex_shader_path,
+   const char* fragment_shader_path,
+   const std::vector<std::string>& defines
+)
+{
+   beginShader( vertex_shader_path, fragment_shader_path, defines );
+   waitForPendingProgram();
+}
+
+void ShaderGL::reload()
+{
+   std::cout << "[Shader] reloading " << VertexShaderPath << ", " << FragmentShaderPath << "\n";
+   ShaderPreprocessor::invalidate();
+   const std::string vertex_shader_path = VertexShaderPath;
+   const std::string fragment_shader_path = FragmentShaderPath;
+   const std::vector<std::string> defines = Defines;
+   beginShader( vertex_shader_path.c_str(), fragment_shader_path.c_str(), defines );
+}
+
+uint64_t ShaderGL::getNameHash(const char* name)
+{
+   uint64_t hash = 0xcbf29ce484222325ull;
+   for (; *name != '\0'; ++name) {
+      hash ^= static_cast<uchar>(*name);
+      hash *= 0x100000001b3ull;
+   }
+   return hash;
+}
+
+uint ShaderGL::getUniformTypeSize(GLenum type)
+{
+   switch (type) {
+      case GL_FLOAT_VEC2: case GL_INT_VEC2: case GL_UNSIGNED_INT_VEC2: case GL_BOOL_VEC2: return 8;
+      case GL_FLOAT_VEC3: case GL_INT_VEC3: case GL_UNSIGNED_INT_VEC3: case GL_BOOL_VEC3: return 12;
+      case GL_FLOAT_VEC4: case GL_INT_VEC4: case GL_UNSIGNED_INT_VEC4: case GL_BOOL_VEC4: case GL_FLOAT_MAT2: return 16;
+      case GL_FLOAT_MAT2x3: case GL_FLOAT_MAT3x2: return 24;
+      case GL_FLOAT_MAT2x4: case GL_FLOAT_MAT4x2: return 32;
+      case GL_FLOAT_MAT3: return 36;
+      case GL_FLOAT_MAT3x4: case GL_FLOAT_MAT4x3: return 48;
+      case GL_FLOAT_MAT4: return 64;
+      case GL_DOUBLE: return 8;
+      case GL_DOUBLE_VEC2: return 16;
+      case GL_DOUBLE_VEC3: return 24;
+      case GL_DOUBLE_VEC4: case GL_DOUBLE_MAT2: return 32;
+      case GL_DOUBLE_MAT3: return 72;
+      case GL_DOUBLE_MAT4: return 128;
+      // Scalars, booleans, samplers and images all take a single 32-bit value.
+      default: return 4;
+   }
+}
+
+template<typename T>
+int ShaderGL::findInTable(const std::vector<int>& table, const std::vector<T>& entries, const char* name)
+{
+   if (table.empty()) return -1;
+
+   const uint64_t hash = getNameHash( name );
+   const size_t mask = table.size() - 1;
+   for (size_t slot = hash & mask; table[slot] != 0; slot = (slot + 1) & mask) {
+      const T& entry = entries[table[slot] - 1];
+      if (entry.Hash == hash && entry.Name == name) return table[slot] - 1;
+   }
+   return -1;
+}
+
+template<typename T>
+void ShaderGL::buildTable(std::vector<int>& table, const std::vector<T>& entries)
+{
+   // Kept at most half full so that a probe sequence rarely goes beyond a couple of slots.
+   size_t capacity = 8;
+   while (capacity < entries.size() * 2) capacity *= 2;
+   table.assign( capacity, 0 );
+
+   const size_t mask = capacity - 1;
+   for (size_t i = 0; i < entries.size(); ++i) {
+      if (entries[i].Name.empty()) continue;
+
+      size_t slot = entries[i].Hash & mask;
+      while (table[slot] != 0) slot = (slot + 1) & mask;
+      table[slot] = static_cast<int>(i) + 1;
+   }
+}
+
+int ShaderGL::findUniform(const char* name) const
+{
+   return findInTable( UniformTable, Uniforms, name );
+}
+
+const ShaderGL::UniformInfo* ShaderGL::getUniformInfo(const char* name) const
+{
+   const int uniform = findUniform( name );
+   return uniform < 0 ? nullptr : &Uniforms[uniform];
+}
+
+const ShaderGL::UniformBlockInfo* ShaderGL::getUniformBlockInfo(const char* name) const
+{
+   const int block = findInTable( UniformBlockTable, UniformBlocks, name );
+   return block < 0 ? nullptr : &UniformBlocks[block];
+}
+
+int ShaderGL::addUniform(const std::string& name, GLint location, GLenum type, GLint array_size, GLint block_index)
+{
+   UniformInfo uniform;
+   uniform.Name = name;
+   uniform.Hash = getNameHash( name.c_str() );
+   uniform.Location = location;
+   uniform.Type = type;
+   uniform.ArraySize = std::max( array_size, 1 );
+   uniform.BlockIndex = block_index;
+   uniform.ValueOffset = static_cast<uint>(UniformValues.size());
+   uniform.ValueSize = location >= 0 ? getUniformTypeSize( type ) * uniform.ArraySize : 0;
+   uniform.Uploaded = false;
+   UniformValues.resize( UniformValues.size() + uniform.ValueSize );
+   Uniforms.emplace_back( uniform );
+   return static_cast<int>(Uniforms.size()) - 1;
+}
+
+void ShaderGL::reflectUniforms()
+{
+   // A new program starts from default uniform values, so nothing that was uploaded before is still valid.
+   Uniforms.clear();
+   UniformBlocks.clear();
+   UniformValues.clear();
+   CameraVersion = std::numeric_limits<uint64_t>::max();
+
+   GLint max_name_length = 0;
+   glGetProgramInterfaceiv( ShaderProgram, GL_UNIFORM, GL_MAX_NAME_LENGTH, &max_name_length );
+   GLint max_block_name_length = 0;
+   glGetProgramInterfaceiv( ShaderProgram, GL_UNIFORM_BLOCK, GL_MAX_NAME_LENGTH, &max_block_name_length );
+   std::vector<GLchar> name(std::max( { max_name_length, max_block_name_length, 1 } ));
+
+   GLint uniform_num = 0;
+   glGetProgramInterfaceiv( ShaderProgram, GL_UNIFORM, GL_ACTIVE_RESOURCES, &uniform_num );
+   const std::array<GLenum, 4> uniform_properties = { GL_LOCATION, GL_TYPE, GL_ARRAY_SIZE, GL_BLOCK_INDEX };
+   for (GLint i = 0; i < uniform_num; ++i) {
+      std::array<GLint, 4> values{};
+      glGetProgramResourceiv(
+         ShaderProgram, GL_UNIFORM, static_cast<GLuint>(i),
+         static_cast<GLsizei>(uniform_properties.size()), uniform_properties.data(),
+         static_cast<GLsizei>(values.size()), nullptr, values.data()
+      );
+      GLsizei length = 0;
+      glGetProgramResourceName(
+         ShaderProgram, GL_UNIFORM, static_cast<GLuint>(i), static_cast<GLsizei>(name.size()), &length, name.data()
+      );
+
+      // Arrays are reported as "Name[0]" but looked up by their plain name.
+      std::string uniform_name(name.data(), length);
+      if (uniform_name.size() > 3 && uniform_name.compare( uniform_name.size() - 3, 3, "[0]" ) == 0) {
+         uniform_name.resize( uniform_name.size() - 3 );
+      }
+      addUniform( uniform_name, values[0], static_cast<GLenum>(values[1]), values[2], values[3] );
+   }
+
+   GLint block_num = 0;
+   glGetProgramInterfaceiv( ShaderProgram, GL_UNIFORM_BLOCK, GL_ACTIVE_RESOURCES, &block_num );
+   const std::array<GLenum, 3> block_properties = { GL_BUFFER_BINDING, GL_BUFFER_DATA_SIZE, GL_NUM_ACTIVE_VARIABLES };
+   for (GLint i = 0; i < block_num; ++i) {
+      std::array<GLint, 3> values{};
+      glGetProgramResourceiv(
+         ShaderProgram, GL_UNIFORM_BLOCK, static_cast<GLuint>(i),
+         static_cast<GLsizei>(block_properties.size()), block_properties.data(),
+         static_cast<GLsizei>(values.size()), nullptr, values.data()
+      );
+      GLsizei length = 0;
+      glGetProgramResourceName(
+         ShaderProgram, GL_UNIFORM_BLOCK, static_cast<GLuint>(i), static_cast<GLsizei>(name.size()), &length, name.data()
+      );
+
+      UniformBlockInfo block;
+      block.Name.assign( name.data(), length );
+      block.Hash = getNameHash( block.Name.c_str() );
+      block.Binding = values[0];
+      block.DataSize = values[1];
+      block.ActiveUniformNum = values[2];
+      UniformBlocks.emplace_back( block );
+   }
+
+   buildTable( UniformTable, Uniforms );
+   buildTable( UniformBlockTable, UniformBlocks );
+}
+
+void ShaderGL::uploadUniform(GLint location, const GLint* values, int count) const
+{
+   glProgramUniform1iv( ShaderProgram, location, count, values );
+}
+
+void ShaderGL::uploadUniform(GLint location, const GLuint* values, int count) const
 {
-   const GLuint vertex_shader = getCompiledShader( GL_VERTEX_SHADER, vertex_shader_path );
-   const GLuint fragment_shader = getCompiledShader( GL_FRAGMENT_SHADER, fragment_shader_path );
-   ShaderProgram = glCreateProgram();
-   glAttachShader( ShaderProgram, vertex_shader );
-   glAttachShader( ShaderProgram, fragment_shader );
-   glLinkProgram( ShaderProgram );
-   glDeleteShader( vertex_shader );
-   glDeleteShader( fragment_shader );
+   glProgramUniform1uiv( ShaderProgram, location, count, values );
+}
+
+void ShaderGL::uploadUniform(GLint location, const float* values, int count) const
+{
+   glProgramUniform1fv( ShaderProgram, location, count, values );
+}
+
+void ShaderGL::uploadUniform(GLint location, const glm::vec2* values, int count) const
+{
+   glProgramUniform2fv( ShaderProgram, location, count, &values[0][0] );
+}
+
+void ShaderGL::uploadUniform(GLint location, const glm::vec3* values, int count) const
+{
+   glProgramUniform3fv( ShaderProgram, location, count, &values[0][0] );
+}
+
+void ShaderGL::uploadUniform(GLint location, const glm::vec4* values, int count) const
+{
+   glProgramUniform4fv( ShaderProgram, location, count, &values[0][0] );
+}
+
+void ShaderGL::uploadUniform(GLint location, const glm::ivec2* values, int count) const
+{
+   glProgramUniform2iv( ShaderProgram, location, count, &values[0][0] );
+}
+
+void ShaderGL::uploadUniform(GLint location, const glm::ivec3* values, int count) const
+{
+   glProgramUniform3iv( ShaderProgram, location, count, &values[0][0] );
+}
+
+void ShaderGL::uploadUniform(GLint location, const glm::ivec4* values, int count) const
+{
+   glProgramUniform4iv( ShaderProgram, location, count, &values[0][0] );
+}
+
+void ShaderGL::uploadUniform(GLint location, const glm::mat3* values, int count) const
+{
+   glProgramUniformMatrix3fv( ShaderProgram, location, count, GL_FALSE, &values[0][0][0] );
+}
+
+void ShaderGL::uploadUniform(GLint location, const glm::mat4* values, int count) const
+{
+   glProgramUniformMatrix4fv( ShaderProgram, location, count, GL_FALSE, &values[0][0][0] );
 }
 
 void ShaderGL::setBasicTransformationUniforms()
 {
-   Location.World = glGetUniformLocation( ShaderProgram, "WorldMatrix" );
-   Location.View = glGetUniformLocation( ShaderProgram, "ViewMatrix" );
-   Location.Projection = glGetUniformLocation( ShaderProgram, "ProjectionMatrix" );
-   Location.ModelViewProjection = glGetUniformLocation( ShaderProgram, "ModelViewProjectionMatrix" );
-   Location.Color = glGetUniformLocation( ShaderProgram, "Color" );
+   // Drivers may drop uniform names of SPIR-V programs, in which case the locations in BasicTransforms.glsl apply.
+   const auto find_basic_uniform = [this](const char* name, GLenum type, GLint explicit_location) {
+      const int uniform = findUniform( name );
+      if (uniform >= 0 || !IsSpirVProgram || explicit_location < 0) return uniform;
+      return addUniform( name, explicit_location, type, 1, -1 );
+   };
+   const bool has_normal_matrix =
+      std::find( Defines.begin(), Defines.end(), "PRECOMPUTED_NORMAL_MATRIX" ) != Defines.end();
+   Basic.World = find_basic_uniform( "WorldMatrix", GL_FLOAT_MAT4, 1 );
+   Basic.View = find_basic_uniform( "ViewMatrix", GL_FLOAT_MAT4, 2 );
+   Basic.Projection = find_basic_uniform( "ProjectionMatrix", GL_FLOAT_MAT4, 3 );
+   Basic.ModelViewProjection = find_basic_uniform( "ModelViewProjectionMatrix", GL_FLOAT_MAT4, 4 );
+   Basic.Normal = find_basic_uniform( "NormalMatrix", GL_FLOAT_MAT3, has_normal_matrix ? 5 : -1 );
+   Basic.Color = find_basic_uniform( "Color", GL_FLOAT_VEC4, 0 );
+   buildTable( UniformTable, Uniforms );
 }
 
-void ShaderGL::transferBasicTransformationUniforms(const glm::mat4& to_world, const CameraGL* camera, const glm::vec4& color) const
+void ShaderGL::transferBasicTransformationUniforms(
+   const glm::mat4& to_world,
+   const glm::mat4& view,
+   const glm::mat4& projection,
+   const glm::mat4& view_projection,
+   uint64_t camera_version,
+   const glm::vec4& color
+)
 {
-   const glm::mat4 view = camera->getViewMatrix();
-   const glm::mat4 projection = camera->getProjectionMatrix();
-   const glm::mat4 model_view_projection = projection * view * to_world;
-   glUniformMatrix4fv( Location.World, 1, GL_FALSE, &to_world[0][0] );
-   glUniformMatrix4fv( Location.View, 1, GL_FALSE, &view[0][0] );
-   glUniformMatrix4fv( Location.Projection, 1, GL_FALSE, &projection[0][0] );
-   glUniformMatrix4fv( Location.ModelViewProjection, 1, GL_FALSE, &model_view_projection[0][0] );
-   glUniform4fv( Location.Color, 1, &color[0] );
+   setUniform( Basic.World, to_world );
+   if (camera_version != CameraVersion) {
+      setUniform( Basic.View, view );
+      setUniform( Basic.Projection, projection );
+      CameraVersion = camera_version;
+   }
+   setUniform( Basic.ModelViewProjection, view_projection * to_world );
+   if (Basic.Normal >= 0) {
+      const glm::mat3 normal_matrix = transpose( inverse( glm::mat3(view * to_world) ) );
+      setUniform( Basic.Normal, normal_matrix );
+   }
+   setUniform( Basic.Color, color );
 }
\ No newline at end of file
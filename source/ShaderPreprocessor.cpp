@@ -0,0 +1,151 @@
+#include "ShaderPreprocessor.h"
+
+std::string ShaderPreprocessor::getPermutationKey(const std::string& file_path, const std::vector<std::string>& defines)
+{
+   std::vector<std::string> sorted_defines = defines;
+   std::sort( sorted_defines.begin(), sorted_defines.end() );
+   std::string key = std::filesystem::absolute( file_path ).lexically_normal().string();
+   for (const auto& define : sorted_defines) key += ";" + define;
+   return key;
+}
+
+std::shared_ptr<const ShaderPreprocessor::ExpandedSource> ShaderPreprocessor::getExpandedSource(
+   const std::string& file_path,
+   const std::vector<std::string>& defines
+)
+{
+   const std::string key = getPermutationKey( file_path, defines );
+   {
+      std::lock_guard<std::mutex> lock( CacheMutex );
+      const auto it = PermutationCache.find( key );
+      if (it != PermutationCache.end()) return it->second;
+   }
+
+   const CpuProfiler::Zone zone( "Preprocess Shader" );
+   std::string define_lines;
+   for (const auto& define : defines) {
+      // "NAME=VALUE" becomes "#define NAME VALUE".
+      std::string line = define;
+      const size_t assignment = line.find( '=' );
+      if (assignment != std::string::npos) line[assignment] = ' ';
+      define_lines += "#define " + line + "\n";
+   }
+
+   auto expanded = std::make_shared<ExpandedSource>();
+   std::set<std::filesystem::path> included_files;
+   if (!expand( *expanded, included_files, std::filesystem::absolute( file_path ).lexically_normal(), define_lines, 0 )) {
+      expanded->Source.clear();
+   }
+
+   std::lock_guard<std::mutex> lock( CacheMutex );
+   return PermutationCache.emplace( key, std::move( expanded ) ).first->second;
+}
+
+void ShaderPreprocessor::invalidate()
+{
+   std::lock_guard<std::mutex> lock( CacheMutex );
+   PermutationCache.clear();
+}
+
+std::string ShaderPreprocessor::getEmbeddedName(const std::filesystem::path& file_path)
+{
+   const std::filesystem::path shader_directory = std::filesystem::path(CMAKE_SOURCE_DIR) / "shaders";
+   return file_path.lexically_relative( shader_directory.lexically_normal() ).generic_string();
+}
+
+const EmbeddedShaderFile* ShaderPreprocessor::findEmbeddedSpirV(
+   const std::string& file_path,
+   const std::vector<std::string>& defines
+)
+{
+   if (!UseEmbeddedSources) return nullptr;
+
+   std::vector<std::string> sorted_defines = defines;
+   std::sort( sorted_defines.begin(), sorted_defines.end() );
+   std::string key = getEmbeddedName( std::filesystem::absolute( file_path ).lexically_normal() );
+   for (const auto& define : sorted_defines) key += "," + define;
+   for (const auto& binary : EmbeddedSpirVBinaries) {
+      if (key == binary.Name) return &binary;
+   }
+   return nullptr;
+}
+
+bool ShaderPreprocessor::readFile(std::string& contents, const std::filesystem::path& file_path)
+{
+   if (UseEmbeddedSources) {
+      const std::string name = getEmbeddedName( file_path );
+      for (const auto& source : EmbeddedShaderSources) {
+         if (name == source.Name) {
+            contents.assign( source.Contents, source.Size );
+            return true;
+         }
+      }
+   }
+
+   std::ifstream file( file_path, std::ios::in | std::ios::binary );
+   if (!file.is_open()) return false;
+
+   std::ostringstream stream;
+   stream << file.rdbuf();
+   contents = stream.str();
+   return true;
+}
+
+bool ShaderPreprocessor::expand(
+   ExpandedSource& expanded,
+   std::set<std::filesystem::path>& included_files,
+   const std::filesystem::path& file_path,
+   const std::string& define_lines,
+   int depth
+)
+{
+   // Every file is included at most once per permutation, which also breaks include cycles.
+   if (!included_files.emplace( file_path ).second) return true;
+   if (depth > MaxIncludeDepth) {
+      std::cerr << "Shader includes are nested too deeply: " << file_path.string() << "\n";
+      return false;
+   }
+
+   std::string contents;
+   if (!readFile( contents, file_path )) {
+      std::cerr << "Cannot open shader file: " << file_path.string() << "\n";
+      return false;
+   }
+   expanded.Dependencies.emplace_back( file_path.string() );
+
+   const auto source_number = static_cast<int>(expanded.Dependencies.size() - 1);
+   if (depth > 0) expanded.Source += "#line 1 " + std::to_string( source_number ) + "\n";
+   std::istringstream stream( contents );
+   std::string line;
+   int line_number = 0;
+   while (std::getline( stream, line )) {
+      line_number++;
+      const size_t first = line.find_first_not_of( " \t" );
+      // Only the offline SPIR-V compiler needs this extension to accept #include.
+      if (first != std::string::npos && line.compare( first, 38, "#extension GL_GOOGLE_include_directive" ) == 0) {
+         expanded.Source += '\n';
+         continue;
+      }
+      if (first != std::string::npos && line.compare( first, 8, "#include" ) == 0) {
+         const size_t open = line.find( '"', first + 8 );
+         const size_t close = open == std::string::npos ? open : line.find( '"', open + 1 );
+         if (close == std::string::npos) {
+            std::cerr << file_path.string() << ":" << line_number << ": malformed #include\n";
+            return false;
+         }
+         const std::filesystem::path include_path =
+            (file_path.parent_path() / line.substr( open + 1, close - open - 1 )).lexically_normal();
+         if (!expand( expanded, included_files, include_path, "", depth + 1 )) return false;
+         expanded.Source += "#line " + std::to_string( line_number + 1 ) + " " + std::to_string( source_number ) + "\n";
+         continue;
+      }
+
+      expanded.Source += line;
+      expanded.Source += '\n';
+      if (!define_lines.empty() && first != std::string::npos && line.compare( first, 8, "#version" ) == 0) {
+         expanded.Source += define_lines;
+         expanded.Source += "#line " + std::to_string( line_number + 1 ) + " " + std::to_string( source_number ) + "\n";
+      }
+   }
+   return true;
+}
@@ -0,0 +1,258 @@
+#include "SingularitySweep.h"
+
+SingularitySweep::Statistics::Statistics() : SampleNum( 0 ), SingularSampleNum( 0 ), Sums{}
+{
+   Minima.fill( std::numeric_limits<float>::infinity() );
+   Maxima.fill( 0.0f );
+   for (auto& histogram : Histograms) histogram.resize( HistogramBinNum, 0 );
+}
+
+void SingularitySweep::Statistics::add(const GimbalMetricArrays& metrics, size_t count)
+{
+   const std::array<const float*, MetricNum> values = {
+      metrics.ConditionNumber, metrics.SingularityDistance, metrics.InterpolationDivergence
+   };
+   SampleNum += count;
+   for (int k = 0; k < MetricNum; ++k) {
+      double sum = 0.0;
+      float minimum = Minima[k], maximum = Maxima[k];
+      std::vector<uint64_t>& histogram = Histograms[k];
+      for (size_t i = 0; i < count; ++i) {
+         const float value = values[k][i];
+         if (k == ConditionNumber && !(value < std::numeric_limits<float>::infinity())) {
+            ++SingularSampleNum;
+            ++histogram[HistogramBinNum - 1];
+            continue;
+         }
+         sum += value;
+         minimum = std::min( minimum, value );
+         maximum = std::max( maximum, value );
+         ++histogram[getHistogramBin( k, value )];
+      }
+      Sums[k] += sum;
+      Minima[k] = minimum;
+      Maxima[k] = maximum;
+   }
+}
+
+void SingularitySweep::Statistics::merge(const Statistics& other)
+{
+   SampleNum += other.SampleNum;
+   SingularSampleNum += other.SingularSampleNum;
+   for (int k = 0; k < MetricNum; ++k) {
+      Sums[k] += other.Sums[k];
+      Minima[k] = std::min( Minima[k], other.Minima[k] );
+      Maxima[k] = std::max( Maxima[k], other.Maxima[k] );
+      for (size_t i = 0; i < HistogramBinNum; ++i) Histograms[k][i] += other.Histograms[k][i];
+   }
+}
+
+float SingularitySweep::getAngle(size_t index, size_t sample_num)
+{
+   // Cell centers, so that -pi and pi are not both sampled.
+   const double step = 2.0 * glm::pi<double>() / static_cast<double>(sample_num);
+   return static_cast<float>(-glm::pi<double>() + (static_cast<double>(index) + 0.5) * step);
+}
+
+size_t SingularitySweep::getHistogramBin(int metric, float value)
+{
+   if (metric == ConditionNumber) {
+      uint32_t bits, minimum_bits;
+      const float minimum = 3.0f;
+      std::memcpy( &bits, &value, sizeof( bits ) );
+      std::memcpy( &minimum_bits, &minimum, sizeof( minimum_bits ) );
+      if (bits <= minimum_bits) return 0;
+      return std::min( size_t{ (bits - minimum_bits) >> ConditionBinShift }, HistogramBinNum - 1 );
+   }
+   const float bin_per_value = static_cast<float>(HistogramBinNum) / HistogramRanges[metric];
+   const auto bin = static_cast<size_t>(std::max( value, 0.0f ) * bin_per_value);
+   return std::min( bin, HistogramBinNum - 1 );
+}
+
+float SingularitySweep::getHistogramBinValue(int metric, size_t bin)
+{
+   if (metric == ConditionNumber) {
+      const float minimum = 3.0f;
+      uint32_t bits;
+      std::memcpy( &bits, &minimum, sizeof( bits ) );
+      bits += static_cast<uint32_t>(((2 * bin + 1) << ConditionBinShift) / 2);
+      float value;
+      std::memcpy( &value, &bits, sizeof( value ) );
+      return value;
+   }
+   return (static_cast<float>(bin) + 0.5f) / static_cast<float>(HistogramBinNum) * HistogramRanges[metric];
+}
+
+float SingularitySweep::getPercentile(const Statistics& statistics, int metric, double fraction)
+{
+   const auto target = static_cast<uint64_t>(fraction * static_cast<double>(statistics.SampleNum));
+   const std::vector<uint64_t>& histogram = statistics.Histograms[metric];
+   uint64_t count = 0;
+   size_t bin = 0;
+   for (; bin + 1 < HistogramBinNum; ++bin) {
+      count += histogram[bin];
+      if (count > target) break;
+   }
+   // The bin center may lie beyond the samples in the bin.
+   return std::clamp( getHistogramBinValue( metric, bin ), statistics.Minima[metric], statistics.Maxima[metric] );
+}
+
+void SingularitySweep::sweepRow(
+   const Settings& settings,
+   const std::vector<float>& rolls,
+   int row,
+   Heatmaps& heatmaps,
+   Workspace& workspace
+)
+{
+   const size_t pitch_num = settings.SampleNum[0];
+   const size_t roll_num = settings.SampleNum[1];
+   const size_t yaw_num = settings.SampleNum[2];
+   const auto height = static_cast<size_t>(heatmaps.Height);
+   const auto width = static_cast<size_t>(heatmaps.Width);
+   const size_t pitch_begin = row * pitch_num / height;
+   const size_t pitch_end = (row + 1) * pitch_num / height;
+   const GimbalMetricArrays metrics{
+      workspace.Metrics[ConditionNumber].data(),
+      workspace.Metrics[SingularityDistance].data(),
+      workspace.Metrics[InterpolationDivergence].data()
+   };
+   for (size_t column = 0; column < width; ++column) {
+      const size_t yaw_begin = column * yaw_num / width;
+      const size_t yaw_end = (column + 1) * yaw_num / width;
+      std::array<float, MetricNum> cell = { 0.0f, std::numeric_limits<float>::infinity(), 0.0f };
+      for (size_t i = pitch_begin; i < pitch_end; ++i) {
+         for (size_t j = yaw_begin; j < yaw_end; ++j) {
+            const auto batch_size = static_cast<std::ptrdiff_t>(std::min( BatchSize, roll_num ));
+            std::fill_n( workspace.Pitches.begin(), batch_size, getAngle( i, pitch_num ) );
+            std::fill_n( workspace.Yaws.begin(), batch_size, getAngle( j, yaw_num ) );
+            for (size_t k = 0; k < roll_num; k += BatchSize) {
+               const size_t count = std::min( BatchSize, roll_num - k );
+               const EulerAngleArrays angles{ workspace.Pitches.data(), rolls.data() + k, workspace.Yaws.data() };
+               RotationKernels::getGimbalMetrics( angles, settings.InterpolationStep, metrics, count );
+               workspace.Summary.add( metrics, count );
+               for (size_t s = 0; s < count; ++s) {
+                  cell[ConditionNumber] = std::max( cell[ConditionNumber], metrics.ConditionNumber[s] );
+                  cell[SingularityDistance] = std::min( cell[SingularityDistance], metrics.SingularityDistance[s] );
+                  cell[InterpolationDivergence] = std::max(
+                     cell[InterpolationDivergence], metrics.InterpolationDivergence[s]
+                  );
+               }
+            }
+         }
+      }
+      for (int k = 0; k < MetricNum; ++k) heatmaps.Cells[k][row * width + column] = cell[k];
+   }
+}
+
+bool SingularitySweep::writeHeatmap(const std::string& file_path, const Heatmaps& heatmaps, int metric)
+{
+   // Black through red and yellow to white, scaled to the largest finite cell so that the structure is visible.
+   // Condition numbers span orders of magnitude and are drawn as log( kappa / 3 ).
+   const auto to_scale = [metric](float value) { return metric == ConditionNumber ? std::log( value / 3.0f ) : value; };
+   float max_value = 0.0f;
+   for (const float value : heatmaps.Cells[metric]) {
+      if (value < std::numeric_limits<float>::infinity()) max_value = std::max( max_value, value );
+   }
+   const float scale = 3.0f / std::max( to_scale( max_value ), std::numeric_limits<float>::min() );
+   FIBITMAP* image = FreeImage_Allocate( heatmaps.Width, heatmaps.Height, 24 );
+   if (image == nullptr) return false;
+
+   for (int y = 0; y < heatmaps.Height; ++y) {
+      BYTE* pixel = FreeImage_GetScanLine( image, y );
+      for (int x = 0; x < heatmaps.Width; ++x) {
+         const float cell = heatmaps.Cells[metric][static_cast<size_t>(y) * heatmaps.Width + x];
+         const float value = std::clamp( to_scale( std::min( cell, max_value ) ) * scale, 0.0f, 3.0f );
+         pixel[FI_RGBA_RED] = static_cast<BYTE>(255.0f * std::clamp( value, 0.0f, 1.0f ) + 0.5f);
+         pixel[FI_RGBA_GREEN] = static_cast<BYTE>(255.0f * std::clamp( value - 1.0f, 0.0f, 1.0f ) + 0.5f);
+         pixel[FI_RGBA_BLUE] = static_cast<BYTE>(255.0f * std::clamp( value - 2.0f, 0.0f, 1.0f ) + 0.5f);
+         pixel += 3;
+      }
+   }
+   const bool saved = FreeImage_Save( FIF_PNG, image, file_path.c_str() ) != FALSE;
+   FreeImage_Unload( image );
+   if (saved) {
+      std::cout << "[Sweep] " << file_path << " (white is ";
+      if (metric == ConditionNumber) std::cout << "a condition number of " << max_value << " or more)\n";
+      else std::cout << glm::degrees( max_value ) << " deg)\n";
+   }
+   return saved;
+}
+
+void SingularitySweep::printStatistics(const Statistics& statistics)
+{
+   const std::array<const char*, MetricNum> names = {
+      "condition number", "distance to singularity (deg)", "interpolation divergence (deg)"
+   };
+   const auto to_output = [](int metric, float value) {
+      return metric == ConditionNumber ? value : glm::degrees( value );
+   };
+   std::cout << std::defaultfloat
+      << "[Sweep] " << statistics.SingularSampleNum << " samples are exactly gimbal-locked\n"
+      << "[Sweep] " << std::left << std::setw( 32 ) << "metric" << std::right
+      << std::setw( 12 ) << "min" << std::setw( 12 ) << "mean" << std::setw( 12 ) << "p50"
+      << std::setw( 12 ) << "p99" << std::setw( 12 ) << "max" << "\n";
+   for (int k = 0; k < MetricNum; ++k) {
+      // Infinite condition numbers are left out of the mean but not of the percentiles.
+      const uint64_t summed_num = k == ConditionNumber ? statistics.SampleNum - statistics.SingularSampleNum :
+         statistics.SampleNum;
+      const double mean = statistics.Sums[k] / static_cast<double>(std::max( summed_num, uint64_t{ 1 } ));
+      std::cout << "[Sweep] " << std::left << std::setw( 32 ) << names[k] << std::right << std::setprecision( 6 )
+         << std::setw( 12 ) << to_output( k, statistics.Minima[k] ) << std::setw( 12 ) << to_output( k, static_cast<float>(mean) )
+         << std::setw( 12 ) << to_output( k, getPercentile( statistics, k, 0.5 ) )
+         << std::setw( 12 ) << to_output( k, getPercentile( statistics, k, 0.99 ) )
+         << std::setw( 12 ) << to_output( k, statistics.Maxima[k] ) << "\n";
+   }
+}
+
+bool SingularitySweep::run(const Settings& settings)
+{
+   const size_t pitch_num = std::max( settings.SampleNum[0], size_t{ 1 } );
+   const size_t roll_num = std::max( settings.SampleNum[1], size_t{ 1 } );
+   const size_t yaw_num = std::max( settings.SampleNum[2], size_t{ 1 } );
+   Settings clamped_settings = settings;
+   clamped_settings.SampleNum = { pitch_num, roll_num, yaw_num };
+
+   Heatmaps heatmaps;
+   heatmaps.Height = static_cast<int>(std::min( static_cast<size_t>(std::max( settings.HeatmapSize, 1 )), pitch_num ));
+   heatmaps.Width = static_cast<int>(std::min( static_cast<size_t>(std::max( settings.HeatmapSize, 1 )), yaw_num ));
+   for (auto& cells : heatmaps.Cells) cells.resize( static_cast<size_t>(heatmaps.Width) * heatmaps.Height );
+
+   std::vector<float> rolls(roll_num);
+   for (size_t i = 0; i < roll_num; ++i) rolls[i] = getAngle( i, roll_num );
+
+   TaskScheduler scheduler( settings.ThreadNum );
+   std::vector<std::unique_ptr<Workspace>> workspaces;
+   for (int i = 0; i < scheduler.getThreadNum(); ++i) workspaces.emplace_back( std::make_unique<Workspace>() );
+
+   const uint64_t sample_num = static_cast<uint64_t>(pitch_num) * roll_num * yaw_num;
+   std::cout << "[Sweep] " << pitch_num << " x " << roll_num << " x " << yaw_num << " (pitch x roll x yaw) = "
+      << sample_num << " samples, interpolation step " << glm::degrees( settings.InterpolationStep ) << " deg, "
+      << scheduler.getThreadNum() << " threads, "
+      << RotationKernels::getInstructionSetName( RotationKernels::getInstructionSet() ) << " kernels\n";
+
+   const auto start = std::chrono::steady_clock::now();
+   scheduler.parallelFor( 0, static_cast<size_t>(heatmaps.Height), 1, [&](size_t begin, size_t end, int thread_index) {
+      for (size_t row = begin; row < end; ++row) {
+         sweepRow( clamped_settings, rolls, static_cast<int>(row), heatmaps, *workspaces[thread_index] );
+      }
+   } );
+   const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+   Statistics statistics;
+   for (const auto& workspace : workspaces) statistics.merge( workspace->Summary );
+   std::cout << std::fixed << std::setprecision( 3 ) << "[Sweep] done in " << seconds << " s, "
+      << static_cast<double>(sample_num) / seconds * 1e-6 << " million samples per second\n";
+   printStatistics( statistics );
+
+   std::error_code error;
+   std::filesystem::create_directories( settings.OutputDirectoryPath, error );
+   bool written = true;
+   written &= writeHeatmap( settings.OutputDirectoryPath + "/condition_number.png", heatmaps, ConditionNumber );
+   written &= writeHeatmap( settings.OutputDirectoryPath + "/singularity_distance.png", heatmaps, SingularityDistance );
+   written &= writeHeatmap(
+      settings.OutputDirectoryPath + "/interpolation_divergence.png", heatmaps, InterpolationDivergence
+   );
+   if (!written) std::cerr << "[Sweep] could not write the heatmaps to " << settings.OutputDirectoryPath << "\n";
+   return written;
+}
\ No newline at end of file
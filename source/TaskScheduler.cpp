@@ -0,0 +1,127 @@
+#include "TaskScheduler.h"
+
+TaskScheduler::TaskScheduler(int thread_num) :
+   StopWorkers( false ), JobIndex( 0 ), GrainSize( 1 ), RemainingNum( 0 ), PendingNum( 0 ), IdleNum( 0 )
+{
+   if (thread_num <= 0) thread_num = std::max( static_cast<int>(std::thread::hardware_concurrency()), 1 );
+   for (int i = 0; i < thread_num; ++i) Workers.emplace_back( std::make_unique<Worker>() );
+   for (int i = 1; i < thread_num; ++i) Workers[i]->Thread = std::thread( &TaskScheduler::workLoop, this, i );
+}
+
+TaskScheduler::~TaskScheduler()
+{
+   {
+      std::lock_guard<std::mutex> lock( JobMutex );
+      StopWorkers = true;
+   }
+   JobCondition.notify_all();
+   for (auto& worker : Workers) {
+      if (worker->Thread.joinable()) worker->Thread.join();
+   }
+}
+
+bool TaskScheduler::takeRange(int thread_index, Range& range)
+{
+   {
+      Worker& own = *Workers[thread_index];
+      std::lock_guard<std::mutex> lock( own.Mutex );
+      if (!own.Ranges.empty()) {
+         range = own.Ranges.back();
+         own.Ranges.pop_back();
+         PendingNum.fetch_sub( 1 );
+         return true;
+      }
+   }
+   const auto worker_num = static_cast<int>(Workers.size());
+   for (int i = 1; i < worker_num; ++i) {
+      Worker& victim = *Workers[(thread_index + i) % worker_num];
+      std::lock_guard<std::mutex> lock( victim.Mutex );
+      if (!victim.Ranges.empty()) {
+         range = victim.Ranges.front();
+         victim.Ranges.pop_front();
+         PendingNum.fetch_sub( 1 );
+         return true;
+      }
+   }
+   return false;
+}
+
+// PendingNum and RemainingNum are changed before IdleNum is read, and IdleNum before they are read, all sequentially
+// consistent, so either the idle thread sees the new range or the pushing thread sees the idle one and wakes it.
+void TaskScheduler::waitForRange()
+{
+   std::unique_lock<std::mutex> lock( IdleMutex );
+   IdleNum.fetch_add( 1 );
+   IdleCondition.wait( lock, [this] { return PendingNum.load() > 0 || RemainingNum.load() == 0; } );
+   IdleNum.fetch_sub( 1 );
+}
+
+void TaskScheduler::wakeIdleThreads(bool all)
+{
+   if (IdleNum.load() == 0) return;
+   {
+      // An idle thread between checking and sleeping holds the mutex, so it cannot miss the notification.
+      std::lock_guard<std::mutex> lock( IdleMutex );
+   }
+   if (all) IdleCondition.notify_all();
+   else IdleCondition.notify_one();
+}
+
+void TaskScheduler::work(int thread_index)
+{
+   Worker& own = *Workers[thread_index];
+   Range range{};
+   while (RemainingNum.load() > 0) {
+      if (!takeRange( thread_index, range )) {
+         waitForRange();
+         continue;
+      }
+      while (range.End - range.Begin > GrainSize) {
+         const size_t middle = range.Begin + (range.End - range.Begin) / 2;
+         {
+            std::lock_guard<std::mutex> lock( own.Mutex );
+            own.Ranges.push_back( { middle, range.End } );
+         }
+         PendingNum.fetch_add( 1 );
+         wakeIdleThreads( false );
+         range.End = middle;
+      }
+      Job( range.Begin, range.End, thread_index );
+      const size_t size = range.End - range.Begin;
+      if (RemainingNum.fetch_sub( size ) == size) wakeIdleThreads( true );
+   }
+}
+
+void TaskScheduler::workLoop(int thread_index)
+{
+   CpuProfiler::setThreadName( ("Task Worker " + std::to_string( thread_index )).c_str() );
+   uint64_t done_job_index = 0;
+   while (true) {
+      {
+         std::unique_lock<std::mutex> lock( JobMutex );
+         JobCondition.wait( lock, [this, done_job_index] { return StopWorkers || JobIndex != done_job_index; } );
+         if (StopWorkers) return;
+         done_job_index = JobIndex;
+      }
+      work( thread_index );
+   }
+}
+
+void TaskScheduler::run(size_t begin, size_t end, size_t grain_size, std::function<void(size_t, size_t, int)> job)
+{
+   // The workers only read Job and GrainSize after they were woken up, and the previous job is finished by now.
+   Job = std::move( job );
+   GrainSize = grain_size;
+   {
+      std::lock_guard<std::mutex> lock( Workers[0]->Mutex );
+      Workers[0]->Ranges.push_back( { begin, end } );
+   }
+   PendingNum.fetch_add( 1 );
+   RemainingNum.store( end - begin );
+   {
+      std::lock_guard<std::mutex> lock( JobMutex );
+      ++JobIndex;
+   }
+   JobCondition.notify_all();
+   work( 0 );
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include "ThumbnailAtlas.h"
+
+ThumbnailAtlasGL::ThumbnailAtlasGL() : FBO( 0 ), ColorTexture( 0 ), DepthBuffer( 0 ), SlotWidth( 0 ), SlotHeight( 0 )
+{
+}
+
+ThumbnailAtlasGL::~ThumbnailAtlasGL()
+{
+   destroy();
+}
+
+bool ThumbnailAtlasGL::create(int slot_width, int slot_height, int slot_num)
+{
+   destroy();
+
+   SlotWidth = slot_width;
+   SlotHeight = slot_height;
+   const int width = slot_width * slot_num;
+   glCreateTextures( GL_TEXTURE_2D, 1, &ColorTexture );
+   glTextureStorage2D( ColorTexture, 1, GL_RGBA8, width, slot_height );
+   glCreateRenderbuffers( 1, &DepthBuffer );
+   glNamedRenderbufferStorage( DepthBuffer, GL_DEPTH_COMPONENT24, width, slot_height );
+   glCreateFramebuffers( 1, &FBO );
+   glNamedFramebufferTexture( FBO, GL_COLOR_ATTACHMENT0, ColorTexture, 0 );
+   glNamedFramebufferRenderbuffer( FBO, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, DepthBuffer );
+   if (glCheckNamedFramebufferStatus( FBO, GL_FRAMEBUFFER ) != GL_FRAMEBUFFER_COMPLETE) {
+      std::cout << "The thumbnail atlas is incomplete; thumbnails are drawn every frame.\n";
+      destroy();
+      return false;
+   }
+   ValidSlots.assign( static_cast<size_t>(slot_num), false );
+   return true;
+}
+
+void ThumbnailAtlasGL::destroy()
+{
+   if (FBO != 0) glDeleteFramebuffers( 1, &FBO );
+   if (DepthBuffer != 0) glDeleteRenderbuffers( 1, &DepthBuffer );
+   if (ColorTexture != 0) glDeleteTextures( 1, &ColorTexture );
+   FBO = DepthBuffer = ColorTexture = 0;
+   ValidSlots.clear();
+}
+
+void ThumbnailAtlasGL::beginSlot(int slot)
+{
+   assert( isCreated() );
+
+   glBindFramebuffer( GL_FRAMEBUFFER, FBO );
+   glViewport( slot * SlotWidth, 0, SlotWidth, SlotHeight );
+   glEnable( GL_SCISSOR_TEST );
+   glScissor( slot * SlotWidth, 0, SlotWidth, SlotHeight );
+   glClear( OPENGL_COLOR_BUFFER_BIT | OPENGL_DEPTH_BUFFER_BIT );
+   glDisable( GL_SCISSOR_TEST );
+   ValidSlots[slot] = true;
+}
+
+void ThumbnailAtlasGL::endSlots() const
+{
+   glBindFramebuffer( GL_FRAMEBUFFER, 0 );
+}
+
+void ThumbnailAtlasGL::blit(int x, int y) const
+{
+   const int width = SlotWidth * getSlotNum();
+   glBlitNamedFramebuffer(
+      FBO, 0, 0, 0, width, SlotHeight, x, y, x + width, y + SlotHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST
+   );
+}
\ No newline at end of file
@@ -0,0 +1,135 @@
+#include "TimelineEvaluator.h"
+
+TimelineEvaluator::TimelineEvaluator(int thread_num) : Scheduler( thread_num )
+{
+   Workspaces.resize( static_cast<size_t>(Scheduler.getThreadNum()) );
+   for (auto& workspace : Workspaces) {
+      workspace.Times.resize( ChunkSize );
+      workspace.T.resize( ChunkSize );
+      for (auto& keys : workspace.Keys) keys.resize( ChunkSize );
+   }
+}
+
+void TimelineEvaluator::evaluateChunk(
+   const Timeline& timeline,
+   size_t begin,
+   size_t end,
+   const SampleArrays& samples,
+   Workspace& workspace
+)
+{
+   const size_t count = end - begin;
+   KeyframeCursor euler_angle_cursor;
+   for (size_t i = 0; i < count; ++i) {
+      const OrientateRotation::Value angle = timeline.EulerAngles->evaluate(
+         workspace.Times[i], euler_angle_cursor,
+         [](const glm::vec3& a, const glm::vec3& b, float t) { return OrientateRotation::interpolate( a, b, t ); }
+      );
+      for (int k = 0; k < 3; ++k) samples.EulerAngles[k][begin + i] = angle[k];
+   }
+
+   const QuaternionArrays quaternions{
+      samples.Quaternions.W + begin, samples.Quaternions.X + begin,
+      samples.Quaternions.Y + begin, samples.Quaternions.Z + begin
+   };
+   if (timeline.Spline != nullptr) {
+      timeline.Spline->evaluate( *timeline.Quaternions, workspace.Times.data(), count, quaternions );
+      return;
+   }
+
+   // The keys around every sample are gathered first, so that the polynomial slerp runs over the chunk in SIMD.
+   const KeyframeTrack<glm::quat>& track = *timeline.Quaternions;
+   const size_t key_num = track.getKeyNum();
+   KeyframeCursor quaternion_cursor;
+   for (size_t i = 0; i < count; ++i) {
+      glm::quat from(1.0f, 0.0f, 0.0f, 0.0f), to(1.0f, 0.0f, 0.0f, 0.0f);
+      float t = 0.0f;
+      if (key_num == 1) from = to = track.getValue( 0 );
+      else if (key_num > 1) {
+         const size_t key = track.findSegment( workspace.Times[i], quaternion_cursor, t );
+         const bool last = key + 1 == key_num;
+         from = track.getValue( key );
+         to = last && !track.isLooping() ? from : track.getValue( last ? 0 : key + 1 );
+      }
+      const std::array<float, 8> values = { from.w, from.x, from.y, from.z, to.w, to.x, to.y, to.z };
+      for (size_t k = 0; k < 8; ++k) workspace.Keys[k][i] = values[k];
+      workspace.T[i] = t;
+   }
+   const ConstQuaternionArrays from{
+      workspace.Keys[0].data(), workspace.Keys[1].data(), workspace.Keys[2].data(), workspace.Keys[3].data()
+   };
+   const ConstQuaternionArrays to{
+      workspace.Keys[4].data(), workspace.Keys[5].data(), workspace.Keys[6].data(), workspace.Keys[7].data()
+   };
+   QuaternionSlerp::interpolate( from, to, workspace.T.data(), count, quaternions );
+}
+
+void TimelineEvaluator::evaluate(
+   const Timeline& timeline,
+   double start_time,
+   double time_step,
+   size_t sample_num,
+   const SampleArrays& samples
+)
+{
+   Scheduler.parallelFor( 0, sample_num, ChunkSize, [&](size_t begin, size_t end, int thread_index) {
+      Workspace& workspace = Workspaces[thread_index];
+      for (size_t i = begin; i < end; ++i) {
+         workspace.Times[i - begin] = start_time + static_cast<double>(i) * time_step;
+      }
+      evaluateChunk( timeline, begin, end, samples, workspace );
+   } );
+}
+
+bool TimelineEvaluator::exportTimeline(const ExportSettings& settings)
+{
+   KeyframeFile file;
+   if (!file.open( settings.TrackFilePath )) return false;
+
+   KeyframeTrack<glm::vec3> euler_angle_track;
+   KeyframeTrack<glm::quat> quaternion_track;
+   file.bind( euler_angle_track, quaternion_track );
+   if (quaternion_track.empty()) {
+      std::cerr << "The track file " << settings.TrackFilePath << " has no keys\n";
+      return false;
+   }
+   QuaternionSpline spline;
+   if (settings.UseSpline) spline.build( quaternion_track );
+
+   // Track times are in milliseconds like the animation clock of the renderer.
+   const double duration = settings.Duration > 0.0 ? settings.Duration * 1000.0 : quaternion_track.getDuration();
+   const double time_step = 1000.0 / std::max( settings.SampleRate, 1e-6 );
+   const auto sample_num = static_cast<size_t>(std::ceil( duration / time_step ));
+   std::vector<float> buffer(7 * sample_num);
+   const SampleArrays samples{
+      { buffer.data(), buffer.data() + sample_num, buffer.data() + 2 * sample_num },
+      {
+         buffer.data() + 3 * sample_num, buffer.data() + 4 * sample_num,
+         buffer.data() + 5 * sample_num, buffer.data() + 6 * sample_num
+      }
+   };
+   const Timeline timeline{ &euler_angle_track, &quaternion_track, settings.UseSpline ? &spline : nullptr };
+   TimelineEvaluator evaluator( settings.ThreadNum );
+   const double start_time = quaternion_track.getTime( 0 );
+   const auto start = std::chrono::steady_clock::now();
+   evaluator.evaluate( timeline, start_time, time_step, sample_num, samples );
+   const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   std::cout << "[Timeline] " << sample_num << " samples on " << evaluator.getThreadNum() << " threads in "
+      << std::fixed << std::setprecision( 3 ) << seconds * 1000.0 << " ms ("
+      << std::setprecision( 1 ) << static_cast<double>(sample_num) / std::max( seconds, 1e-9 ) * 1e-6
+      << "M samples/s)\n";
+
+   std::ofstream output(settings.OutputFilePath);
+   if (!output.is_open()) {
+      std::cerr << "Cannot write " << settings.OutputFilePath << "\n";
+      return false;
+   }
+   output << "time_ms,pitch,roll,yaw,w,x,y,z\n" << std::setprecision( 9 );
+   for (size_t i = 0; i < sample_num; ++i) {
+      output << start_time + static_cast<double>(i) * time_step;
+      for (size_t k = 0; k < 7; ++k) output << ',' << buffer[k * sample_num + i];
+      output << '\n';
+   }
+   std::cout << "[Timeline] written to " << settings.OutputFilePath << "\n";
+   return static_cast<bool>(output);
+}
\ No newline at end of file